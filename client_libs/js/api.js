@@ -5,10 +5,60 @@ const proto = protobuf.loadSync("../../protos/api.proto");
 const AddCube = proto.lookupType("AddCube");
 const ClearBox = proto.lookupType("ClearBox");
 const ApiRequest = proto.lookupType("ApiRequest");
+const ApiBatch = proto.lookupType("ApiBatch");
+const ApiBatchResponse = proto.lookupType("ApiBatchResponse");
 
 const socket = new zmq.Request();
+// pipelined endpoint, batches are sent without waiting on a reply
+const batchSocket = new zmq.Dealer();
 async function init() {
     await socket.connect("tcp://127.0.0.1:3333");
+    await batchSocket.connect("tcp://127.0.0.1:3334");
+}
+
+let nextBatchId = 0;
+
+// Collects requests and sends them as one ApiBatch
+function batch() {
+    const requests = [];
+    return {
+        move(entityId, xDelta, yDelta, zDelta, unitsPerSecond) {
+            const move = {xDelta, yDelta, zDelta, unitsPerSecond};
+            requests.push({entityId, type: proto.MessageType.MOVE, move});
+            return this;
+        },
+        turnKey(entityId, on) {
+            requests.push({entityId, type: proto.MessageType.TURN_KEY,
+                           turnKey: {on}});
+            return this;
+        },
+        playerMove(position, rotation, unitsPerSecond) {
+            const playerMove = {
+                position: {x: position[0], y: position[1], z: position[2]},
+                rotation: {x: rotation[0], y: rotation[1], z: rotation[2]},
+                unitsPerSecond
+            };
+            requests.push({entityId: 0, type: proto.MessageType.PLAYER_MOVE,
+                           playerMove});
+            return this;
+        },
+        // resolves with the ApiBatchResponse when ack is set
+        async send(ack = false) {
+            const apiBatch = ApiBatch.create({batchId: nextBatchId++, ack,
+                                              requests: requests.splice(0)});
+            await batchSocket.send(ApiBatch.encode(apiBatch).finish());
+            if (ack) {
+                // earlier un-acked batches that were partly rejected reply too
+                while (true) {
+                    const [result] = await batchSocket.receive();
+                    const response = ApiBatchResponse.decode(result);
+                    if (Number(response.batchId) === apiBatch.batchId) {
+                        return response;
+                    }
+                }
+            }
+        }
+    };
 }
 
 async function addCube(x, y, z, blockType) {
@@ -48,5 +98,6 @@ async function clearBox(x1, y1, z1, x2, y2, z2) {
 module.exports = {
     init,
     addCube,
-    clearBox
+    clearBox,
+    batch
 };
@@ -6,38 +6,150 @@ context = zmq.Context()
 socket = context.socket(zmq.REQ)
 socket.connect("tcp://127.0.0.1:3333")
 
-def turnKey(entityId, onOrOff):
+# pipelined endpoint, batches are sent without waiting on a reply
+batchSocket = context.socket(zmq.DEALER)
+batchSocket.connect("tcp://127.0.0.1:3334")
+
+def turnKeyRequest(entityId, onOrOff):
     commandMessage = api_pb2.TurnKey(on=onOrOff)
-    apiRequest = api_pb2.ApiRequest(entityId=entityId,
-                                    type="TURN_KEY",
-                                    turnKey=commandMessage)
-    serializedRequest = apiRequest.SerializeToString()
-    socket.send(serializedRequest)
-    socket.recv()
+    return api_pb2.ApiRequest(entityId=entityId,
+                              type="TURN_KEY",
+                              turnKey=commandMessage)
 
-def move(entityId, xDelta, yDelta, zDelta, unitsPerSecond):
+def moveRequest(entityId, xDelta, yDelta, zDelta, unitsPerSecond):
     commandMessage = api_pb2.Move(xDelta=xDelta, yDelta=yDelta, zDelta=zDelta,
                                   unitsPerSecond=unitsPerSecond )
-    apiRequest = api_pb2.ApiRequest(entityId=entityId,
-                                    type="MOVE",
-                                    move=commandMessage)
-    serializedRequest = apiRequest.SerializeToString()
-    socket.send(serializedRequest)
-    socket.recv()
+    return api_pb2.ApiRequest(entityId=entityId,
+                              type="MOVE",
+                              move=commandMessage)
 
-def player_move(position, rotation, unitsPerSecond):
+def playerMoveRequest(position, rotation, unitsPerSecond):
     positionMessage = api_pb2.Vector(x=position[0], y=position[1], z=position[2])
     frontMessage = api_pb2.Vector(x=rotation[0], y=rotation[1], z=rotation[2])
     commandMessage = api_pb2.PlayerMove(position=positionMessage,
                                         rotation=frontMessage,
                                   unitsPerSecond=unitsPerSecond )
-    apiRequest = api_pb2.ApiRequest(entityId=0,
-                                    type="PLAYER_MOVE",
-                                    playerMove=commandMessage)
+    return api_pb2.ApiRequest(entityId=0,
+                              type="PLAYER_MOVE",
+                              playerMove=commandMessage)
+
+def sendRequest(apiRequest):
+    """Returns the ApiRequestResponse, rejected is set when the server's
+    request queue was full."""
     serializedRequest = apiRequest.SerializeToString()
     socket.send(serializedRequest)
-    socket.recv()
+    response = api_pb2.ApiRequestResponse()
+    response.ParseFromString(socket.recv())
+    return response
+
+def turnKey(entityId, onOrOff):
+    sendRequest(turnKeyRequest(entityId, onOrOff))
+
+def move(entityId, xDelta, yDelta, zDelta, unitsPerSecond):
+    sendRequest(moveRequest(entityId, xDelta, yDelta, zDelta, unitsPerSecond))
+
+def player_move(position, rotation, unitsPerSecond):
+    sendRequest(playerMoveRequest(position, rotation, unitsPerSecond))
+
+class Batch:
+    """Collects requests and sends them as one ApiBatch.
+
+    with batch() as b:
+        for entityId in boats:
+            b.move(entityId, 1, 0, 0, 5)
+    """
+    nextBatchId = 0
+
+    def __init__(self):
+        self.requests = []
+
+    def turnKey(self, entityId, onOrOff):
+        self.requests.append(turnKeyRequest(entityId, onOrOff))
+        return self
+
+    def move(self, entityId, xDelta, yDelta, zDelta, unitsPerSecond):
+        self.requests.append(
+            moveRequest(entityId, xDelta, yDelta, zDelta, unitsPerSecond))
+        return self
+
+    def player_move(self, position, rotation, unitsPerSecond):
+        self.requests.append(
+            playerMoveRequest(position, rotation, unitsPerSecond))
+        return self
+
+    def send(self, ack=False):
+        """Sends the batch without waiting, unless ack is set in which case
+        the ApiBatchResponse is returned once the server has queued it.
+        response.rejected counts requests dropped because the server's
+        queue was full."""
+        batchId = Batch.nextBatchId
+        Batch.nextBatchId += 1
+        apiBatch = api_pb2.ApiBatch(batchId=batchId, ack=ack,
+                                    requests=self.requests)
+        self.requests = []
+        batchSocket.send(apiBatch.SerializeToString())
+        if ack:
+            # earlier un-acked batches that were partly rejected reply too
+            while True:
+                response = api_pb2.ApiBatchResponse()
+                response.ParseFromString(batchSocket.recv())
+                if response.batchId == batchId:
+                    return response
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, excType, excValue, traceback):
+        if excType is None and self.requests:
+            self.send()
+
+def batch():
+    return Batch()
+
+
+def query_positionable(entityId):
+    """Returns the entity's PositionableState, or None if it has none."""
+    apiRequest = api_pb2.ApiRequest(entityId=entityId,
+                                    type="QUERY_POSITIONABLE",
+                                    noPayload=api_pb2.NoPayload())
+    response = sendRequest(apiRequest)
+    if response.HasField("positionable"):
+        return response.positionable
+    return None
+
+def query_camera():
+    apiRequest = api_pb2.ApiRequest(entityId=0,
+                                    type="QUERY_CAMERA",
+                                    noPayload=api_pb2.NoPayload())
+    response = sendRequest(apiRequest)
+    if response.HasField("camera"):
+        return response.camera
+    return None
 
+def subscribe(entityIds=None, camera=False):
+    """Yields PositionableState and CameraState messages as they change.
+    entityIds=None subscribes to every Positionable, [] to none."""
+    stateSocket = context.socket(zmq.SUB)
+    stateSocket.connect("tcp://127.0.0.1:3335")
+    if entityIds is None:
+        stateSocket.setsockopt(zmq.SUBSCRIBE, b"positionable/")
+    else:
+        for entityId in entityIds:
+            topic = "positionable/%d/" % entityId
+            stateSocket.setsockopt(zmq.SUBSCRIBE, topic.encode())
+    if camera:
+        stateSocket.setsockopt(zmq.SUBSCRIBE, b"camera/")
+    try:
+        while True:
+            topic, payload = stateSocket.recv_multipart()
+            if topic.startswith(b"camera/"):
+                state = api_pb2.CameraState()
+            else:
+                state = api_pb2.PositionableState()
+            state.ParseFromString(payload)
+            yield state
+    finally:
+        stateSocket.close()
 
 noPayload = api_pb2.NoPayload()
 
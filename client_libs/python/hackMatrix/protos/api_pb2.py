@@ -1,22 +1,11 @@
 # -*- coding: utf-8 -*-
 # Generated by the protocol buffer compiler.  DO NOT EDIT!
-# NO CHECKED-IN PROTOBUF GENCODE
 # source: protos/api.proto
-# Protobuf Python Version: 5.27.2
 """Generated protocol buffer code."""
+from google.protobuf.internal import builder as _builder
 from google.protobuf import descriptor as _descriptor
 from google.protobuf import descriptor_pool as _descriptor_pool
-from google.protobuf import runtime_version as _runtime_version
 from google.protobuf import symbol_database as _symbol_database
-from google.protobuf.internal import builder as _builder
-_runtime_version.ValidateProtobufRuntimeVersion(
-    _runtime_version.Domain.PUBLIC,
-    5,
-    27,
-    2,
-    '',
-    'protos/api.proto'
-)
 # @@protoc_insertion_point(imports)
 
 _sym_db = _symbol_database.Default()
@@ -24,25 +13,35 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x10protos/api.proto\")\n\x06Vector\x12\t\n\x01x\x18\x01 \x01(\x02\x12\t\n\x01y\x18\x02 \x01(\x02\x12\t\n\x01z\x18\x03 \x01(\x02\"Z\n\nPlayerMove\x12\x19\n\x08position\x18\x01 \x01(\x0b\x32\x07.Vector\x12\x19\n\x08rotation\x18\x02 \x01(\x0b\x32\x07.Vector\x12\x16\n\x0eunitsPerSecond\x18\x03 \x01(\x02\"N\n\x04Move\x12\x0e\n\x06xDelta\x18\x01 \x01(\x02\x12\x0e\n\x06yDelta\x18\x02 \x01(\x02\x12\x0e\n\x06zDelta\x18\x03 \x01(\x02\x12\x16\n\x0eunitsPerSecond\x18\x04 \x01(\x02\"\x15\n\x07TurnKey\x12\n\n\x02on\x18\x02 \x01(\x08\"\x9c\x01\n\nApiRequest\x12\x10\n\x08\x65ntityId\x18\x01 \x01(\x03\x12\x1a\n\x04type\x18\x02 \x01(\x0e\x32\x0c.MessageType\x12\x15\n\x04move\x18\x03 \x01(\x0b\x32\x05.MoveH\x00\x12\x1b\n\x07turnKey\x18\x04 \x01(\x0b\x32\x08.TurnKeyH\x00\x12!\n\nplayerMove\x18\x05 \x01(\x0b\x32\x0b.PlayerMoveH\x00\x42\t\n\x07payload\"\'\n\x12\x41piRequestResponse\x12\x11\n\trequestId\x18\x01 \x01(\x03*6\n\x0bMessageType\x12\x08\n\x04MOVE\x10\x00\x12\x0c\n\x08TURN_KEY\x10\x01\x12\x0f\n\x0bPLAYER_MOVE\x10\x02\x62\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x10protos/api.proto\"\x0b\n\tNoPayload\")\n\x06Vector\x12\t\n\x01x\x18\x01 \x01(\x02\x12\t\n\x01y\x18\x02 \x01(\x02\x12\t\n\x01z\x18\x03 \x01(\x02\"Z\n\nPlayerMove\x12\x19\n\x08position\x18\x01 \x01(\x0b\x32\x07.Vector\x12\x19\n\x08rotation\x18\x02 \x01(\x0b\x32\x07.Vector\x12\x16\n\x0eunitsPerSecond\x18\x03 \x01(\x02\"N\n\x04Move\x12\x0e\n\x06xDelta\x18\x01 \x01(\x02\x12\x0e\n\x06yDelta\x18\x02 \x01(\x02\x12\x0e\n\x06zDelta\x18\x03 \x01(\x02\x12\x16\n\x0eunitsPerSecond\x18\x04 \x01(\x02\"\x15\n\x07TurnKey\x12\n\n\x02on\x18\x02 \x01(\x08\"\xbd\x01\n\nApiRequest\x12\x10\n\x08\x65ntityId\x18\x01 \x01(\x03\x12\x1a\n\x04type\x18\x02 \x01(\x0e\x32\x0c.MessageType\x12\x15\n\x04move\x18\x03 \x01(\x0b\x32\x05.MoveH\x00\x12\x1b\n\x07turnKey\x18\x04 \x01(\x0b\x32\x08.TurnKeyH\x00\x12!\n\nplayerMove\x18\x05 \x01(\x0b\x32\x0b.PlayerMoveH\x00\x12\x1f\n\tnoPayload\x18\x06 \x01(\x0b\x32\n.NoPayloadH\x00\x42\t\n\x07payload\"c\n\x11PositionableState\x12\x10\n\x08\x65ntityId\x18\x01 \x01(\x03\x12\x14\n\x03pos\x18\x02 \x01(\x0b\x32\x07.Vector\x12\x17\n\x06rotate\x18\x03 \x01(\x0b\x32\x07.Vector\x12\r\n\x05scale\x18\x04 \x01(\x02\"@\n\x0b\x43\x61meraState\x12\x19\n\x08position\x18\x01 \x01(\x0b\x32\x07.Vector\x12\x16\n\x05\x66ront\x18\x02 \x01(\x0b\x32\x07.Vector\"\x91\x01\n\x12\x41piRequestResponse\x12\x11\n\trequestId\x18\x01 \x01(\x03\x12\x10\n\x08rejected\x18\x02 \x01(\x08\x12*\n\x0cpositionable\x18\x03 \x01(\x0b\x32\x12.PositionableStateH\x00\x12\x1e\n\x06\x63\x61mera\x18\x04 \x01(\x0b\x32\x0c.CameraStateH\x00\x42\n\n\x08snapshot\"G\n\x08\x41piBatch\x12\x0f\n\x07\x62\x61tchId\x18\x01 \x01(\x03\x12\x0b\n\x03\x61\x63k\x18\x02 \x01(\x08\x12\x1d\n\x08requests\x18\x03 \x03(\x0b\x32\x0b.ApiRequest\"\\\n\x10\x41piBatchResponse\x12\x0f\n\x07\x62\x61tchId\x18\x01 \x01(\x03\x12\x16\n\x0e\x66irstRequestId\x18\x02 \x01(\x03\x12\r\n\x05\x63ount\x18\x03 \x01(\x05\x12\x10\n\x08rejected\x18\x04 \x01(\x05*t\n\x0bMessageType\x12\x08\n\x04MOVE\x10\x00\x12\x0c\n\x08TURN_KEY\x10\x01\x12\x0f\n\x0bPLAYER_MOVE\x10\x02\x12\x12\n\x0eUNFOCUS_WINDOW\x10\x03\x12\x16\n\x12QUERY_POSITIONABLE\x10\x04\x12\x10\n\x0cQUERY_CAMERA\x10\x05\x62\x06proto3')
+
+_builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, globals())
+_builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'protos.api_pb2', globals())
+if _descriptor._USE_C_DESCRIPTORS == False:
 
-_globals = globals()
-_builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, _globals)
-_builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'protos.api_pb2', _globals)
-if not _descriptor._USE_C_DESCRIPTORS:
-  DESCRIPTOR._loaded_options = None
-  _globals['_MESSAGETYPE']._serialized_start=458
-  _globals['_MESSAGETYPE']._serialized_end=512
-  _globals['_VECTOR']._serialized_start=20
-  _globals['_VECTOR']._serialized_end=61
-  _globals['_PLAYERMOVE']._serialized_start=63
-  _globals['_PLAYERMOVE']._serialized_end=153
-  _globals['_MOVE']._serialized_start=155
-  _globals['_MOVE']._serialized_end=233
-  _globals['_TURNKEY']._serialized_start=235
-  _globals['_TURNKEY']._serialized_end=256
-  _globals['_APIREQUEST']._serialized_start=259
-  _globals['_APIREQUEST']._serialized_end=415
-  _globals['_APIREQUESTRESPONSE']._serialized_start=417
-  _globals['_APIREQUESTRESPONSE']._serialized_end=456
+  DESCRIPTOR._options = None
+  _MESSAGETYPE._serialized_start=945
+  _MESSAGETYPE._serialized_end=1061
+  _NOPAYLOAD._serialized_start=20
+  _NOPAYLOAD._serialized_end=31
+  _VECTOR._serialized_start=33
+  _VECTOR._serialized_end=74
+  _PLAYERMOVE._serialized_start=76
+  _PLAYERMOVE._serialized_end=166
+  _MOVE._serialized_start=168
+  _MOVE._serialized_end=246
+  _TURNKEY._serialized_start=248
+  _TURNKEY._serialized_end=269
+  _APIREQUEST._serialized_start=272
+  _APIREQUEST._serialized_end=461
+  _POSITIONABLESTATE._serialized_start=463
+  _POSITIONABLESTATE._serialized_end=562
+  _CAMERASTATE._serialized_start=564
+  _CAMERASTATE._serialized_end=628
+  _APIREQUESTRESPONSE._serialized_start=631
+  _APIREQUESTRESPONSE._serialized_end=776
+  _APIBATCH._serialized_start=778
+  _APIBATCH._serialized_end=849
+  _APIBATCHRESPONSE._serialized_start=851
+  _APIBATCHRESPONSE._serialized_end=943
 # @@protoc_insertion_point(module_scope)
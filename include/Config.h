@@ -28,5 +28,23 @@ public:
     return (*current)[parts.back()].get_value<T>();
   }
 
+  // fallback when the key isn't in config.yaml; a value of the wrong type
+  // still throws
+  template<typename T>
+  T get(const std::string& key_path, T fallback)
+  {
+    fkyaml::node* current = &config;
+    for (auto& part : split_path(key_path)) {
+      if (!current->is_mapping() || !current->contains(part)) {
+        return fallback;
+      }
+      current = &(*current)[part];
+    }
+    if (current->is_null()) {
+      return fallback;
+    }
+    return current->get_value<T>();
+  }
+
   std::vector<std::string> get_keys(const std::string& key_path);
 };
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asynchronous readback of the default framebuffer. glReadPixels goes into a
+// ring of pixel pack buffers and a fence marks when the copy is done, so the
+// frame that asked for the pixels never waits on the GPU. Completed frames
+// are handed to a fixed pool of encoder threads through a bounded queue;
+// when either the ring or the queue is full the frame is dropped instead of
+// stalling the render loop.
+class FrameCapture
+{
+  static const int RING_SIZE = 3;
+  static const int MAX_QUEUED_FRAMES = 8;
+
+  struct ReadbackSlot
+  {
+    unsigned int pbo = 0;
+    GLsync fence = NULL;
+    std::string filename;
+    bool raw = false;
+  };
+
+  struct EncodeJob
+  {
+    std::string filename;
+    bool raw;
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+  };
+
+  ReadbackSlot slots[RING_SIZE];
+  int nextSlot = 0;
+  int width = 0;
+  int height = 0;
+
+  bool screenshotRequested = false;
+  bool recording = false;
+  bool recordRaw = false;
+  double recordInterval = 1.0 / 30.0;
+  double nextRecordTime = 0;
+  std::string recordDirectory;
+  int recordFrame = 0;
+
+  std::vector<std::thread> encoders;
+  std::deque<EncodeJob> jobs;
+  std::vector<std::vector<unsigned char>> freeBuffers;
+  std::mutex jobsMutex;
+  std::condition_variable jobsReady;
+  bool stopping = false;
+
+  std::atomic_uint droppedFrames = 0;
+  std::atomic_uint writtenFrames = 0;
+  std::shared_ptr<spdlog::logger> logger;
+
+  void resize(int width, int height);
+  void readback(std::string filename, bool raw);
+  void collect(bool wait);
+  void encode();
+  void write(EncodeJob& job);
+
+public:
+  FrameCapture(int encoderThreads);
+  ~FrameCapture();
+  void screenshot();
+  void startRecording(double fps, bool raw);
+  void stopRecording();
+  bool isRecording() { return recording; }
+  // call once per frame after everything, including the gui, has been drawn
+  void capture(int width, int height, double time);
+  unsigned int getDroppedFrames() { return droppedFrames; }
+  unsigned int getWrittenFrames() { return writtenFrames; }
+};
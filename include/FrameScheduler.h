@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Paces Engine::loop against a target frame time. Each phase of the frame
+// gets a share of the target and is timed against it, work that doesn't
+// have to happen this frame waits in a deferred slot until the frame has
+// time left for it, and frame times are kept long enough to report
+// percentiles. When frames run late under vsync, each late one waits a
+// whole extra refresh, so the swap interval drops to lateSwapInterval until
+// frames fit again.
+class FrameScheduler
+{
+public:
+  using Clock = std::function<double()>;
+  using Work = std::function<void()>;
+
+  // one slot each, a job deferred while another of its kind waits replaces
+  // it
+  enum Deferred
+  {
+    MESHING,
+    SHADOWS,
+    PERSISTENCE,
+    DEFERRED_COUNT
+  };
+
+  struct Phase
+  {
+    std::string name;
+    // fraction of the target frame time
+    double budget;
+    double seconds;
+    int overruns;
+  };
+
+  struct Percentiles
+  {
+    double p50;
+    double p95;
+    double p99;
+  };
+
+  // lateSwapInterval is -1 where late swaps may tear, otherwise 0
+  FrameScheduler(Clock clock,
+                 double targetSeconds = 1.0 / 60,
+                 int lateSwapInterval = 0,
+                 size_t samples = 240);
+
+  int addPhase(const std::string& name, double budget);
+  // the interval since the previous call is the last frame's time
+  void beginFrame();
+  // the phase ran from the previous mark to now
+  void endPhase(int phase);
+  void defer(Deferred, Work);
+  // frames a job may wait before it runs however late the frame is
+  void setMaxDelay(Deferred, int frames);
+  // runs waiting jobs whose last run fits in what's left of the target,
+  // leaving a share for the swap
+  void runDeferred();
+
+  Percentiles percentiles();
+  // nearest rank over the kept frame times, p in [0, 1]
+  double percentile(double p);
+  const std::vector<Phase>& getPhases();
+  bool isWaiting(Deferred);
+  int getDeferredCount(Deferred);
+  double getTargetSeconds();
+  void setTargetSeconds(double);
+  void setAdaptiveVsync(bool);
+  int getSwapInterval();
+  // true once after the swap interval changed
+  bool takeSwapIntervalChange();
+
+private:
+  struct Slot
+  {
+    Work work;
+    int waited = 0;
+    int maxDelay = 0;
+    // how long the last run took
+    double cost = 0;
+    // frames it waited for time to run
+    int deferred = 0;
+  };
+  // of the target, kept free for the swap and the driver
+  static constexpr double SWAP_RESERVE = 0.1;
+  // frames later than this fraction over the target missed a refresh
+  static constexpr double LATE = 1.05;
+  // and frames this far under it have room to wait for one
+  static constexpr double EARLY = 0.9;
+
+  Clock clock;
+  double targetSeconds;
+  int lateSwapInterval;
+  bool adaptiveVsync = true;
+  int swapInterval = 1;
+  bool swapIntervalChanged = false;
+  // frames since the swap interval last changed
+  size_t settled = 0;
+
+  std::vector<double> frameTimes;
+  size_t nextFrame = 0;
+  size_t frameCount = 0;
+  double frameStart = -1;
+  double mark = 0;
+
+  std::vector<Phase> phases;
+  std::array<Slot, DEFERRED_COUNT> slots;
+
+  void adaptSwapInterval();
+};
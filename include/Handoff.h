@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+
+// Hands whole batches from one producer thread to one consumer thread
+// without a lock. Two batches go back and forth through atomic pointers:
+// the producer publishes the batch it has been filling only once the
+// consumer has handed the last one back, and until then keeps adding to it,
+// so nothing is dropped and a slow consumer just gets bigger batches. T
+// needs empty() and clear().
+template<typename T>
+class Handoff
+{
+  T batches[2];
+  // filled, waiting for the consumer
+  std::atomic<T*> published = nullptr;
+  // cleared by the consumer, waiting for the producer
+  std::atomic<T*> returned = &batches[1];
+  T* filling = &batches[0];
+
+public:
+  // producer only, the batch being filled
+  T& pending() { return *filling; }
+
+  // producer only, false when the consumer still has the last batch and the
+  // pending one stays pending
+  bool publish()
+  {
+    if (filling->empty()) {
+      return true;
+    }
+    T* spare = returned.exchange(nullptr, std::memory_order_acq_rel);
+    if (spare == nullptr) {
+      return false;
+    }
+    published.store(filling, std::memory_order_release);
+    filling = spare;
+    return true;
+  }
+
+  // consumer only, the published batch or NULL. Hand it back with release
+  // once it has been applied.
+  T* take() { return published.exchange(nullptr, std::memory_order_acquire); }
+
+  void release(T* batch)
+  {
+    batch->clear();
+    returned.store(batch, std::memory_order_release);
+  }
+};
@@ -1,17 +1,29 @@
 #pragma once
 
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <algorithm>
 
+// Hands out the smallest unused index. Released indices are tracked in a two
+// level bitmap (one bit per index, one summary bit per 64 bit word), so
+// acquiring and relinquishing is a couple of find-first-set instructions
+// instead of a vector erase and sort.
 class IndexPool
 {
 public:
-  IndexPool(int maxIndex);
+  // indices are handed out lazily, so an unbounded pool costs nothing until
+  // it is used
+  IndexPool(int maxIndex = INT_MAX);
   int acquireIndex();
   void relinquishIndex(int index);
+  bool isUsed(int index);
 
 private:
   int maxIndex;
-  std::vector<int> availableIndices;
-  std::vector<int> usedIndices;
+  int nextIndex = 0;
+  // a set bit is a released index below nextIndex
+  std::vector<uint64_t> freeBits;
+  // a set bit means the matching freeBits word has at least one bit set
+  std::vector<uint64_t> freeWords;
 };
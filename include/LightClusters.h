@@ -0,0 +1,72 @@
+#pragma once
+
+#include "entity.h"
+#include "shader.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+// Clustered forward lighting. The view frustum is split into a grid of
+// froxels (screen tiles x exponential depth slices). Every frame the lights
+// are binned into the froxels they touch on the CPU and the result is
+// uploaded to texture buffers, so the fragment shader only walks the lights
+// of its own cluster.
+class LightClusters
+{
+  static const int TILES_X = 16;
+  static const int TILES_Y = 9;
+  static const int SLICES = 24;
+  static const int CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+
+  struct ClusterBounds
+  {
+    glm::vec3 min;
+    glm::vec3 max;
+  };
+
+  struct PackedLight
+  {
+    glm::vec4 positionRadius;
+    glm::vec4 colorShadowIndex;
+  };
+
+  std::shared_ptr<EntityRegistry> registry;
+
+  unsigned int lightDataBuffer;
+  unsigned int lightDataTexture;
+  unsigned int clusterGridBuffer;
+  unsigned int clusterGridTexture;
+  unsigned int lightIndexBuffer;
+  unsigned int lightIndexTexture;
+
+  float zNear = 0;
+  float zFar = 0;
+  float tanHalfFovX = 0;
+  float tanHalfFovY = 0;
+  std::vector<ClusterBounds> bounds;
+
+  std::vector<PackedLight> lights;
+  std::vector<std::vector<unsigned int>> bins;
+  std::vector<unsigned int> grid;
+  std::vector<unsigned int> indices;
+
+  void buildBounds();
+  void binLight(unsigned int lightIndex, glm::vec3 viewPos, float radius);
+  void upload();
+
+public:
+  // texture units reserved for the three light buffers
+  static const int LIGHT_DATA_UNIT = 8;
+  static const int CLUSTER_GRID_UNIT = 9;
+  static const int LIGHT_INDEX_UNIT = 10;
+  // lights with a lower index than this sample their shadow cube map
+  static const int MAX_SHADOWED_LIGHTS = 5;
+
+  LightClusters(std::shared_ptr<EntityRegistry> registry);
+  ~LightClusters();
+  void setProjection(float yFov, float aspect, float zNear, float zFar);
+  void update(const glm::mat4& view);
+  void bindUniforms(Shader* shader, float screenWidth, float screenHeight);
+  int lightCount() { return lights.size(); }
+  int indexCount() { return indices.size(); }
+};
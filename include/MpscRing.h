@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free queue for many producers and a single consumer. Every
+// cell carries a sequence number that tells producers whether the cell is
+// free for the current lap, so push and pop never take a lock and a full
+// ring is reported to the producer instead of blocking it.
+template<typename T>
+class MpscRing
+{
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> cells;
+  size_t mask;
+  alignas(64) std::atomic<size_t> enqueuePos = 0;
+  alignas(64) std::atomic<size_t> dequeuePos = 0;
+
+public:
+  // capacity is rounded up to a power of two
+  MpscRing(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask = size - 1;
+    cells = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // safe to call from any thread, returns false when the ring is full
+  bool push(T value)
+  {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells[pos & mask];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+      if (diff == 0) {
+        if (enqueuePos.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // consumer thread only, returns false when the ring is empty
+  bool pop(T& value)
+  {
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell& cell = cells[pos & mask];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if ((intptr_t)sequence - (intptr_t)(pos + 1) < 0) {
+      return false;
+    }
+    value = std::move(cell.value);
+    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // approximate while producers are running
+  size_t size()
+  {
+    size_t enqueued = enqueuePos.load(std::memory_order_relaxed);
+    size_t dequeued = dequeuePos.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  size_t capacity() { return mask + 1; }
+};
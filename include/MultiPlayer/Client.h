@@ -4,6 +4,11 @@
 #include <string>
 #include <glm/glm.hpp>
 #include "entity.h"
+#include "MultiPlayer/Interpolation.h"
+#include "MultiPlayer/Snapshot.h"
+#include "MultiPlayer/WorldEdits.h"
+
+class WorldInterface;
 
 namespace MultiPlayer {
 
@@ -17,8 +22,14 @@ public:
   bool isConnected();
   void disconnect();
   bool sendPlayer(glm::vec3, glm::vec3);
+  // edits the server sends are applied to world
+  void attachWorld(WorldInterface* world);
+  // for the server to order and pass on, the world already has it
+  void sendBlockEdit(BlockEdit);
   void startUpdateThread();
   void updateThreadLoop();
+  // handles what arrived and moves remote players to where they're drawn
+  // this frame
   void poll();
   bool shouldSendPlayerPacket();
   void justSentPlayerPacket();
@@ -30,6 +41,16 @@ private:
   double lastUpdate = 0;
   double UPDATE_EVERY = 1.0 / 20.0;
   std::shared_ptr<EntityRegistry> registry;
+  SnapshotHistory snapshots;
+  // the newest snapshot applied, acked with every player packet
+  uint32_t latestTick = 0;
+  // numbers the player packets
+  uint32_t sequence = 0;
+  InterpolationBuffer remotePlayers;
+  WorldInterface* world = NULL;
+  void applySnapshot(ENetPacket*);
+  void moveRemotePlayers();
+  void applyWorldEdit(ENetPacket*);
 };
 
 }
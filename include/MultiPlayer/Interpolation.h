@@ -0,0 +1,58 @@
+#pragma once
+
+#include "MultiPlayer/Snapshot.h"
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace MultiPlayer {
+
+// Remote players are drawn where they were delay seconds ago on the
+// server's clock, between the two snapshots either side of that moment, so
+// a snapshot that arrives late or out of order still lands in its place.
+// When the snapshot after that moment never came, players carry on at their
+// last velocity for at most maxExtrapolation seconds, or until their next
+// sample was due if they are sampled less often, and then wait.
+class InterpolationBuffer
+{
+public:
+  InterpolationBuffer(double tickSeconds,
+                      double delay = 0.1,
+                      double maxExtrapolation = 0.25);
+
+  // receivedAt and now are seconds on any one local clock
+  void add(const Snapshot&, double receivedAt);
+  // every player the newest snapshot has, where they are drawn at now
+  std::vector<PlayerState> sample(double now);
+  // how far ahead of the local clock the server's is estimated to be
+  double getClockOffset();
+  void setDelay(double seconds);
+  void setMaxExtrapolation(double seconds);
+  void clear();
+
+private:
+  struct Sample
+  {
+    uint32_t tick;
+    // ticks until the server samples the player again
+    uint32_t interval;
+    PlayerState state;
+  };
+  // a few seconds of ticks, more than any delay worth using
+  static const size_t TRACK_SIZE = 64;
+
+  double tickSeconds;
+  double delay;
+  double maxExtrapolation;
+  double clockOffset = 0;
+  bool synced = false;
+  uint32_t newestTick = 0;
+  // each player's samples, oldest tick first
+  std::map<uint32_t, std::deque<Sample>> tracks;
+
+  void insert(std::deque<Sample>&, uint32_t tick, const QuantizedPlayer&);
+  PlayerState sampleTrack(std::deque<Sample>&, double renderTick);
+};
+
+}
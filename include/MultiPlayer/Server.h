@@ -1,9 +1,15 @@
 #pragma once
 
+#include "MultiPlayer/Snapshot.h"
+#include "MultiPlayer/WorldEdits.h"
 #include <enet/enet.h>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <glm/glm.hpp>
+#include <map>
+#include <mutex>
 
 namespace MultiPlayer {
 
@@ -12,30 +18,94 @@ struct PlayerUpdate
   uint32_t playerID;
   glm::vec3 position;
   glm::vec3 front;
+  // the newest snapshot the sender has, 0 before the first
+  uint32_t ackedTick;
+  // counts up with every update a client sends, 0 from senders that don't
+  // number them
+  uint32_t sequence;
 };
 
 enum CHANNEL_TYPE
 {
-  PLAYER_UPDATE = 1
+  PLAYER_UPDATE = 1,
+  PLAYER_JOINED = 2,
+  SNAPSHOT = 3,
+  // reliable, so edits arrive once and in the order the server sent them
+  WORLD_EDIT = 4
+};
+
+// how often the server ticks, and so sends snapshots
+const int SNAPSHOT_RATE = 20;
+
+// how the poll thread is keeping up, times in milliseconds. A tick's work is
+// handling the events that came in during it, the onTick listener and
+// sending, the rest of the tick is spent blocked waiting for packets.
+struct ServerMetrics
+{
+  uint32_t ticks = 0;
+  double lastTickWork = 0;
+  double averageTickWork = 0;
+  double maxTickWork = 0;
+  // ticks whose work ran past the tick length
+  uint32_t overruns = 0;
+  size_t eventsLastTick = 0;
+  size_t maxEventsPerTick = 0;
+  // packets queued for the one flush at the end of the last tick
+  size_t packetsLastTick = 0;
+  size_t editsLastTick = 0;
+  size_t editedChunks = 0;
 };
 
 class Server
 {
 public:
-  Server();
+  Server(int tickRate = SNAPSHOT_RATE);
   ~Server();
 
   bool Start(int port);
   void Stop();
   void PollLoop();
   bool IsRunning();
+  ServerMetrics getMetrics();
+  // called on the poll thread once a tick, before the tick's edits and
+  // snapshots go out. Set it before Start.
+  void onTick(std::function<void()>);
 
 private:
+  // what one connected client has been sent
+  struct ClientView
+  {
+    ENetPeer* peer;
+    uint32_t ackedTick = 0;
+    // the newest update applied, older ones arriving after it are dropped
+    uint32_t newestUpdate = 0;
+    SnapshotHistory sent;
+    Snapshot last;
+  };
+
   ENetHost* server;
   std::atomic<bool> isRunning;
   std::thread pollThread;
+  std::chrono::microseconds tickLength;
+  std::function<void()> tickListener;
+  std::map<uint32_t, PlayerState> players;
+  std::map<uint32_t, ClientView> clients;
+  uint32_t tick = 0;
+  size_t packetsThisTick = 0;
+  WorldEdits worldEdits;
+  // applied to worldEdits, not yet sent on
+  std::vector<BlockEdit> pendingEdits;
+  size_t editsThisTick = 0;
+  std::mutex metricsMutex;
+  ServerMetrics metrics;
   PlayerUpdate getPlayerUpdateFromEvent(ENetEvent&);
-  void broadcastPlayerUpdate(PlayerUpdate);
+  void applyPlayerUpdate(const PlayerUpdate&);
+  void handleEvent(ENetEvent&);
+  Snapshot snapshotFor(uint32_t playerID, ClientView&);
+  void sendSnapshots();
+  void receiveEdits(ENetEvent&);
+  void sendEdits();
+  void recordTick(std::chrono::steady_clock::duration work, size_t events);
 };
 
 }
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace MultiPlayer {
+
+struct PlayerState
+{
+  uint32_t playerID;
+  glm::vec3 position;
+  glm::vec3 front;
+};
+
+// a player as it goes over the wire. Positions are fixed point at
+// POSITION_SCALE steps per unit, front is a yaw and pitch spread over the
+// int16 range.
+struct QuantizedPlayer
+{
+  static constexpr float POSITION_SCALE = 1024.0f;
+
+  uint32_t playerID;
+  int32_t x;
+  int32_t y;
+  int32_t z;
+  int16_t yaw;
+  int16_t pitch;
+  // how many ticks apart the server samples this player for the receiving
+  // client, on the ticks in between it repeats the last sample
+  uint32_t interval = 1;
+
+  static QuantizedPlayer from(const PlayerState&);
+  PlayerState state() const;
+  // whether this is a new sample at tick rather than a repeat
+  bool sampledAt(uint32_t tick) const;
+  bool operator==(const QuantizedPlayer&) const = default;
+};
+
+// every player one client is told about at one server tick, sorted by
+// playerID
+struct Snapshot
+{
+  uint32_t tick = 0;
+  std::vector<QuantizedPlayer> players;
+
+  const QuantizedPlayer* find(uint32_t playerID) const;
+};
+
+// the last few snapshots sent to or received from one peer, so a snapshot
+// can be encoded against, and decoded from, whichever one was acked
+class SnapshotHistory
+{
+  static const size_t SIZE = 32;
+  Snapshot snapshots[SIZE];
+
+public:
+  void add(const Snapshot&);
+  const Snapshot* find(uint32_t tick) const;
+};
+
+// A snapshot is written as the players that changed since base, each as
+// the fields that differ, and the ids of the players that are gone. Values
+// are zigzag varints of the difference from base, so a player standing
+// still costs nothing and a walking one a few bytes. A NULL base writes
+// every player in full.
+std::vector<uint8_t>
+encodeSnapshot(const Snapshot& snapshot, const Snapshot* base);
+
+// rebuilds the snapshot from the base it was encoded against, which has
+// to be in history. False when the base is gone or the data is malformed.
+bool
+decodeSnapshot(const uint8_t* data,
+               size_t size,
+               const SnapshotHistory& history,
+               Snapshot& snapshot);
+
+// how many ticks apart a player distance away is sent, far away players
+// are sent less often
+uint32_t
+updateInterval(float distance);
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// varints shared by the snapshot and world edit encodings. Unsigned values
+// take 7 bits a byte, signed ones are zigzagged first so small negatives
+// stay small.
+namespace MultiPlayer::wire {
+
+inline void
+writeVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+  while (value >= 0x80) {
+    out.push_back((uint8_t)(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back((uint8_t)value);
+}
+
+inline void
+writeSigned(std::vector<uint8_t>& out, int64_t value)
+{
+  writeVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+class Reader
+{
+  const uint8_t* data;
+  size_t size;
+  size_t offset = 0;
+
+public:
+  bool failed = false;
+
+  Reader(const uint8_t* data, size_t size)
+    : data(data)
+    , size(size)
+  {
+  }
+
+  uint64_t varint()
+  {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (offset >= size) {
+        failed = true;
+        return 0;
+      }
+      uint8_t byte = data[offset++];
+      value |= (uint64_t)(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    failed = true;
+    return 0;
+  }
+
+  int64_t signedVarint()
+  {
+    uint64_t value = varint();
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+  }
+
+  // the bytes not read yet
+  const uint8_t* rest() { return data + offset; }
+  size_t remaining() { return size - offset; }
+
+  bool done() { return offset == size; }
+};
+
+}
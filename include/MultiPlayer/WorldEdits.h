@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace MultiPlayer {
+
+// one cube placed or removed, in world cube coordinates. A blockType of -1
+// removes, the same as World::addCube.
+struct BlockEdit
+{
+  int32_t x;
+  int32_t y;
+  int32_t z;
+  int32_t blockType;
+
+  bool operator==(const BlockEdit&) const = default;
+};
+
+// what a WORLD_EDIT packet carries, its first byte
+enum WORLD_EDIT_KIND
+{
+  // edits in the order the server applied them, or that a client made
+  EDIT_BATCH = 0,
+  // every edit made to one chunk so far, for clients that join late
+  CHUNK_STATE = 1
+};
+
+// each edit as zigzag varints of its difference from the one before, so a
+// run of edits next to each other costs a few bytes apiece
+std::vector<uint8_t>
+encodeEdits(const std::vector<BlockEdit>& edits);
+
+bool
+decodeEdits(const uint8_t* data, size_t size, std::vector<BlockEdit>& edits);
+
+// The server's copy of the world, as the edits made on top of the terrain
+// every client loads for itself. It keeps one cell per cube for each chunk
+// that has been edited: untouched, removed, or the type placed there.
+class WorldEdits
+{
+public:
+  // the same as Chunk::size
+  static const int CHUNK_WIDTH = 32;
+  static const int CHUNK_HEIGHT = 384;
+  static const int CHUNK_CELLS = CHUNK_WIDTH * CHUNK_HEIGHT * CHUNK_WIDTH;
+  // types above this don't fit a cell
+  static const int MAX_BLOCK_TYPE = 253;
+  // how many chunks out from the origin, along x and z, edits are kept
+  static const int DEFAULT_RADIUS = 64;
+  // each edited chunk costs CHUNK_CELLS bytes here and a CHUNK_STATE packet
+  // for every client that joins
+  static const size_t DEFAULT_MAX_CHUNKS = 256;
+
+  WorldEdits(int radius = DEFAULT_RADIUS,
+             size_t maxChunks = DEFAULT_MAX_CHUNKS);
+  // false, and nothing changes, for an edit outside the world, with a type
+  // that doesn't exist, or that would edit a chunk past maxChunks
+  bool apply(const BlockEdit&);
+  size_t chunkCount() const;
+  // a CHUNK_STATE packet per edited chunk, its cells deflated
+  std::vector<std::vector<uint8_t>> encodeChunks() const;
+  // the edits a CHUNK_STATE packet holds, without its kind byte
+  static bool decodeChunk(const uint8_t* data,
+                          size_t size,
+                          std::vector<BlockEdit>& edits);
+
+private:
+  int radius;
+  size_t maxChunks;
+  std::map<std::pair<int32_t, int32_t>, std::vector<uint8_t>> chunks;
+  bool inside(int32_t coordinate) const;
+};
+
+}
@@ -9,13 +9,18 @@ class SQLPersisterImpl : public SQLPersister
 public:
   std::string entityName;
   std::shared_ptr<EntityRegistry> registry;
+  std::string deleteQuery;
   SQLPersisterImpl(std::string entityName,
                    std::shared_ptr<EntityRegistry> registry)
     : registry(registry)
     , entityName(entityName)
+    , deleteQuery("DELETE FROM " + entityName + " WHERE entity_id = ?")
   {
   }
   void depersist(entt::entity) override;
+  // queue a write for this persister's row of entityId, replacing any write
+  // for that row that hasn't been flushed yet
+  void stage(int64_t entityId, WriteBehind::Write write);
   template<typename T>
   void depersistIfGoneTyped(entt::entity entity)
   {
@@ -31,7 +36,8 @@ Constructor(std::shared_ptr<EntityRegistry> registry):
 void createTablesIfNeeded() override;
 void saveAll() override;
 void save(entt::entity) override;
-void loadAll() override;
+std::string selectAllQuery() override;
+void loadRow(entt::entity, SQLite::Statement&) override;
 void load(entt::entity) override;
 void depersistIfGone(entt::entity) override;
 
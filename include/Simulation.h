@@ -0,0 +1,32 @@
+#pragma once
+
+#include "SystemScheduler.h"
+#include "entity.h"
+#include <cstdint>
+#include <memory>
+
+// The world's systems without a window: movement and the transform
+// hierarchy, run against a registry one fixed tick at a time. A step always
+// advances exactly one tick length, so two simulations that start from the
+// same registry and are given the same inputs between steps end up in the
+// same state. The dedicated server steps one on its poll thread, tests step
+// one directly.
+class Simulation
+{
+  std::shared_ptr<EntityRegistry> registry;
+  SystemScheduler scheduler;
+  double tickSeconds;
+  uint64_t tick = 0;
+  void addSystems();
+
+public:
+  // workers as for SystemScheduler, the default of none runs every system
+  // on the thread that calls step()
+  Simulation(std::shared_ptr<EntityRegistry>, int tickRate, int workers = 0);
+  // runs every system once and stages what changed to be saved
+  void step();
+  uint64_t getTick();
+  double getTickSeconds();
+  std::shared_ptr<EntityRegistry> getRegistry();
+  SystemScheduler& getScheduler();
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "camera.h"
+#include "entity.h"
+#include "logger.h"
+#include "model.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <zmq/zmq.hpp>
+#undef Status
+#include "protos/api.pb.h"
+
+// Streams Positionable and camera state out over an XPUB socket. Clients
+// subscribe to "positionable/<entityId>/", "positionable/" for every entity
+// or "camera/". The XPUB socket hands those subscriptions back to us, so only
+// subscribed entities are diffed. Changes are coalesced and published at
+// most publishRate times a second, each topic carrying only its latest state.
+// Runs entirely on the render thread.
+class StatePublisher
+{
+  struct PublishedState
+  {
+    glm::vec3 pos;
+    glm::vec3 rotate;
+    float scale;
+  };
+
+  shared_ptr<EntityRegistry> registry;
+  Camera* camera;
+  shared_ptr<spdlog::logger> logger;
+  zmq::socket_t socket;
+
+  double publishInterval;
+  double nextPublishTime = 0;
+
+  set<string> topics;
+  bool allPositionables = false;
+  bool cameraSubscribed = false;
+  set<entt::entity> subscribedEntities;
+
+  unordered_map<entt::entity, PublishedState> lastPublished;
+  bool cameraPublished = false;
+  glm::vec3 lastCameraPosition;
+  glm::vec3 lastCameraFront;
+
+  void readSubscriptions();
+  void publishPositionable(entt::entity, Positionable&);
+  void publishCamera();
+  void forget(entt::registry&, entt::entity);
+  void send(const string& topic, const google::protobuf::Message& message);
+
+public:
+  StatePublisher(shared_ptr<EntityRegistry>,
+                 Camera*,
+                 zmq::context_t& context,
+                 std::string bindAddress,
+                 double publishRate);
+  ~StatePublisher();
+  void publish(double time);
+};
+
+PositionableState
+toPositionableState(entt::entity, Positionable&);
+CameraState
+toCameraState(Camera*);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Prepared statements kept alive for the life of a connection and looked up
+// by their sql. Not thread safe, each connection's owner keeps its own.
+class StatementCache
+{
+  SQLite::Database& db;
+  std::unordered_map<std::string, std::unique_ptr<SQLite::Statement>>
+    statements;
+
+public:
+  StatementCache(SQLite::Database& db);
+  // reset and cleared, ready for binding
+  SQLite::Statement& get(const std::string& sql);
+};
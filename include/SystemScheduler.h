@@ -0,0 +1,103 @@
+#pragma once
+
+#include "entt.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs the per-frame systems on a small pool of worker threads. Every system
+// declares the components it reads and writes; systems are grouped into
+// waves in the order they were added, a system joining the wave after the
+// last earlier system it conflicts with, so two systems that touch the same
+// component in a conflicting way always run in the order they were added
+// and the frame comes out the same however the threads are scheduled.
+// Systems that touch GL or other render thread state are added as
+// mainThread and run on the thread that calls run().
+class SystemScheduler
+{
+public:
+  using ComponentIds = std::vector<entt::id_type>;
+  using Run = std::function<void()>;
+  // work on [begin, end)
+  using Range = std::function<void(size_t begin, size_t end)>;
+
+  struct Timing
+  {
+    std::string name;
+    int wave;
+    double milliseconds;
+  };
+
+  template<typename... Components>
+  static ComponentIds components()
+  {
+    return { entt::type_hash<Components>::value()... };
+  }
+
+private:
+  struct System
+  {
+    std::string name;
+    ComponentIds reads;
+    ComponentIds writes;
+    Run run;
+    bool mainThread;
+  };
+
+  // one dispatch of count jobs, shared with the workers so a worker that is
+  // late to notice the batch finished never touches freed memory
+  struct Batch
+  {
+    std::function<void(size_t)> job;
+    size_t count;
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> finished = 0;
+  };
+
+  std::vector<System> systems;
+  std::vector<std::vector<size_t>> waves;
+  std::vector<Timing> timings;
+
+  std::vector<std::thread> workers;
+  std::mutex batchMutex;
+  std::condition_variable batchReady;
+  std::condition_variable batchDone;
+  std::shared_ptr<Batch> batch;
+  uint64_t generation = 0;
+  bool stopping = false;
+  bool dispatching = false;
+
+  bool conflicts(const System&, const System&);
+  void work();
+  void help(Batch&);
+  std::shared_ptr<Batch> start(size_t count, std::function<void(size_t)> job);
+  void finish(std::shared_ptr<Batch>);
+  void runSystem(size_t index);
+
+public:
+  // workers defaults to one less than the hardware threads, the caller of
+  // run() and parallelFor() makes up the last one
+  SystemScheduler(int workers = -1);
+  ~SystemScheduler();
+  void add(std::string name,
+           ComponentIds reads,
+           ComponentIds writes,
+           Run run,
+           bool mainThread = false);
+  // runs every system once
+  void run();
+  // splits [0, count) into chunks of at most grain and runs them across the
+  // workers, returning once all of them are done. Chunks run in any order,
+  // so fn must only touch what its own range owns. Called from inside a
+  // system that is already running on a worker it runs inline.
+  void parallelFor(size_t count, size_t grain, Range fn);
+  // the last run(), in the order the systems were added
+  const std::vector<Timing>& getTimings();
+  size_t workerCount();
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Batched Positionable::update. The fields of the damaged entities are
+// gathered into one array per field so eight entities at a time fit an
+// AVX2 register; CPUs without AVX2 take the scalar path over the same
+// arrays. Both build the model matrix in closed form, pos - R * origin
+// for the translation and R * scale for the rest, and take the normal
+// matrix as R / scale instead of inverting the model matrix.
+class TransformBatch
+{
+  std::vector<float> posX, posY, posZ;
+  std::vector<float> originX, originY, originZ;
+  std::vector<float> rotateX, rotateY, rotateZ;
+  std::vector<float> scale;
+
+  void computeScalar(size_t begin, size_t end);
+  void computeAvx2(size_t begin, size_t end);
+
+public:
+  std::vector<glm::mat4> modelMatrices;
+  std::vector<glm::mat3> normalMatrices;
+
+  // how many entities a lane group covers, chunks of a batch split at a
+  // multiple of this all run on the vector path
+  static const size_t WIDTH = 8;
+
+  void resize(size_t size);
+  size_t size();
+  void set(size_t index,
+           glm::vec3 pos,
+           glm::vec3 origin,
+           glm::vec3 rotate,
+           float scale);
+  // fills modelMatrices and normalMatrices for [begin, end)
+  void compute(size_t begin, size_t end);
+  static bool hasAvx2();
+};
+
+namespace transformKernel {
+// the same closed form for a single entity, rotate in degrees
+void compose(glm::vec3 pos,
+             glm::vec3 origin,
+             glm::vec3 rotate,
+             float scale,
+             glm::mat4& modelMatrix,
+             glm::mat3& normalMatrix);
+}
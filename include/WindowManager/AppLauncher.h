@@ -0,0 +1,54 @@
+#pragma once
+
+#include "entity.h"
+#include <X11/X.h>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace WindowManager {
+
+// Apps are forked without waiting on them. Each launch is matched to the
+// first new top level window whose _NET_WM_PID is the launched process or
+// one of its descendants, or whose class is the one expected (ignoring case),
+// as the substructure thread sees it created or asked to be mapped.
+class AppLauncher
+{
+public:
+  struct Launch
+  {
+    entt::entity entity;
+    int forkedPid;
+    // the app's own pid when it isn't a descendant of forkedPid, like the
+    // one a shell script writes to its pid file
+    std::optional<int> pid;
+    std::optional<std::string> className;
+    std::promise<Window> promise;
+    std::shared_future<Window> window;
+  };
+  using Handle = std::shared_ptr<Launch>;
+
+  Handle expect(entt::entity,
+                int forkedPid,
+                std::optional<std::string> className = std::nullopt);
+  void identify(Handle, int pid);
+  // stop waiting for a window that hasn't come
+  void cancel(Handle);
+  // the entity launched to open window, if it was one. Resolves that
+  // launch's window.
+  std::optional<entt::entity> claim(Window,
+                                    std::optional<int> pid,
+                                    const std::string& className);
+  size_t pendingCount();
+  // pid and its ancestors according to /proc, nearest first
+  static std::vector<int> lineage(int pid);
+
+private:
+  std::mutex mutex;
+  std::vector<Handle> pending;
+};
+
+}
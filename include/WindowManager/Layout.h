@@ -0,0 +1,91 @@
+#pragma once
+
+#include "entity.h"
+#include <glm/glm.hpp>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace WindowManager {
+
+// Where apps without a position of their own go. The wall is a grid of
+// cells, columns wide and as many rows tall as it takes, numbered along
+// each row from the bottom left, and every app that is tiled covers one
+// column of cells starting at the lowest free number it fits. Stacked apps
+// share one cell, a little in front of one another. Free numbers are kept
+// sorted, so placing an app one cell tall is a lookup in a set.
+class Layout
+{
+public:
+  enum class Mode
+  {
+    TILE,
+    STACK
+  };
+
+  struct Wall
+  {
+    // centre of the bottom left cell
+    glm::vec3 origin = glm::vec3(-1.2, 1.1, -2);
+    glm::vec2 cell = glm::vec2(1.2, 0.75);
+    int columns = 3;
+    // how far each stacked app sits from the one behind it
+    glm::vec3 stackStep = glm::vec3(0.04, -0.04, 0.02);
+  };
+
+  struct Move
+  {
+    entt::entity entity;
+    glm::vec3 pos;
+  };
+
+  Layout();
+  Layout(Wall);
+
+  // aspect is the app's height / width, which is how tall its quad is at
+  // scale 1
+  glm::vec3 place(entt::entity, float aspect, Mode = Mode::TILE);
+  // keeps the cells under an app positioned some other way free of tiled
+  // apps, if it is on the wall
+  void occupy(entt::entity, glm::vec3 pos, float aspect);
+  void remove(entt::entity);
+  bool contains(entt::entity);
+  std::optional<glm::vec3> positionOf(entt::entity);
+  size_t size();
+  // packs everything into the lowest cells in the order it's in now and
+  // closes the gaps in the stack, returning where the apps that moved go
+  std::vector<Move> relayout();
+
+private:
+  struct Slot
+  {
+    Mode mode;
+    // first cell, the stack's for stacked apps
+    int cell;
+    int span;
+    // place in the stack, 0 at the back
+    int depth = 0;
+  };
+
+  Wall wall;
+  std::map<entt::entity, Slot> slots;
+  // every cell below nextCell that nothing covers
+  std::set<int> freeCells;
+  int nextCell = 0;
+  // cells taken by apps on the wall that the layout didn't put there
+  std::map<entt::entity, std::pair<int, int>> occupied;
+  std::optional<int> stackCell;
+  std::map<int, entt::entity> stack;
+
+  int span(float aspect);
+  int allocate(int span);
+  bool isFree(int cell);
+  void take(int cell);
+  void release(int cell);
+  void takeColumn(int cell, int span);
+  void releaseColumn(int cell, int span);
+  glm::vec3 positionOf(const Slot&);
+};
+
+}
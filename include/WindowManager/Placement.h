@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+namespace WindowManager {
+
+// Where app quads go so their texels land one to one on screen pixels. An
+// app quad is one unit wide and height / width tall before its
+// Positionable's scale, facing +z.
+namespace placement {
+
+// how far in front of the camera a quad of the given scale has to be for a
+// window width pixels wide to cover exactly width pixels. Solved from the
+// projection matrix directly: the x = 0.5 edge projects to
+// (0.5 p00 - z p20 + p30) / (0.5 p03 - z p23 + p33), which is linear in z
+// once set equal to the pixel width's share of the screen.
+float
+viewDistance(const glm::mat4& projection,
+             float width,
+             float screenWidth,
+             float scale = 1);
+
+// screen pixels one unit spans, facing the camera distance units away
+float
+pixelsPerUnit(const glm::mat4& projection, float distance, float screenWidth);
+
+enum class Align
+{
+  TOP,
+  CENTER,
+  BOTTOM
+};
+
+struct Grid
+{
+  // windows per row, rows are filled left to right, top to bottom
+  int columns = 3;
+  // pixels between neighbouring windows
+  float gap = 16;
+  // where windows shorter than their row sit in it
+  Align align = Align::TOP;
+};
+
+struct Placed
+{
+  glm::vec3 pos;
+  // degrees, as Positionable has it
+  glm::vec3 rotate;
+  float scale;
+};
+
+// Tiles windows of the given pixel sizes on the plane distance units in
+// front of eye, each scaled so it is pixel perfect from eye, centred on the
+// direction facing looks along. One Placed per size, in order.
+std::vector<Placed>
+tile(const glm::mat4& projection,
+     float screenWidth,
+     glm::vec3 eye,
+     glm::quat facing,
+     float distance,
+     const std::vector<glm::vec2>& sizes,
+     const Grid& grid = Grid());
+
+}
+
+}
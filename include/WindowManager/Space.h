@@ -3,10 +3,11 @@
 #include <glm/glm.hpp>
 #include <unordered_map>
 #include <vector>
-#include <queue>
 #include "entity.h"
 #include "loader.h"
 #include "app.h"
+#include "WindowManager/Layout.h"
+#include "WindowManager/Placement.h"
 #include <glm/gtx/hash.hpp>
 #include <optional>
 
@@ -21,11 +22,19 @@ namespace WindowManager {
     shared_ptr<spdlog::logger> logger;
     Renderer *renderer = NULL;
     Camera *camera = NULL;
-    queue<glm::vec3> availableAppPositions;
+    Layout layout;
+    Layout::Mode layoutMode = Layout::Mode::TILE;
+    bool reflowOnClose = true;
 
     size_t numPositionableApps = 0;
 
-    void initAppPositions();
+    // view distances by window width and scale, for the projection they
+    // were solved with
+    unordered_map<glm::vec2, float> viewDistances;
+    glm::mat4 viewDistanceProjection = glm::mat4(0);
+
+    Layout::Wall wallFromConfig();
+    Layout::Mode layoutModeFromConfig();
 
   public:
     Space(shared_ptr<EntityRegistry>, Renderer *, Camera *, spdlog::sink_ptr);
@@ -34,11 +43,20 @@ namespace WindowManager {
     glm::vec3 getAppPosition(entt::entity);
     glm::vec3 getAppRotation(entt::entity);
     optional<entt::entity> getLookedAtApp();
+    // tiles apps in front of the camera, each pixel perfect from where it
+    // stands, as one update
+    void placePixelPerfect(const vector<entt::entity>&,
+                           const placement::Grid& = placement::Grid());
 
     size_t getNumPositionableApps();
 
     void addApp(entt::entity, bool = false);
     void removeApp(entt::entity);
     void toggleAppSelect(entt::entity);
+    // how apps without a position are laid out from now on
+    void setLayoutMode(Layout::Mode);
+    // packs the laid out apps into the gaps left by closed ones, moving
+    // them all in one update
+    void relayout();
   };
 }
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "entity.h"
+#include <X11/X.h>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+class X11App;
+
+namespace WindowManager {
+enum WINDOW_EVENT_TYPE
+{
+  SMALLER,
+  LARGER
+};
+struct WindowEvent
+{
+  WINDOW_EVENT_TYPE type;
+  entt::entity window;
+};
+
+// What the event thread saw between two of the render thread's ticks, with
+// each window's ConfigureNotify stream collapsed to the size it ended at and
+// its XDamage notifies to one redraw. The event thread never reads the
+// registry: windows are resolved to their entities when tick applies the
+// batch, and new windows get theirs there too.
+struct WindowChanges
+{
+  struct Size
+  {
+    int width;
+    int height;
+  };
+  struct Added
+  {
+    X11App* app;
+    Window window;
+    // known up front for a launch's window and boot apps, otherwise matched
+    // to a bootable or created by tick
+    std::optional<entt::entity> entity;
+  };
+
+  std::vector<Added> added;
+  std::vector<Window> removed;
+  std::vector<WindowEvent> events;
+  std::map<Window, Size> configured;
+  std::set<Window> damaged;
+  // events folded into the ones above
+  size_t coalesced = 0;
+
+  void configure(Window window, int width, int height)
+  {
+    if (!configured.insert_or_assign(window, Size{ width, height }).second) {
+      coalesced++;
+    }
+  }
+
+  void damage(Window window)
+  {
+    if (!damaged.insert(window).second) {
+      coalesced++;
+    }
+  }
+
+  bool empty()
+  {
+    return added.empty() && removed.empty() && events.empty() &&
+           configured.empty() && damaged.empty();
+  }
+
+  void clear()
+  {
+    added.clear();
+    removed.clear();
+    events.clear();
+    configured.clear();
+    damaged.clear();
+    coalesced = 0;
+  }
+};
+}
@@ -1,5 +1,8 @@
 #pragma once
+#include "WindowManager/AppLauncher.h"
 #include "WindowManager/Space.h"
+#include "WindowManager/WindowChanges.h"
+#include "Handoff.h"
 #include "app.h"
 #include "entity.h"
 #include "logger.h"
@@ -7,10 +10,12 @@
 #include "components/Bootable.h"
 #include <X11/Xlib.h>
 #include <X11/extensions/Xcomposite.h>
+#include <X11/extensions/Xdamage.h>
 #include <atomic>
 #include <string>
 #include <map>
 #include <memory>
+#include <set>
 #include <spdlog/common.h>
 #include <thread>
 #include <optional>
@@ -29,16 +34,6 @@ struct IdeSelection {
 };
 
 namespace WindowManager {
-enum WINDOW_EVENT_TYPE
-{
-  SMALLER,
-  LARGER
-};
-struct WindowEvent
-{
-  WINDOW_EVENT_TYPE type;
-  entt::entity window;
-};
 class WindowManager
 {
   shared_ptr<EntityRegistry> registry;
@@ -46,6 +41,8 @@ class WindowManager
   Controls* controls = NULL;
   spdlog::sink_ptr logSink;
   int screen;
+  int damageEventBase = 0;
+  int damageErrorBase = 0;
   entt::entity emacs;
   entt::entity magicaVoxel;
   entt::entity microsoftEdge;
@@ -55,18 +52,29 @@ class WindowManager
 
   IdeSelection ideSelection;
 
+  // Super+1..9 jump to the first nine hotkeyed apps, Super+0 goes home. Apps
+  // past the ninth are still displayed, they just have no hotkey. Filled by
+  // tick, read by the event thread, both under renderLoopMutex.
+  static const int HOTKEY_SLOTS = 9;
   vector<optional<entt::entity>> appsWithHotKeys;
   optional<entt::entity> currentlyFocusedApp;
   shared_ptr<Space> space;
   Window matrix;
   Window overlay;
   atomic_bool firstRenderComplete = false;
+  // render thread only, the entity of each window whose X11App is added
   map<Window, entt::entity> dynamicApps;
+  // the event thread's view of the windows it manages, including ones tick
+  // hasn't added yet. Guarded by renderLoopMutex, boot adds to it too.
+  set<Window> knownWindows;
   mutex renderLoopMutex;
   mutex continueMutex;
-  vector<X11App*> appsToAdd;
-  vector<entt::entity> appsToRemove;
-  vector<WindowEvent> events;
+  // filled by the event thread, taken by tick
+  Handoff<WindowChanges> changes;
+  // render thread only: apps found at boot, and apps whose entity still had
+  // the X11App of a window being removed
+  vector<WindowChanges::Added> appsWaitingToAdd;
+  AppLauncher launcher;
   void forkOrFindApp(string cmd,
                      string pidOf,
                      string className,
@@ -83,15 +91,22 @@ class WindowManager
                  unsigned int width = Bootable::DEFAULT_WIDTH,
                  unsigned int height = Bootable::DEFAULT_HEIGHT);
   void addApp(X11App*, entt::entity);
+  void knowWindow(Window);
+  void resolveEntity(WindowChanges::Added&);
+  X11App* appForWindow(Window);
+  string windowClass(Window);
   void allow_input_passthrough(Window window);
   void capture_input(Window window, bool shapeBounding, bool shapeInput);
   void addApps();
   void createUnfocusHackThread(entt::entity entity);
   int waitForRemovalChangeSize(int curSize);
   void logWaitForRemovalChangeSize(int changeSize);
-  void adjustAppsToAddAfterAdditions(vector<X11App*>& waitForRemoval);
+  void adjustAppsToAddAfterAdditions(
+    vector<WindowChanges::Added>& waitForRemoval);
   void setWMProps(Window root);
-  void reconfigureWindow(XConfigureEvent);
+  void handleEvent(XEvent&);
+  void applyChanges(WindowChanges&);
+  void onDamage(XDamageNotifyEvent*);
   void swapHotKeys(int a, int b);
   int findAppsHotKey(entt::entity theApp);
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "StatementCache.h"
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Write-behind queue in front of the database. The render thread stages
+// writes as closures over copies of component data; a background thread
+// runs everything staged so far inside one transaction every flushInterval
+// milliseconds on its own WAL mode connection. Writes are keyed by the row
+// they touch ("Positionable/12"), so staging the same key again replaces the
+// pending write and moves it to the back of the queue. A crash loses at most
+// one flush interval.
+class WriteBehind
+{
+public:
+  // the writer thread's connection, prepared statements are cached by sql
+  class Connection
+  {
+    SQLite::Database db;
+    StatementCache statements;
+
+  public:
+    Connection(std::string dbFile);
+    SQLite::Database& getDatabase() { return db; }
+    // reset and cleared, ready for binding
+    SQLite::Statement& statement(const std::string& sql)
+    {
+      return statements.get(sql);
+    }
+  };
+  using Write = std::function<void(Connection&)>;
+
+private:
+  Connection connection;
+  std::shared_ptr<spdlog::logger> logger;
+  int flushInterval;
+
+  std::mutex pendingMutex;
+  std::vector<std::optional<Write>> pending;
+  std::unordered_map<std::string, size_t> pendingByKey;
+
+  // held while a batch runs, so flush() and the writer thread take turns
+  std::mutex connectionMutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  std::thread writer;
+
+  void run();
+  void drain();
+
+public:
+  WriteBehind(std::string dbFile, int flushInterval);
+  ~WriteBehind();
+  void stage(const std::string& key, Write write);
+  // blocks until everything staged so far is committed
+  void flush();
+  size_t pendingWrites();
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <X11/Xlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Window management requests made off the render thread. They are queued
+// and a thread of their own sends them in batches, so a frame never waits
+// on a round trip. Moves and resizes of one window queued before a batch
+// goes out collapse into one request. Each batch that resized or located a
+// window ends in a single XSync on that thread, after which the windows it
+// touched are marked so the render thread can rebind their textures.
+//
+// The window manager's queue shares its connection: configure requests
+// from any other client on a top level window would be redirected back to
+// the window manager, and key grabs belong to the connection that makes
+// them. That relies on XInitThreads having been called before it opened.
+class XRequestQueue
+{
+public:
+  // what the X thread has found out about a window, read on the render
+  // thread
+  struct WindowState
+  {
+    std::atomic_bool resized = false;
+    std::atomic_bool located = false;
+    std::atomic_int x = 0;
+    std::atomic_int y = 0;
+  };
+  using State = std::shared_ptr<WindowState>;
+
+  // sends on a connection that stays the caller's
+  XRequestQueue(Display*);
+  // connects to displayName, $DISPLAY when NULL
+  XRequestQueue(const char* displayName = NULL);
+  ~XRequestQueue();
+  bool isConnected();
+
+  void moveResize(Window, int x, int y, int width, int height, State);
+  void move(Window, int x, int y);
+  // the root relative position of the window's top left corner, into state
+  void locate(Window, State);
+  // anything else, sent in the order queued ahead of the batch's geometry
+  void request(std::function<void(Display*)>);
+  // waits until everything queued so far has been sent
+  void flush();
+  uint64_t getBatchCount();
+
+private:
+  struct Geometry
+  {
+    int x;
+    int y;
+    std::optional<int> width;
+    std::optional<int> height;
+    State state;
+  };
+
+  Display* display = NULL;
+  bool ownsDisplay = false;
+  std::thread sender;
+  std::mutex queueMutex;
+  std::condition_variable queued;
+  std::condition_variable sent;
+  bool stopping = false;
+  std::vector<std::function<void(Display*)>> requests;
+  std::map<Window, Geometry> geometry;
+  std::vector<std::pair<Window, State>> locates;
+  uint64_t queuedCount = 0;
+  uint64_t sentCount = 0;
+  uint64_t batchCount = 0;
+
+  void run();
+  void send(std::vector<std::function<void(Display*)>>&,
+            std::map<Window, Geometry>&,
+            std::vector<std::pair<Window, State>>&);
+};
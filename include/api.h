@@ -10,6 +10,8 @@
 #include "protos/api.pb.h"
 #include "world.h"
 #include "logger.h"
+#include "MpscRing.h"
+#include "StatePublisher.h"
 
 using namespace std;
 
@@ -17,6 +19,7 @@ namespace WindowManager {
   class WindowManager;
 }
 class Controls;
+class Camera;
 class Api;
 class CommandServer
 {
@@ -26,8 +29,12 @@ protected:
   zmq::socket_t socket;
 
 public:
-  CommandServer(Api* api, std::string bindAddress, zmq::context_t& context);
+  CommandServer(Api* api,
+                std::string bindAddress,
+                zmq::context_t& context,
+                zmq::socket_type type = zmq::socket_type::rep);
   virtual void poll() = 0;
+  zmq::socket_t& getSocket() { return socket; }
 };
 
 struct ApiCube
@@ -40,52 +47,98 @@ struct ApiCube
 
 struct BatchedRequest
 {
-  static int nextId;
+  static atomic<int64_t> nextId;
+  BatchedRequest() {}
   BatchedRequest(ApiRequest request)
     : request(request)
   {
     id = nextId++;
   }
-  int64_t id;
+  int64_t id = -1;
+  ApiRequest request;
+};
+
+// a snapshot query waiting for the render thread to read the registry, with
+// the frames that route its reply back to the client
+struct PendingQuery
+{
+  vector<string> envelope;
   ApiRequest request;
 };
 
 class Api
 {
 
+  // ROUTER socket taking one ApiRequest at a time from REQ clients. Queries
+  // are answered later by the render thread, so they don't hold up the
+  // requests behind them.
   class ProtobufCommandServer : public CommandServer
   {
-    using CommandServer::CommandServer;
+  public:
+    ProtobufCommandServer(Api* api,
+                          std::string bindAddress,
+                          zmq::context_t& context);
+    void poll() override;
+    // sends a reply the render thread prepared
+    void forward(vector<zmq::message_t>& reply);
+  };
+
+  // ROUTER socket taking ApiBatch messages from DEALER clients, so a client
+  // can keep sending without waiting on a reply for every request
+  class BatchCommandServer : public CommandServer
+  {
+  public:
+    BatchCommandServer(Api* api,
+                       std::string bindAddress,
+                       zmq::context_t& context);
     void poll() override;
   };
 
   Controls* controls;
+  Camera* camera;
   shared_ptr<WindowManager::WindowManager> wm;
 
   shared_ptr<spdlog::logger> logger;
   shared_ptr<EntityRegistry> registry;
 
   zmq::context_t context;
-  CommandServer* commandServer;
-
-  queue<BatchedRequest> batchedRequests;
+  ProtobufCommandServer* commandServer;
+  CommandServer* batchCommandServer;
+  StatePublisher* statePublisher;
+
+  mutex queryMutex;
+  vector<PendingQuery> pendingQueries;
+  // query replies, from the render thread to the poll thread which owns the
+  // socket they go out on
+  zmq::socket_t answersOut;
+  zmq::socket_t answersIn;
+  void answerQueries();
+
+  // filled by the poll thread, drained by the render loop
+  static const int MAX_QUEUED_REQUESTS = 4096;
+  MpscRing<BatchedRequest> batchedRequests;
 
-  mutex renderMutex;
   thread offRenderThread;
 
   std::atomic_bool continuePolling = true;
 
 protected:
-  void grabBatched();
-  queue<BatchedRequest>* getBatchedRequests();
-  void releaseBatched();
+  bool queueRequest(BatchedRequest& request);
+  void queueQuery(PendingQuery query);
   void processBatchedRequest(BatchedRequest);
 
 public:
-  Api(std::string bindAddress, shared_ptr<EntityRegistry>, Controls* controls, shared_ptr<WindowManager::WindowManager>);
+  Api(std::string bindAddress,
+      std::string batchBindAddress,
+      std::string stateBindAddress,
+      shared_ptr<EntityRegistry>,
+      Controls* controls,
+      Camera* camera,
+      shared_ptr<WindowManager::WindowManager>);
   ~Api();
   void poll();
   void mutateEntities();
+  void publishState();
 };
 
 #endif
@@ -2,13 +2,16 @@
 #define __APP_H__
 
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <X11/Xlib.h>
 #include <X11/extensions/Xcomposite.h>
+#include <X11/extensions/Xdamage.h>
 #include <X11/XKBlib.h>
 #include <glad/glad_glx.h>
 #include <glm/glm.hpp>
+#include "XRequestQueue.h"
 
 using namespace std;
 
@@ -42,12 +45,29 @@ class X11App
   int textureUnit = -1;
   int textureId = -1;
   atomic_bool focused = false;
+  // override_redirect, which a mapped window keeps
+  bool accessory = false;
   atomic_bool selected = false;
   X11App(Display* display, int screen);
   int x = 0;
   int y = 0;
   size_t appIndex;
 
+  // composite pixmap bound to textureId, rebound only when damaged
+  Pixmap pixmap = None;
+  GLXPixmap glxPixmap = None;
+  Damage damage = None;
+  atomic_bool damaged = false;
+  atomic_uint damageCount = 0;
+  unsigned int lastSampleCount = 0;
+  chrono::steady_clock::time_point lastSampleTime;
+  double updateRate = 0;
+  void releaseTexture();
+
+  // geometry and focus go through here, see XRequestQueue.h
+  static shared_ptr<XRequestQueue> requests;
+  XRequestQueue::State requestState = make_shared<XRequestQueue::WindowState>();
+
 public:
   X11App(X11App&& other) noexcept;
   static X11App* byName(string windowName,
@@ -81,6 +101,12 @@ public:
   static glm::mat4 recomputeHeightScaler(double width, double height);
   void positionNotify(int x, int y);
   void appTexture();
+  // frees the texture's pixmaps and stops tracking damage
+  void release();
+  void trackDamage();
+  void damageNotify();
+  bool refreshTexture();
+  double getUpdateRate();
   void attachTexture(int textureUnit, int textureId, size_t appIndex);
   void focus(Window matrix);
   void takeInputFocus();
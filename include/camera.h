@@ -86,6 +86,9 @@ public:
                                float moveSeconds);
   float getYaw() { return yaw; }
   float getPitch() { return pitch; }
+  float getYFov() { return yFov; }
+  float getZNear() { return zNear; }
+  float getZFar() { return zFar; }
   glm::mat4& getViewMatrix();
   bool viewMatrixUpdated();
   glm::mat4& getProjectionMatrix(bool isRenderLoop = false);
@@ -1,9 +1,32 @@
 #pragma once
 #include "SQLPersisterImpl.h"
+#include <glm/glm.hpp>
 #include <vector>
 
 struct Parent {
   std::vector<int> childrenIds;
+  // childrenIds resolved to entities, rebuilt only when the registry's
+  // locator has changed since the last call
+  const std::vector<entt::entity> &children(EntityRegistry &registry);
+  // call after editing childrenIds, and patch the Parent so the hierarchy
+  // looks at its children again
+  void invalidate() { resolvedAt = 0; }
+
+  std::vector<entt::entity> childEntities = {};
+  uint64_t resolvedAt = 0;
+};
+
+// The child side of a Parent, maintained by systems::updateAll. offset is
+// the child's matrix in its parent's space, so while attached the child's
+// world matrix is its parent's times offset. parentMatrix is the parent's
+// matrix when the child was last placed, which a child moved in the same
+// frame as its parent is carried from.
+struct Attached {
+  entt::entity parent;
+  glm::mat4 offset;
+  glm::mat3 normalOffset;
+  glm::mat4 parentMatrix;
+  uint64_t seen;
 };
 
 class ParentPersister: public SQLPersisterImpl {
@@ -13,7 +36,8 @@ class ParentPersister: public SQLPersisterImpl {
   void createTablesIfNeeded() override;
   void saveAll() override;
   void save(entt::entity) override;
-  void loadAll() override;
+  std::string selectAllQuery() override;
+  void loadRow(entt::entity, SQLite::Statement&) override;
   void load(entt::entity) override;
   void depersistIfGone(entt::entity) override;
 };
@@ -0,0 +1,41 @@
+#pragma once
+#include "SQLPersisterImpl.h"
+#include "entity.h"
+#include <glm/glm.hpp>
+
+struct Positionable
+{
+  Positionable(glm::vec3 pos, glm::vec3 origin, glm::vec3 rotate, float scale);
+  Positionable(Positionable* p);
+  glm::vec3 pos;
+  glm::vec3 origin;
+  glm::vec3 rotate;
+  float scale;
+  // the matrix described by pos, origin, rotate and scale
+  glm::mat4 transform();
+  void update();
+  // take a world matrix handed down from a parent and bring pos, rotate and
+  // scale in line with it
+  void follow(const glm::mat4& world, const glm::mat3& normal);
+  // where the entity was last placed, by the constructor, update() or
+  // follow(). Unlike transform() it doesn't see edits to the fields until
+  // they're committed.
+  glm::mat4 modelMatrix;
+  glm::mat3 normalMatrix;
+  bool damaged = true;
+  void damage();
+};
+
+class PositionablePersister : public SQLPersisterImpl
+{
+public:
+  PositionablePersister(std::shared_ptr<EntityRegistry> registry)
+    : SQLPersisterImpl("Positionable", registry){};
+  void createTablesIfNeeded() override;
+  void saveAll() override;
+  void save(entt::entity) override;
+  std::string selectAllQuery() override;
+  void loadRow(entt::entity, SQLite::Statement&) override;
+  void load(entt::entity) override;
+  void depersistIfGone(entt::entity) override;
+};
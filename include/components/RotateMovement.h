@@ -6,6 +6,7 @@
 #include <optional>
 
 #include <SQLiteCpp/SQLiteCpp.h>
+#include "WriteBehind.h"
 
 struct RotateMovement {
   RotateMovement(double degrees, double degreesPerSecond, glm::vec3 axis)
@@ -19,5 +20,12 @@ struct RotateMovement {
 };
 
 RotateMovement getMovementData(SQLite::Database &db, int movementId);
-int insertMovement(SQLite::Database &db, const RotateMovement &movement);
-void updateMovement(SQLite::Database &db, int movementId, const RotateMovement &movement);
+// reads axis_x, axis_y, axis_z, degrees, degrees_per_second starting at
+// column first. NULLs, from a left join that found no movement row, read as
+// a movement that turns nothing.
+RotateMovement movementFromColumns(SQLite::Statement &query, int first);
+// on the write-behind connection, with its cached statements
+int insertMovement(WriteBehind::Connection &connection,
+                   const RotateMovement &movement);
+void updateMovement(WriteBehind::Connection &connection, int movementId,
+                    const RotateMovement &movement);
@@ -28,7 +28,8 @@ class ScriptablePersister: public SQLPersisterImpl {
   void createTablesIfNeeded() override;
   void saveAll() override;
   void save(entt::entity) override;
-  void loadAll() override;
+  std::string selectAllQuery() override;
+  void loadRow(entt::entity, SQLite::Statement&) override;
   void load(entt::entity) override;
   void depersistIfGone(entt::entity) override;
 };
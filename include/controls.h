@@ -47,6 +47,7 @@ class Controls
   void handleSelectApp(GLFWwindow* window);
   void handleDMenu(GLFWwindow* window, World* world);
   void handleScreenshot(GLFWwindow* window);
+  void handleToggleRecording(GLFWwindow* window);
   void handleSave(GLFWwindow* window);
   void handleSelection(GLFWwindow* window);
   void handleCodeBlock(GLFWwindow* window);
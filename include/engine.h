@@ -7,6 +7,7 @@
 #include "world.h"
 #include "entity.h"
 #include "engineGui.h"
+#include "FrameScheduler.h"
 #include "MultiPlayer/Client.h"
 #include "MultiPlayer/Server.h"
 
@@ -24,6 +25,7 @@ class Engine
   Renderer* renderer;
   Controls* controls;
   Camera* camera;
+  FrameScheduler* frames;
   shared_ptr<WindowManager::WindowManager> wm;
   GLFWwindow* window;
   std::shared_ptr<spdlog::logger> logger;
@@ -40,6 +42,8 @@ public:
   Engine(GLFWwindow* window, char** envp);
   ~Engine();
   shared_ptr<EntityRegistry> getRegistry();
+  SystemScheduler& getScheduler();
+  FrameScheduler& getFrameScheduler();
   void initialize();
   void wire();
   void loop();
@@ -28,7 +28,7 @@ public:
             GLFWwindow* window,
             shared_ptr<EntityRegistry> registry,
             shared_ptr<LoggerVector>);
-  void render(double&, int, vector<double>&);
+  void render();
   shared_ptr<LoggerVector> getLoggerVector();
   void createNewEntity();
 };
@@ -3,25 +3,56 @@
 #include <SQLiteCpp/SQLiteCpp.h>
 #include <entt.hpp>
 #include "persister.h"
+#include "StatementCache.h"
+#include "WriteBehind.h"
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <optional>
+#include <unordered_set>
 
 class EntityRegistry : public entt::registry
 {
   std::shared_ptr<SQLite::Database> db;
+  std::unique_ptr<StatementCache> statements;
   std::vector<std::shared_ptr<SQLPersister>> persisters;
-  std::map<int, entt::entity> entityLocator;
+  // indexed by Persistable::entityId, entt::null where there's no entity.
+  // Ids are handed out sequentially so this stays dense.
+  std::vector<entt::entity> entityLocator;
+  uint64_t locatorGeneration = 1;
+  // declared after persisters so its final flush runs while they're alive
+  std::unique_ptr<WriteBehind> writeBehind;
+  std::unordered_set<entt::entity> dirty;
+  // dirty entities are staged at most once a flush interval, so one that
+  // moves every frame is copied out once per write rather than per frame
+  std::chrono::milliseconds flushInterval;
+  std::chrono::steady_clock::time_point lastStaged;
+  int64_t lastEntityId = 0;
+
+  void locate(int64_t entityId, entt::entity);
+  void stageAllDirty();
+  void forget(entt::registry&, entt::entity);
 
 public:
   EntityRegistry();
+  EntityRegistry(std::string dbFile);
   SQLite::Database &getDatabase();
+  // cached on the main connection, for loading on the render thread
+  SQLite::Statement &statement(const std::string &sql);
+  WriteBehind &getWriteBehind();
   void addPersister(std::shared_ptr<SQLPersister>);
   void depersist(entt::entity);
   entt::entity createPersistent();
   void createTablesIfNeeded();
   void saveAll();
   void save(entt::entity);
+  // render thread only; the entity is saved the next time dirty entities
+  // are staged
+  void markDirty(entt::entity);
+  // stages the dirty entities if a flush interval has passed since last time
+  void stageDirty();
+  // stages every dirty entity and blocks until it's all in the database
+  void flush();
   void loadAll();
   void load(entt::entity);
   template<typename T>
@@ -34,4 +65,7 @@ public:
   };
 
   std::optional<entt::entity> locateEntity(int entityIdForDB);
+  // changes whenever an id starts or stops resolving to an entity, so
+  // anything caching locateEntity results knows to look again
+  uint64_t getLocatorGeneration() { return locatorGeneration; }
 };
@@ -1,44 +1,18 @@
 #pragma once
 
 #include "components/BoundingSphere.h"
+#include "components/Positionable.h"
 #include "mesh.h"
 #include "SQLPersisterImpl.h"
 #include "shader.h"
 #include <assimp/mesh.h>
 #include <assimp/scene.h>
 #include "entity.h"
+#include <optional>
 
 unsigned int
 TextureFromFile(const char* path, const string& directory, bool gamma = false);
 
-struct Positionable
-{
-  Positionable(glm::vec3 pos, glm::vec3 origin, glm::vec3 rotate, float scale);
-  Positionable(Positionable* p);
-  glm::vec3 pos;
-  glm::vec3 origin;
-  glm::vec3 rotate;
-  float scale;
-  void update();
-  glm::mat4 modelMatrix;
-  glm::mat3 normalMatrix;
-  bool damaged = true;
-  void damage();
-};
-
-class PositionablePersister : public SQLPersisterImpl
-{
-public:
-  PositionablePersister(std::shared_ptr<EntityRegistry> registry)
-    : SQLPersisterImpl("Positionable", registry){};
-  void createTablesIfNeeded() override;
-  void saveAll() override;
-  void save(entt::entity) override;
-  void loadAll() override;
-  void load(entt::entity) override;
-  void depersistIfGone(entt::entity) override;
-};
-
 class Model
 {
 public:
@@ -46,9 +20,11 @@ public:
   Model(string path);
   void Draw(Shader& shader);
 
-  BoundingSphere getBoundingSphere(float scale);
+  // in model space, computed on first use
+  BoundingSphere getBoundingSphere();
 
 private:
+  std::optional<BoundingSphere> boundingSphere;
   // model data
   vector<Mesh> meshes;
   vector<MeshTexture> textures_loaded;
@@ -71,7 +47,8 @@ public:
   void createTablesIfNeeded() override;
   void saveAll() override;
   void save(entt::entity) override;
-  void loadAll() override;
+  std::string selectAllQuery() override;
+  void loadRow(entt::entity, SQLite::Statement&) override;
   void load(entt::entity) override;
   void depersistIfGone(entt::entity) override;
 };
@@ -3,6 +3,10 @@
 #include <memory.h>
 #include <string>
 
+namespace SQLite {
+class Statement;
+}
+
 struct Persistable
 {
   int64_t entityId;
@@ -14,7 +18,12 @@ public:
   virtual void createTablesIfNeeded() = 0;
   virtual void saveAll() = 0;
   virtual void save(entt::entity) = 0;
-  virtual void loadAll() = 0;
+  // every row this persister loads, entity_id first and ordered by it, so
+  // EntityRegistry::loadAll can merge all tables in one pass
+  virtual std::string selectAllQuery() = 0;
+  // emplace components from the current row of selectAllQuery, tables with
+  // several rows per entity get called once for each
+  virtual void loadRow(entt::entity, SQLite::Statement&) = 0;
   virtual void load(entt::entity) = 0;
   virtual void depersist(entt::entity) = 0;
   virtual void depersistIfGone(entt::entity) = 0;
@@ -1,6 +1,8 @@
 #ifndef __RENDERER_H__
 #define __RENDERER_H__
+#include "FrameCapture.h"
 #include "IndexPool.h"
+#include "LightClusters.h"
 #include "WindowManager/WindowManager.h"
 #include "blocks.h"
 #include "dynamicObject.h"
@@ -64,8 +66,15 @@ class Renderer
   Shader* cameraShader;
   Shader* appShader;
   Shader* depthShader;
+  LightClusters* lightClusters;
+  FrameCapture* frameCapture;
   std::map<string, Texture*> textures;
-  void initAppTextures();
+  // one texture per app slot, created on first use and reused once the slot
+  // is released. Apps are drawn one quad at a time so every app samples
+  // through the same texture unit and there is no fixed slot count.
+  vector<Texture*> appTextures;
+  Texture* appTextureSlot(int index);
+  void bindAppTexture(int index);
   glm::mat4 trans;
   glm::mat4 view;
   glm::mat4 orthographicMatrix;
@@ -85,6 +94,7 @@ class Renderer
   void updateShaderUniforms();
   void renderChunkMesh();
   void renderApps();
+  void refreshAppTextures();
   void renderLines();
   void renderLookedAtFace();
   void renderDynamicObjects();
@@ -109,6 +119,7 @@ class Renderer
   IndexPool appIndexPool;
 
 public:
+  static const int APP_TEXTURE_UNIT = 11;
   Renderer(shared_ptr<EntityRegistry> registry,
            Camera*,
            World*,
@@ -125,6 +136,8 @@ public:
   void deregisterApp(int index);
   void reloadChunk();
   void screenshot();
+  void toggleRecording();
+  void captureFrame();
   void toggleMeshing();
   void toggleWireframe();
   void wireWindowManager(shared_ptr<WindowManager::WindowManager>, shared_ptr<WindowManager::Space>);
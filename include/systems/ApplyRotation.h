@@ -5,5 +5,6 @@
 #include <memory>
 
 namespace systems {
-void applyRotation(std::shared_ptr<EntityRegistry>);
+// turns each RotateMovement by what it covers in seconds
+void applyRotation(std::shared_ptr<EntityRegistry>, double seconds);
 };
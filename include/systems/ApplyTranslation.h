@@ -5,5 +5,6 @@
 #include <memory>
 
 namespace systems {
-void applyTranslations(std::shared_ptr<EntityRegistry>);
+// moves each TranslateMovement on by what it covers in seconds
+void applyTranslations(std::shared_ptr<EntityRegistry>, double seconds);
 };
@@ -1,16 +1,34 @@
 #pragma once
 
 #include "entity.h"
+#include <future>
 #include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
 #include "app.h"
 namespace systems {
+// a Bootable that has been forked. pid is the forked process for a plain
+// command, for a shell script it's what the script writes to its pid file
+// and is ready once it has.
+struct Launched
+{
+  entt::entity entity;
+  int forkedPid;
+  std::shared_future<std::optional<int>> pid;
+};
+// forks entity's command if it should boot and isn't already running
+std::optional<Launched>
+launch(std::shared_ptr<EntityRegistry> registry,
+       entt::entity entity,
+       char** envp);
+// launches every Bootable without waiting on any of them
+std::vector<Launched>
+launchAll(std::shared_ptr<EntityRegistry> registry, char** envp);
 void
 boot(std::shared_ptr<EntityRegistry> registry,
      entt::entity entity,
      char** envp);
-void
-bootAll(std::shared_ptr<EntityRegistry> registry, char** envp);
 
 std::vector<std::pair<entt::entity, int>>
 getAlreadyBooted(std::shared_ptr<EntityRegistry> registry);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "entity.h"
+#include <memory>
+#include <vector>
+class SystemScheduler;
+namespace systems {
+// positions every damaged entity and carries Parent children along, true
+// when anything moved. Given a scheduler, entities without a hierarchy have
+// their matrices computed across its workers. Given moved, every entity
+// whose matrices changed is added to it.
+bool updateTransforms(std::shared_ptr<EntityRegistry>,
+                      SystemScheduler* scheduler = NULL,
+                      std::vector<entt::entity>* moved = NULL);
+}
@@ -1,10 +1,15 @@
 #pragma once
 
 #include "entity.h"
+#include "systems/Transforms.h"
 #include <memory>
 class Renderer;
+class SystemScheduler;
 namespace systems {
-void
-updateAll(std::shared_ptr<EntityRegistry>, Renderer* renderer);
+// true when anything moved, and the lights' shadow maps are out of date
+bool
+updateAll(std::shared_ptr<EntityRegistry>,
+          Renderer* renderer,
+          SystemScheduler* scheduler = NULL);
 void update(std::shared_ptr<EntityRegistry>, entt::entity);
 }
@@ -18,14 +18,17 @@
 #include <unordered_map>
 #include <vector>
 #include <queue>
+#include <functional>
 #include <future>
 #include <optional>
 #include "loader.h"
 #include "dynamicObject.h"
 #include "worldInterface.h"
 #include "model.h"
+#include "SystemScheduler.h"
 
 class Renderer;
+class FrameScheduler;
 
 struct App
 {
@@ -77,7 +80,15 @@ class World : public WorldInterface
   void logCoordinates(array<Coordinate, 2> c, string label);
   shared_ptr<DynamicObjectSpace> dynamicObjects;
   void cubeAction(Action toTake);
+  function<void(int x, int y, int z, int blockType)> cubeEditListener;
   void dynamicObjectAction(Action toTake);
+  SystemScheduler scheduler;
+  FrameScheduler* frames = NULL;
+  // seconds since the previous tick, what the movement systems advance by
+  double tickSeconds = 0;
+  double lastTick = -1;
+  void addSystems();
+  void relight();
 
 public:
   void tick() override;
@@ -90,6 +101,8 @@ public:
         spdlog::sink_ptr loggerSink = fileSink);
   ~World();
   void attachRenderer(Renderer* renderer) override;
+  // meshing and shadow maps wait for the frame's spare time once attached
+  void attachFrameScheduler(FrameScheduler*);
   Loader* loader;
   Position getLookedAtCube() override;
 
@@ -115,6 +128,9 @@ public:
   {
     return dynamicObjects;
   };
+  SystemScheduler& getScheduler() { return scheduler; }
+  // called with each cube the player places, or removes with blockType -1
+  void onCubeEdit(function<void(int x, int y, int z, int blockType)>);
 };
 
 #endif
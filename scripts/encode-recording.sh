@@ -0,0 +1,10 @@
+#!/bin/bash
+# encode a recording captured with toggle_recording into an mp4
+# usage: encode-recording.sh recordings/<dir> [fps] [WIDTHxHEIGHT for raw]
+dir=$1
+fps=${2:-30}
+if ls "$dir"/frame-*.rgba > /dev/null 2>&1; then
+  cat "$dir"/frame-*.rgba | ffmpeg -f rawvideo -pixel_format rgba -video_size "$3" -framerate "$fps" -i - -vf vflip -pix_fmt yuv420p "$dir.mp4"
+else
+  ffmpeg -framerate "$fps" -i "$dir/frame-%06d.png" -pix_fmt yuv420p "$dir.mp4"
+fi
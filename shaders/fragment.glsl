@@ -8,18 +8,8 @@ in vec3 Normal;
 
 uniform sampler2DArray allBlocks;
 uniform sampler2D texture_diffuse1;
-uniform sampler2D app0;
-uniform sampler2D app1;
-uniform sampler2D app2;
-uniform sampler2D app3;
-uniform sampler2D app4;
-uniform sampler2D app5;
-uniform sampler2D app6;
-uniform sampler2D app7;
-uniform sampler2D app8;
-uniform sampler2D app9;
+uniform sampler2D appTexture;
 uniform bool isApp;
-uniform int appNumber;
 uniform bool SHADOWS_ENABLED;
 uniform bool isModel;
 uniform bool isLine;
@@ -30,17 +20,25 @@ uniform bool isDynamicObject;
 uniform bool isLight;
 uniform bool appTransparent;
 uniform float time;
-const int MAX_LIGHTS = 10;
-uniform int numLights;
 uniform samplerCube depthCubeMap0;
 uniform samplerCube depthCubeMap1;
 uniform samplerCube depthCubeMap2;
 uniform samplerCube depthCubeMap3;
 uniform samplerCube depthCubeMap4;
-uniform vec3 lightPos[MAX_LIGHTS];
-uniform vec3 lightColor[MAX_LIGHTS];
 uniform vec3 viewPos;
-uniform float far_plane[MAX_LIGHTS];
+uniform vec3 emissiveColor;
+uniform mat4 view;
+
+// clustered lights (see LightClusters)
+// lightData: 2 texels per light, (pos.xyz, radius) and (color.rgb, shadowIndex)
+// clusterGrid: (offset, count) into lightIndices for every froxel
+uniform samplerBuffer lightData;
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer lightIndices;
+uniform vec3 clusterDims;
+uniform vec2 clusterScreen;
+uniform float clusterZNear;
+uniform float clusterSliceScale;
 
 struct Material {
   vec3 ambient;
@@ -92,14 +90,14 @@ vec4 colorFromTexture(sampler2D tex, vec2 coord) {
 }
 
 
-float ShadowCalculation(samplerCube depthMap, vec3 fragPos, vec3 norm, vec3 lightDir, int lightIndex)
+float ShadowCalculation(samplerCube depthMap, vec3 fragPos, vec3 norm, vec3 lightDir, vec3 lightPos, float farPlane)
 {
   // get vector between fragment position and light position
-  vec3 fragToLight = fragPos - lightPos[lightIndex];
+  vec3 fragToLight = fragPos - lightPos;
   // use the light to fragment vector to sample from the depth map
   float closestDepth = texture(depthMap, fragToLight).r;
   // it is currently in linear range between [0,1]. Re-transform back to original value
-  closestDepth *= far_plane[lightIndex];
+  closestDepth *= farPlane;
   // now get current linear depth as the length between the fragment and light position
   float currentDepth = length(fragToLight);
   // now test for shadows
@@ -109,101 +107,91 @@ float ShadowCalculation(samplerCube depthMap, vec3 fragPos, vec3 norm, vec3 ligh
   return shadow;
 }
 
-vec4 Light(int i, samplerCube depthMap) {
+// sampler arrays can only be indexed with constants in 330
+float Shadow(int shadowIndex, vec3 norm, vec3 lightDir, vec3 lightPos, float farPlane) {
+  if(shadowIndex == 0) {
+    return ShadowCalculation(depthCubeMap0, FragPos, norm, lightDir, lightPos, farPlane);
+  } else if (shadowIndex == 1) {
+    return ShadowCalculation(depthCubeMap1, FragPos, norm, lightDir, lightPos, farPlane);
+  } else if (shadowIndex == 2) {
+    return ShadowCalculation(depthCubeMap2, FragPos, norm, lightDir, lightPos, farPlane);
+  } else if (shadowIndex == 3) {
+    return ShadowCalculation(depthCubeMap3, FragPos, norm, lightDir, lightPos, farPlane);
+  } else if (shadowIndex == 4) {
+    return ShadowCalculation(depthCubeMap4, FragPos, norm, lightDir, lightPos, farPlane);
+  }
+  return 0.0;
+}
+
+vec4 Light(vec3 lightPos, vec3 lightColor, float radius, int shadowIndex) {
   // ambient
   float ambientStrength = 0.2;
-  vec3 ambient = ambientStrength * lightColor[i];
+  vec3 ambient = ambientStrength * lightColor;
 
   // diffuse
   vec3 norm = normalize(Normal);
-  vec3 lightDir = normalize(lightPos[i] - FragPos);
+  vec3 lightDir = normalize(lightPos - FragPos);
 
   float diff = max(dot(norm, lightDir), 0.0);
-  vec3 diffuse = diff * lightColor[i];
+  vec3 diffuse = diff * lightColor;
 
   float specularStrength = 0.5;
   float shininess = 32;
   vec3 viewDir = normalize(viewPos - FragPos);
   vec3 reflectDir = reflect(-lightDir, norm);
   float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-  vec3 specular = specularStrength * spec * lightColor[i];
+  vec3 specular = specularStrength * spec * lightColor;
+
+  // lights are binned by radius, so fade them out before the cluster edge
+  float falloff = clamp(1.0 - pow(length(lightPos - FragPos) / radius, 4.0), 0.0, 1.0);
+  falloff *= falloff;
 
   // calculate shadow
   float shadow = 0; 
 
   if(SHADOWS_ENABLED) {
-    shadow = ShadowCalculation(depthMap, FragPos, norm, lightDir, i);                      
+    shadow = Shadow(shadowIndex, norm, lightDir, lightPos, radius);
   }
   //float shadow = 0.0;
   //vec3 lighting = (ambient + (1.0 - shadow) * (diffuse + specular)) * color;
-  return vec4(ambient + (1.0-shadow) * diffuse + specular, 1.0);
+  return vec4((ambient + (1.0-shadow) * diffuse + specular) * falloff, 1.0);
+}
+
+int clusterIndex() {
+  float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+  int slice = int(max(log(viewDepth / clusterZNear) * clusterSliceScale, 0.0));
+  slice = min(slice, int(clusterDims.z) - 1);
+  ivec2 tile = ivec2(gl_FragCoord.xy / clusterScreen * clusterDims.xy);
+  tile = clamp(tile, ivec2(0), ivec2(clusterDims.xy) - 1);
+  return (slice * int(clusterDims.y) + tile.y) * int(clusterDims.x) + tile.x;
+}
+
+vec3 ClusteredLights() {
+  vec3 lightOutput = vec3(0.0,0.0,0.0);
+  uvec2 cluster = texelFetch(clusterGrid, clusterIndex()).xy;
+  for(uint n = 0u; n < cluster.y; n++) {
+    int lightIndex = int(texelFetch(lightIndices, int(cluster.x + n)).r);
+    vec4 posRadius = texelFetch(lightData, lightIndex * 2);
+    vec4 colorShadow = texelFetch(lightData, lightIndex * 2 + 1);
+    lightOutput += vec3(Light(posRadius.xyz, colorShadow.rgb, posRadius.w, int(colorShadow.w)));
+  }
+  return lightOutput;
 }
 
 void main()
 {
 	// need to pass this in as vertex data, but hold for now
 	if(isApp) {
-		if(appNumber == 0) {
-			FragColor = colorFromTexture(app0, TexCoord);
-    } else if (appNumber == 1) {
-			FragColor = colorFromTexture(app1, TexCoord);
-		} else if (appNumber == 2) {
-			FragColor = colorFromTexture(app2, TexCoord);
-		} else if (appNumber == 3) {
-			FragColor = colorFromTexture(app3, TexCoord);
-		} else if (appNumber == 4) {
-			FragColor = colorFromTexture(app4, TexCoord);
-		} else if (appNumber == 5) {
-			FragColor = colorFromTexture(app5, TexCoord);
-		} 
-
-		else if (appNumber == 6) {
-			FragColor = colorFromTexture(app6, TexCoord);
-		} else if (appNumber == 7) {
-			FragColor = colorFromTexture(app7, TexCoord);
-		} else if (appNumber == 8) {
-			FragColor = colorFromTexture(app8, TexCoord);
-		} 
-
-		/*
-		else if (appNumber == 9) {
-			FragColor = colorFromTexture(app9, TexCoord);
-		} 
-		*/
+		FragColor = colorFromTexture(appTexture, TexCoord);
 		if(appSelected) {
 			FragColor = mix(FragColor, floor(TexCoord), 0.1);
 		}
 	} else if (isModel) {
 
     if(isLight) {
-      FragColor = vec4(lightColor[0], 1.0);
+      FragColor = vec4(emissiveColor, 1.0);
     } else {
-      vec3 lightOutput = vec3(0.0,0.0,0.0);
-
-      if(numLights == 1) {
-        lightOutput += vec3(Light(0, depthCubeMap0));
-      } else if (numLights == 2) {
-        lightOutput += vec3(Light(0, depthCubeMap0));
-        lightOutput += vec3(Light(1, depthCubeMap1));
-        
-      } else if (numLights == 3) {
-        lightOutput += vec3(Light(0, depthCubeMap0));
-        lightOutput += vec3(Light(1, depthCubeMap1));
-        lightOutput += vec3(Light(2, depthCubeMap2));
-      } else if (numLights == 4) {
-        lightOutput += vec3(Light(0, depthCubeMap0));
-        lightOutput += vec3(Light(1, depthCubeMap1));
-        lightOutput += vec3(Light(2, depthCubeMap2));
-        lightOutput += vec3(Light(3, depthCubeMap3));
-      } else if (numLights == 5) {
-        lightOutput += vec3(Light(0, depthCubeMap0));
-        lightOutput += vec3(Light(1, depthCubeMap1));
-        lightOutput += vec3(Light(2, depthCubeMap2));
-        lightOutput += vec3(Light(3, depthCubeMap3));
-        lightOutput += vec3(Light(4, depthCubeMap4));
-      }
-
-
+      vec3 lightOutput = ClusteredLights();
       FragColor = vec4(lightOutput,1) * texture(texture_diffuse1, TexCoord);
     }
 	} 
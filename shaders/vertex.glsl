@@ -23,7 +23,6 @@ uniform bool isDynamicObject;
 uniform bool isModel;
 uniform bool directRender;
 uniform int lookedAtBlockType;
-uniform int appNumber;
 
 void main()
 {
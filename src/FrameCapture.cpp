@@ -0,0 +1,251 @@
+#include "FrameCapture.h"
+#include "logger.h"
+#include "stb/stb_image_write.h"
+#include "tracy/Tracy.hpp"
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+FrameCapture::FrameCapture(int encoderThreads)
+{
+  logger = std::make_shared<spdlog::logger>("FrameCapture", fileSink);
+  logger->set_level(spdlog::level::info);
+  stbi_flip_vertically_on_write(true);
+  for (int i = 0; i < RING_SIZE; i++) {
+    glGenBuffers(1, &slots[i].pbo);
+  }
+  for (int i = 0; i < std::max(encoderThreads, 1); i++) {
+    encoders.push_back(std::thread(&FrameCapture::encode, this));
+  }
+}
+
+FrameCapture::~FrameCapture()
+{
+  collect(true);
+  {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    stopping = true;
+  }
+  jobsReady.notify_all();
+  for (auto& encoder : encoders) {
+    encoder.join();
+  }
+  for (int i = 0; i < RING_SIZE; i++) {
+    glDeleteBuffers(1, &slots[i].pbo);
+  }
+}
+
+void
+FrameCapture::screenshot()
+{
+  screenshotRequested = true;
+}
+
+void
+FrameCapture::startRecording(double fps, bool raw)
+{
+  auto t = std::time(nullptr);
+  auto tm = *std::localtime(&t);
+  std::stringstream directorySS;
+  directorySS << "recordings/" << std::put_time(&tm, "%Y-%m-%d:%H-%M-%S");
+  recordDirectory = directorySS.str();
+  std::filesystem::create_directories(recordDirectory);
+
+  recordInterval = 1.0 / fps;
+  recordRaw = raw;
+  recordFrame = 0;
+  nextRecordTime = 0;
+  recording = true;
+  logger->info("recording to " + recordDirectory + " at " +
+               std::to_string(width) + "x" + std::to_string(height));
+}
+
+void
+FrameCapture::stopRecording()
+{
+  recording = false;
+  logger->info("stopped recording, " + std::to_string(recordFrame) +
+               " frames captured, " + std::to_string(droppedFrames) +
+               " dropped");
+}
+
+void
+FrameCapture::capture(int width, int height, double time)
+{
+  ZoneScoped;
+  collect(false);
+  if (width != this->width || height != this->height) {
+    resize(width, height);
+  }
+
+  if (screenshotRequested) {
+    screenshotRequested = false;
+    auto t = std::time(nullptr);
+    auto tm = *std::localtime(&t);
+    std::stringstream filenameSS;
+    filenameSS << "screenshots/"
+               << std::put_time(&tm, "%d-%m-%Y %H-%M-%S.png");
+    readback(filenameSS.str(), false);
+  }
+
+  if (recording && time >= nextRecordTime) {
+    // don't try to catch up on frames that were missed, just keep the pace
+    if (time - nextRecordTime > recordInterval) {
+      nextRecordTime = time;
+    }
+    nextRecordTime += recordInterval;
+    std::stringstream filenameSS;
+    filenameSS << recordDirectory << "/frame-" << std::setw(6)
+               << std::setfill('0') << recordFrame++
+               << (recordRaw ? ".rgba" : ".png");
+    readback(filenameSS.str(), recordRaw);
+  }
+}
+
+void
+FrameCapture::resize(int width, int height)
+{
+  // anything still in flight was read at the old size
+  for (int i = 0; i < RING_SIZE; i++) {
+    if (slots[i].fence) {
+      glDeleteSync(slots[i].fence);
+      slots[i].fence = NULL;
+      droppedFrames++;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[i].pbo);
+    glBufferData(
+      GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  this->width = width;
+  this->height = height;
+}
+
+void
+FrameCapture::readback(std::string filename, bool raw)
+{
+  auto& slot = slots[nextSlot];
+  if (slot.fence) {
+    // the GPU is more than RING_SIZE captures behind
+    droppedFrames++;
+    return;
+  }
+  nextSlot = (nextSlot + 1) % RING_SIZE;
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot.filename = filename;
+  slot.raw = raw;
+}
+
+// maps every readback the GPU has finished, oldest first, and queues it for
+// the encoders
+void
+FrameCapture::collect(bool wait)
+{
+  for (int i = 0; i < RING_SIZE; i++) {
+    auto& slot = slots[(nextSlot + i) % RING_SIZE];
+    if (!slot.fence) {
+      continue;
+    }
+    GLenum status = glClientWaitSync(slot.fence,
+                                     GL_SYNC_FLUSH_COMMANDS_BIT,
+                                     wait ? 1000000000 : 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+      return;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = NULL;
+    if (status == GL_WAIT_FAILED) {
+      droppedFrames++;
+      continue;
+    }
+
+    EncodeJob job{ slot.filename, slot.raw, width, height, {} };
+    {
+      std::lock_guard<std::mutex> lock(jobsMutex);
+      if (jobs.size() >= MAX_QUEUED_FRAMES) {
+        droppedFrames++;
+        continue;
+      }
+      if (!freeBuffers.empty()) {
+        job.pixels = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+      }
+    }
+    job.pixels.resize(width * height * 4);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    void* mapped = glMapBufferRange(
+      GL_PIXEL_PACK_BUFFER, 0, job.pixels.size(), GL_MAP_READ_BIT);
+    if (mapped) {
+      memcpy(job.pixels.data(), mapped, job.pixels.size());
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+      droppedFrames++;
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(jobsMutex);
+      jobs.push_back(std::move(job));
+    }
+    jobsReady.notify_one();
+  }
+}
+
+void
+FrameCapture::encode()
+{
+  while (true) {
+    EncodeJob job;
+    {
+      std::unique_lock<std::mutex> lock(jobsMutex);
+      jobsReady.wait(lock, [this]() { return stopping || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+
+    write(job);
+
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    if (freeBuffers.size() < MAX_QUEUED_FRAMES) {
+      freeBuffers.push_back(std::move(job.pixels));
+    }
+  }
+}
+
+void
+FrameCapture::write(EncodeJob& job)
+{
+  bool written;
+  if (job.raw) {
+    // bottom to top rows, exactly as read back
+    std::ofstream out(job.filename, std::ios::binary);
+    out.write((char*)job.pixels.data(), job.pixels.size());
+    written = out.good();
+  } else {
+    written = stbi_write_png(job.filename.c_str(),
+                             job.width,
+                             job.height,
+                             4,
+                             job.pixels.data(),
+                             job.width * 4);
+  }
+  if (written) {
+    writtenFrames++;
+  } else {
+    logger->error("failed to write " + job.filename);
+  }
+}
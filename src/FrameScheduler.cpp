@@ -0,0 +1,191 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+FrameScheduler::FrameScheduler(Clock clock,
+                               double targetSeconds,
+                               int lateSwapInterval,
+                               size_t samples)
+  : clock(clock)
+  , targetSeconds(targetSeconds)
+  , lateSwapInterval(lateSwapInterval)
+  , frameTimes(std::max<size_t>(samples, 1), 0)
+{
+  // an edit should show up the next frame, lights can lag a little and
+  // the database can wait half a second
+  slots[MESHING].maxDelay = 1;
+  slots[SHADOWS].maxDelay = 2;
+  slots[PERSISTENCE].maxDelay = 30;
+}
+
+int
+FrameScheduler::addPhase(const std::string& name, double budget)
+{
+  phases.push_back({ name, budget, 0, 0 });
+  return phases.size() - 1;
+}
+
+void
+FrameScheduler::beginFrame()
+{
+  double now = clock();
+  if (frameStart >= 0) {
+    frameTimes[nextFrame] = now - frameStart;
+    nextFrame = (nextFrame + 1) % frameTimes.size();
+    frameCount = std::min(frameCount + 1, frameTimes.size());
+    adaptSwapInterval();
+  }
+  frameStart = now;
+  mark = now;
+}
+
+void
+FrameScheduler::endPhase(int phase)
+{
+  double now = clock();
+  auto& timed = phases[phase];
+  timed.seconds = now - mark;
+  if (timed.seconds > timed.budget * targetSeconds) {
+    timed.overruns++;
+  }
+  mark = now;
+}
+
+void
+FrameScheduler::defer(Deferred kind, Work work)
+{
+  slots[kind].work = work;
+}
+
+void
+FrameScheduler::setMaxDelay(Deferred kind, int frames)
+{
+  slots[kind].maxDelay = frames;
+}
+
+// A job that has waited its maximum runs regardless, so a frame that is
+// always over budget still meshes and saves, just later.
+void
+FrameScheduler::runDeferred()
+{
+  double end = targetSeconds * (1 - SWAP_RESERVE);
+  for (auto& slot : slots) {
+    if (!slot.work) {
+      continue;
+    }
+    double start = clock();
+    double elapsed = frameStart < 0 ? 0 : start - frameStart;
+    if (slot.waited < slot.maxDelay && elapsed + slot.cost > end) {
+      slot.waited++;
+      slot.deferred++;
+      continue;
+    }
+    // moved out first, the job may defer its next run
+    Work work = std::move(slot.work);
+    slot.work = nullptr;
+    slot.waited = 0;
+    work();
+    slot.cost = clock() - start;
+  }
+  mark = clock();
+}
+
+FrameScheduler::Percentiles
+FrameScheduler::percentiles()
+{
+  return { percentile(0.5), percentile(0.95), percentile(0.99) };
+}
+
+double
+FrameScheduler::percentile(double p)
+{
+  if (frameCount == 0) {
+    return 0;
+  }
+  std::vector<double> sorted(frameTimes.begin(),
+                             frameTimes.begin() + frameCount);
+  size_t rank = std::clamp<size_t>(std::ceil(p * frameCount), 1, frameCount);
+  std::nth_element(sorted.begin(), sorted.begin() + rank - 1, sorted.end());
+  return sorted[rank - 1];
+}
+
+// Only decided on a full window of frames since the last change, so one
+// interval's frame times never count toward leaving the other.
+void
+FrameScheduler::adaptSwapInterval()
+{
+  if (!adaptiveVsync) {
+    return;
+  }
+  settled++;
+  if (settled < frameTimes.size()) {
+    return;
+  }
+  int interval = swapInterval;
+  if (swapInterval == 1 && percentile(0.95) > targetSeconds * LATE) {
+    interval = lateSwapInterval;
+  } else if (swapInterval != 1 && percentile(0.99) < targetSeconds * EARLY) {
+    interval = 1;
+  }
+  if (interval != swapInterval) {
+    swapInterval = interval;
+    swapIntervalChanged = true;
+    settled = 0;
+  }
+}
+
+const std::vector<FrameScheduler::Phase>&
+FrameScheduler::getPhases()
+{
+  return phases;
+}
+
+bool
+FrameScheduler::isWaiting(Deferred kind)
+{
+  return (bool)slots[kind].work;
+}
+
+int
+FrameScheduler::getDeferredCount(Deferred kind)
+{
+  return slots[kind].deferred;
+}
+
+double
+FrameScheduler::getTargetSeconds()
+{
+  return targetSeconds;
+}
+
+void
+FrameScheduler::setTargetSeconds(double seconds)
+{
+  targetSeconds = seconds;
+  settled = 0;
+}
+
+void
+FrameScheduler::setAdaptiveVsync(bool adaptive)
+{
+  adaptiveVsync = adaptive;
+  settled = 0;
+  if (!adaptive && swapInterval != 1) {
+    swapInterval = 1;
+    swapIntervalChanged = true;
+  }
+}
+
+int
+FrameScheduler::getSwapInterval()
+{
+  return swapInterval;
+}
+
+bool
+FrameScheduler::takeSwapIntervalChange()
+{
+  bool changed = swapIntervalChanged;
+  swapIntervalChanged = false;
+  return changed;
+}
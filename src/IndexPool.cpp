@@ -1,49 +1,64 @@
 #include "IndexPool.h"
+#include <bit>
 
 IndexPool::IndexPool(int maxIndex)
   : maxIndex(maxIndex)
 {
-  // Initialize the available indices
-  for (int i = 0; i <= maxIndex; ++i) {
-    availableIndices.push_back(i);
-  }
 }
 
 int
 IndexPool::acquireIndex()
 {
-  if (availableIndices.empty()) {
+  // Get the smallest released index, the summary only grows by one word for
+  // every 4096 indices so this scan is effectively constant
+  for (size_t summary = 0; summary < freeWords.size(); summary++) {
+    if (freeWords[summary] == 0) {
+      continue;
+    }
+    size_t word = summary * 64 + std::countr_zero(freeWords[summary]);
+    int bit = std::countr_zero(freeBits[word]);
+    freeBits[word] &= freeBits[word] - 1;
+    if (freeBits[word] == 0) {
+      freeWords[summary] &= ~(uint64_t(1) << (word % 64));
+    }
+    return word * 64 + bit;
+  }
+
+  if (nextIndex > maxIndex) {
     // No available indices
     return -1;
   }
 
-  // Get the smallest available index
-  int index = availableIndices.front();
-  availableIndices.erase(availableIndices.begin());
-  usedIndices.push_back(index);
-  return index;
+  // Every released index is below nextIndex, so this is still the smallest
+  return nextIndex++;
 }
 
 void
 IndexPool::relinquishIndex(int index)
 {
-  // Check if the index is valid
-  if (index < 0 || index > maxIndex) {
+  // Only indices that are currently handed out can be released
+  if (!isUsed(index)) {
     return;
   }
 
-  // Check if the index is currently in use
-  auto it = std::find(usedIndices.begin(), usedIndices.end(), index);
-  if (it == usedIndices.end()) {
-    return;
+  size_t word = index / 64;
+  if (word >= freeBits.size()) {
+    freeBits.resize(word + 1, 0);
+    freeWords.resize(word / 64 + 1, 0);
   }
+  freeBits[word] |= uint64_t(1) << (index % 64);
+  freeWords[word / 64] |= uint64_t(1) << (word % 64);
+}
 
-  // Remove the index from the used indices vector
-  usedIndices.erase(it);
-
-  // Add the index back to the available indices vector
-  availableIndices.push_back(index);
-
-  // Sort the available indices vector
-  std::sort(availableIndices.begin(), availableIndices.end());
+bool
+IndexPool::isUsed(int index)
+{
+  if (index < 0 || index >= nextIndex) {
+    return false;
+  }
+  size_t word = index / 64;
+  if (word >= freeBits.size()) {
+    return true;
+  }
+  return (freeBits[word] & (uint64_t(1) << (index % 64))) == 0;
 }
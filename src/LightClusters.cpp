@@ -0,0 +1,214 @@
+#include "LightClusters.h"
+#include "components/Light.h"
+#include "model.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+LightClusters::LightClusters(std::shared_ptr<EntityRegistry> registry)
+  : registry(registry)
+{
+  bins.resize(CLUSTER_COUNT);
+  grid.resize(CLUSTER_COUNT * 2);
+
+  glGenBuffers(1, &lightDataBuffer);
+  glGenBuffers(1, &clusterGridBuffer);
+  glGenBuffers(1, &lightIndexBuffer);
+  glGenTextures(1, &lightDataTexture);
+  glGenTextures(1, &clusterGridTexture);
+  glGenTextures(1, &lightIndexTexture);
+
+  // texture buffers can't be empty, so give each one a single element
+  upload();
+
+  glActiveTexture(GL_TEXTURE0 + LIGHT_DATA_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, lightDataTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightDataBuffer);
+
+  glActiveTexture(GL_TEXTURE0 + CLUSTER_GRID_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, clusterGridTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, clusterGridBuffer);
+
+  glActiveTexture(GL_TEXTURE0 + LIGHT_INDEX_UNIT);
+  glBindTexture(GL_TEXTURE_BUFFER, lightIndexTexture);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, lightIndexBuffer);
+
+  glActiveTexture(GL_TEXTURE0);
+}
+
+LightClusters::~LightClusters()
+{
+  glDeleteTextures(1, &lightDataTexture);
+  glDeleteTextures(1, &clusterGridTexture);
+  glDeleteTextures(1, &lightIndexTexture);
+  glDeleteBuffers(1, &lightDataBuffer);
+  glDeleteBuffers(1, &clusterGridBuffer);
+  glDeleteBuffers(1, &lightIndexBuffer);
+}
+
+void
+LightClusters::setProjection(float yFov, float aspect, float near, float far)
+{
+  float halfY = tanf(yFov * 0.5f);
+  float halfX = halfY * aspect;
+  if (near == zNear && far == zFar && halfY == tanHalfFovY &&
+      halfX == tanHalfFovX) {
+    return;
+  }
+  zNear = near;
+  zFar = far;
+  tanHalfFovY = halfY;
+  tanHalfFovX = halfX;
+  buildBounds();
+}
+
+// view space AABB of every froxel, only rebuilt when the projection changes
+void
+LightClusters::buildBounds()
+{
+  bounds.resize(CLUSTER_COUNT);
+  for (int z = 0; z < SLICES; z++) {
+    float sliceNear = zNear * powf(zFar / zNear, (float)z / SLICES);
+    float sliceFar = zNear * powf(zFar / zNear, (float)(z + 1) / SLICES);
+    for (int y = 0; y < TILES_Y; y++) {
+      float bottom = (2.0f * y / TILES_Y - 1.0f) * tanHalfFovY;
+      float top = (2.0f * (y + 1) / TILES_Y - 1.0f) * tanHalfFovY;
+      for (int x = 0; x < TILES_X; x++) {
+        float left = (2.0f * x / TILES_X - 1.0f) * tanHalfFovX;
+        float right = (2.0f * (x + 1) / TILES_X - 1.0f) * tanHalfFovX;
+        ClusterBounds b{ glm::vec3(std::numeric_limits<float>::max()),
+                         glm::vec3(-std::numeric_limits<float>::max()) };
+        for (float depth : { sliceNear, sliceFar }) {
+          for (float sx : { left, right }) {
+            for (float sy : { bottom, top }) {
+              glm::vec3 corner(sx * depth, sy * depth, -depth);
+              b.min = glm::min(b.min, corner);
+              b.max = glm::max(b.max, corner);
+            }
+          }
+        }
+        bounds[(z * TILES_Y + y) * TILES_X + x] = b;
+      }
+    }
+  }
+}
+
+void
+LightClusters::binLight(unsigned int lightIndex, glm::vec3 viewPos, float radius)
+{
+  float depth = -viewPos.z;
+  float depthMin = std::max(depth - radius, zNear);
+  float depthMax = std::min(depth + radius, zFar);
+  if (depthMax < zNear || depthMin > zFar) {
+    return;
+  }
+  float logRatio = logf(zFar / zNear);
+  int sliceMin = std::clamp(
+    (int)floorf(logf(depthMin / zNear) / logRatio * SLICES), 0, SLICES - 1);
+  int sliceMax = std::clamp(
+    (int)floorf(logf(depthMax / zNear) / logRatio * SLICES), 0, SLICES - 1);
+
+  // conservative screen space tile range, the exact test is done per cluster
+  int xMin = 0, xMax = TILES_X - 1, yMin = 0, yMax = TILES_Y - 1;
+  if (depth - radius > zNear) {
+    float nearest = depth - radius;
+    float farthest = depth + radius;
+    auto tileRange = [&](float c, float tanHalf, int tiles, int& lo, int& hi) {
+      float minSlope = std::min((c - radius) / nearest, (c - radius) / farthest);
+      float maxSlope = std::max((c + radius) / nearest, (c + radius) / farthest);
+      lo = std::clamp(
+        (int)floorf((minSlope / tanHalf * 0.5f + 0.5f) * tiles), 0, tiles - 1);
+      hi = std::clamp(
+        (int)floorf((maxSlope / tanHalf * 0.5f + 0.5f) * tiles), 0, tiles - 1);
+    };
+    tileRange(viewPos.x, tanHalfFovX, TILES_X, xMin, xMax);
+    tileRange(viewPos.y, tanHalfFovY, TILES_Y, yMin, yMax);
+  }
+
+  float radiusSquared = radius * radius;
+  for (int z = sliceMin; z <= sliceMax; z++) {
+    for (int y = yMin; y <= yMax; y++) {
+      for (int x = xMin; x <= xMax; x++) {
+        int cluster = (z * TILES_Y + y) * TILES_X + x;
+        auto& b = bounds[cluster];
+        glm::vec3 closest = glm::clamp(viewPos, b.min, b.max);
+        glm::vec3 delta = closest - viewPos;
+        if (glm::dot(delta, delta) <= radiusSquared) {
+          bins[cluster].push_back(lightIndex);
+        }
+      }
+    }
+  }
+}
+
+void
+LightClusters::update(const glm::mat4& view)
+{
+  lights.clear();
+  for (auto& bin : bins) {
+    bin.clear();
+  }
+
+  // iteration order matches Renderer::lightUniforms so that light i lines up
+  // with depthCubeMap i
+  auto lightView = registry->view<Light, Positionable>();
+  for (auto [entity, light, positionable] : lightView.each()) {
+    unsigned int lightIndex = lights.size();
+    float shadowIndex =
+      lightIndex < MAX_SHADOWED_LIGHTS ? (float)lightIndex : -1.0f;
+    lights.push_back(
+      PackedLight{ glm::vec4(positionable.pos, light.farPlane),
+                   glm::vec4(light.color, shadowIndex) });
+    glm::vec3 viewPos = glm::vec3(view * glm::vec4(positionable.pos, 1.0));
+    binLight(lightIndex, viewPos, light.farPlane);
+  }
+
+  indices.clear();
+  for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++) {
+    grid[cluster * 2] = indices.size();
+    grid[cluster * 2 + 1] = bins[cluster].size();
+    indices.insert(indices.end(), bins[cluster].begin(), bins[cluster].end());
+  }
+
+  upload();
+}
+
+void
+LightClusters::upload()
+{
+  // orphan and refill, the driver hands back fresh storage if the previous
+  // frame is still reading from the old one
+  glBindBuffer(GL_TEXTURE_BUFFER, lightDataBuffer);
+  glBufferData(GL_TEXTURE_BUFFER,
+               std::max<size_t>(lights.size(), 1) * sizeof(PackedLight),
+               lights.empty() ? NULL : lights.data(),
+               GL_STREAM_DRAW);
+
+  glBindBuffer(GL_TEXTURE_BUFFER, clusterGridBuffer);
+  glBufferData(GL_TEXTURE_BUFFER,
+               grid.size() * sizeof(unsigned int),
+               grid.data(),
+               GL_STREAM_DRAW);
+
+  glBindBuffer(GL_TEXTURE_BUFFER, lightIndexBuffer);
+  glBufferData(GL_TEXTURE_BUFFER,
+               std::max<size_t>(indices.size(), 1) * sizeof(unsigned int),
+               indices.empty() ? NULL : indices.data(),
+               GL_STREAM_DRAW);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void
+LightClusters::bindUniforms(Shader* shader,
+                            float screenWidth,
+                            float screenHeight)
+{
+  shader->setInt("lightData", LIGHT_DATA_UNIT);
+  shader->setInt("clusterGrid", CLUSTER_GRID_UNIT);
+  shader->setInt("lightIndices", LIGHT_INDEX_UNIT);
+  shader->setVec3("clusterDims", glm::vec3(TILES_X, TILES_Y, SLICES));
+  shader->setVec2("clusterScreen", glm::vec2(screenWidth, screenHeight));
+  shader->setFloat("clusterZNear", zNear);
+  shader->setFloat("clusterSliceScale", SLICES / logf(zFar / zNear));
+}
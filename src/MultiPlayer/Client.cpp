@@ -1,10 +1,13 @@
 #include "MultiPlayer/Client.h"
+#include "Config.h"
+#include "MultiPlayer/Server.h"
 #include <iostream>
 #include <glm/glm.hpp>
 #include "camera.h"
 #include <GLFW/glfw3.h>
 #include <type_traits>
 #include "systems/Player.h"
+#include "worldInterface.h"
 #include <GLFW/glfw3.h>
 
 namespace MultiPlayer {
@@ -13,7 +16,13 @@ Client::Client(shared_ptr<EntityRegistry> registry)
   : registry(registry)
   , client(nullptr)
   , peer(nullptr)
+  , remotePlayers(1.0 / SNAPSHOT_RATE)
 {
+  auto config = Config::singleton();
+  remotePlayers.setDelay(
+    config->get<int>("multiplayer.interpolation_delay_ms", 100) / 1000.0);
+  remotePlayers.setMaxExtrapolation(
+    config->get<int>("multiplayer.max_extrapolation_ms", 250) / 1000.0);
   if (enet_initialize() != 0) {
     std::cout << "Failed to initialize enet." << std::endl;
   }
@@ -59,6 +68,11 @@ Client::connect(const std::string& address, int port)
       event.type == ENET_EVENT_TYPE_CONNECT) {
     std::cout << "Connected to server." << std::endl;
     enet_host_flush(client);
+    // ticks start over with every server
+    snapshots = SnapshotHistory();
+    latestTick = 0;
+    remotePlayers.clear();
+    sequence = 0;
     _isConnected = true;
     return true;
   } else {
@@ -80,30 +94,13 @@ Client::poll()
     while (enet_host_service(client, &event, 0) > 0) {
       switch (event.type) {
         case ENET_EVENT_TYPE_RECEIVE:
-          if (event.channelID == 1) { // Player data channel
-                                      // Get the packet data
-            unsigned const char* packetData =
-              static_cast<unsigned const char*>(event.packet->data);
-
-            // Extract position from the packet
-            glm::vec3 position;
-            memcpy(&position, packetData, sizeof(glm::vec3));
-
-            // Extract front from the packet
-            glm::vec3 front;
-            memcpy(&front, packetData + sizeof(glm::vec3), sizeof(glm::vec3));
-
-            // Extract playerID from the packet
-            uint32_t playerID;
-            memcpy(
-              &playerID, packetData + sizeof(glm::vec3) * 2, sizeof(uint32_t));
-
-            if (peer->connectID != playerID) {
-              systems::movePlayer(
-                registry, playerID, position, front, 1.0 / 20.0);
-            }
+          if (event.channelID == SNAPSHOT) {
+            applySnapshot(event.packet);
+          }
+          if (event.channelID == WORLD_EDIT) {
+            applyWorldEdit(event.packet);
           }
-          if (event.channelID == 2) {
+          if (event.channelID == PLAYER_JOINED) {
             auto packetData =
               static_cast<unsigned const char*>(event.packet->data);
             uint32_t playerID;
@@ -118,7 +115,75 @@ Client::poll()
           break;
       }
     }
+    moveRemotePlayers();
+  }
+}
+
+// Snapshots are unsequenced, one that arrives after a newer one is still
+// kept as a base the server may encode against and fills in its tick for
+// interpolation.
+void
+Client::applySnapshot(ENetPacket* packet)
+{
+  Snapshot snapshot;
+  if (!decodeSnapshot(packet->data, packet->dataLength, snapshots, snapshot)) {
+    return;
+  }
+  snapshots.add(snapshot);
+  remotePlayers.add(snapshot, glfwGetTime());
+  if (snapshot.tick > latestTick) {
+    latestTick = snapshot.tick;
+  }
+}
+
+void
+Client::moveRemotePlayers()
+{
+  for (auto& state : remotePlayers.sample(glfwGetTime())) {
+    systems::movePlayer(
+      registry, state.playerID, state.position, state.front, UPDATE_EVERY);
+  }
+}
+
+void
+Client::attachWorld(WorldInterface* world)
+{
+  this->world = world;
+}
+
+// Edits to chunks this client doesn't have loaded are dropped by the world
+// like any other addCube there.
+void
+Client::applyWorldEdit(ENetPacket* packet)
+{
+  if (world == NULL || packet->dataLength == 0) {
+    return;
+  }
+  std::vector<BlockEdit> edits;
+  bool decoded = packet->data[0] == CHUNK_STATE
+                   ? WorldEdits::decodeChunk(
+                       packet->data + 1, packet->dataLength - 1, edits)
+                   : decodeEdits(packet->data, packet->dataLength, edits);
+  if (!decoded || edits.empty()) {
+    return;
+  }
+  for (auto& edit : edits) {
+    world->addCube(edit.x, edit.y, edit.z, edit.blockType);
+  }
+  world->mesh();
+}
+
+void
+Client::sendBlockEdit(BlockEdit edit)
+{
+  if (!_isConnected) {
+    return;
   }
+  auto data = encodeEdits({ edit });
+  ENetPacket* packet =
+    enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+  enet_peer_send(peer, WORLD_EDIT, packet);
+  enet_host_flush(client);
 }
 
 void
@@ -166,16 +231,24 @@ bool
 Client::sendPlayer(glm::vec3 position, glm::vec3 front)
 {
   if (_isConnected && shouldSendPlayerPacket()) {
-    ENetPacket* packet = enet_packet_create(
-      NULL, sizeof(glm::vec3) * 2, ENET_PACKET_FLAG_UNSEQUENCED);
+    ENetPacket* packet =
+      enet_packet_create(NULL,
+                         sizeof(glm::vec3) * 2 + sizeof(uint32_t) * 2,
+                         ENET_PACKET_FLAG_UNSEQUENCED);
 
-    // Copy the player's position and front vector into the packet data
+    // Copy the player's position and front vector into the packet data,
+    // then the newest snapshot so the server encodes against it, then the
+    // update's number so the server can drop it once a newer one arrived
     glm::vec3* data = reinterpret_cast<glm::vec3*>(packet->data);
     data[0] = position;
     data[1] = front;
+    sequence++;
+    uint8_t* tail = packet->data + sizeof(glm::vec3) * 2;
+    memcpy(tail, &latestTick, sizeof(uint32_t));
+    memcpy(tail + sizeof(uint32_t), &sequence, sizeof(uint32_t));
 
     // Send the packet on the dedicated channel for players
-    enet_peer_send(peer, 1, packet);
+    enet_peer_send(peer, PLAYER_UPDATE, packet);
     enet_host_flush(client);
 
     justSentPlayerPacket();
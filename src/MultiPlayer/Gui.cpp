@@ -51,6 +51,19 @@ Gui::Render()
     }
   } else {
     if (server && server->IsRunning()) {
+      auto metrics = server->getMetrics();
+      ImGui::Text("tick %u", metrics.ticks);
+      ImGui::Text("tick work %.3fms avg, %.3fms max",
+                  metrics.averageTickWork,
+                  metrics.maxTickWork);
+      ImGui::Text("overruns %u", metrics.overruns);
+      ImGui::Text("events %zu, max %zu",
+                  metrics.eventsLastTick,
+                  metrics.maxEventsPerTick);
+      ImGui::Text("packets flushed %zu", metrics.packetsLastTick);
+      ImGui::Text("edits %zu, chunks edited %zu",
+                  metrics.editsLastTick,
+                  metrics.editedChunks);
       if (ImGui::Button("Stop Server")) {
         server->Stop();
         server = nullptr;
@@ -0,0 +1,172 @@
+#include "MultiPlayer/Interpolation.h"
+#include <algorithm>
+#include <cmath>
+
+namespace MultiPlayer {
+
+namespace {
+
+// how much of each new snapshot's arrival goes into the clock estimate, so
+// jitter averages out over the last ten or so
+const double CLOCK_SMOOTHING = 0.1;
+// an estimate off by more than this is a new server or a long stall, and is
+// started over rather than slowly corrected
+const double CLOCK_RESYNC = 1.0;
+
+glm::vec3
+blendFront(glm::vec3 from, glm::vec3 to, float t)
+{
+  glm::vec3 front = glm::mix(from, to, t);
+  float length = glm::length(front);
+  return length > 1e-6f ? front / length : to;
+}
+
+}
+
+InterpolationBuffer::InterpolationBuffer(double tickSeconds,
+                                         double delay,
+                                         double maxExtrapolation)
+  : tickSeconds(tickSeconds)
+  , delay(delay)
+  , maxExtrapolation(maxExtrapolation)
+{
+}
+
+// Only the newest snapshot moves the clock and says who is still around. An
+// older one that turns up late fills in the ticks it has for players that
+// are still tracked. A player the server only repeated at this tick adds
+// nothing, its last sample stays where it was taken.
+void
+InterpolationBuffer::add(const Snapshot& snapshot, double receivedAt)
+{
+  if (snapshot.tick == 0) {
+    return;
+  }
+  if (snapshot.tick > newestTick) {
+    double offset = snapshot.tick * tickSeconds - receivedAt;
+    if (!synced || std::abs(offset - clockOffset) > CLOCK_RESYNC) {
+      clockOffset = offset;
+      synced = true;
+    } else {
+      clockOffset += (offset - clockOffset) * CLOCK_SMOOTHING;
+    }
+    newestTick = snapshot.tick;
+    std::erase_if(tracks, [&snapshot](auto& track) {
+      return snapshot.find(track.first) == NULL;
+    });
+  }
+  bool newest = snapshot.tick == newestTick;
+  for (auto& player : snapshot.players) {
+    auto track = tracks.find(player.playerID);
+    if (track == tracks.end()) {
+      if (!newest) {
+        continue;
+      }
+    } else if (!player.sampledAt(snapshot.tick)) {
+      continue;
+    }
+    insert(tracks[player.playerID], snapshot.tick, player);
+  }
+}
+
+void
+InterpolationBuffer::insert(std::deque<Sample>& track,
+                            uint32_t tick,
+                            const QuantizedPlayer& player)
+{
+  auto at = std::lower_bound(
+    track.begin(), track.end(), tick, [](const Sample& sample, uint32_t tick) {
+      return sample.tick < tick;
+    });
+  if (at != track.end() && at->tick == tick) {
+    return;
+  }
+  track.insert(at, { tick, player.interval, player.state() });
+  while (track.size() > TRACK_SIZE) {
+    track.pop_front();
+  }
+}
+
+std::vector<PlayerState>
+InterpolationBuffer::sample(double now)
+{
+  std::vector<PlayerState> players;
+  if (!synced) {
+    return players;
+  }
+  double renderTick = (now + clockOffset - delay) / tickSeconds;
+  for (auto& [playerID, track] : tracks) {
+    players.push_back(sampleTrack(track, renderTick));
+  }
+  return players;
+}
+
+PlayerState
+InterpolationBuffer::sampleTrack(std::deque<Sample>& track, double renderTick)
+{
+  // everything before the sample at or just before renderTick is behind
+  // us, the two newest stay to extrapolate from
+  while (track.size() > 2 && track[1].tick <= renderTick) {
+    track.pop_front();
+  }
+  size_t after = 0;
+  while (after < track.size() && track[after].tick <= renderTick) {
+    after++;
+  }
+  if (after == 0) {
+    return track.front().state;
+  }
+
+  if (after < track.size()) {
+    auto& from = track[after - 1];
+    auto& to = track[after];
+    float t = (renderTick - from.tick) / (to.tick - from.tick);
+    return { to.state.playerID,
+             glm::mix(from.state.position, to.state.position, t),
+             blendFront(from.state.front, to.state.front, t) };
+  }
+
+  auto& last = track.back();
+  if (track.size() == 1) {
+    return last.state;
+  }
+  auto& previous = track[track.size() - 2];
+  glm::vec3 velocity = (last.state.position - previous.state.position) /
+                       (float)(last.tick - previous.tick);
+  // a player the server samples every few ticks is carried on until its
+  // next sample is due
+  double ahead = std::min(
+    renderTick - last.tick,
+    std::max(maxExtrapolation / tickSeconds, (double)last.interval));
+  return { last.state.playerID,
+           last.state.position + velocity * (float)ahead,
+           last.state.front };
+}
+
+double
+InterpolationBuffer::getClockOffset()
+{
+  return clockOffset;
+}
+
+void
+InterpolationBuffer::setDelay(double seconds)
+{
+  delay = seconds;
+}
+
+void
+InterpolationBuffer::setMaxExtrapolation(double seconds)
+{
+  maxExtrapolation = seconds;
+}
+
+void
+InterpolationBuffer::clear()
+{
+  tracks.clear();
+  newestTick = 0;
+  synced = false;
+}
+
+}
@@ -1,14 +1,16 @@
 #include "MultiPlayer/Server.h"
+#include <algorithm>
 #include <iostream>
 #include <glm/glm.hpp>
 #include <vector>
-#include <unistd.h>
+#include <cstring>
 
 namespace MultiPlayer {
 
-Server::Server()
+Server::Server(int tickRate)
   : server(nullptr)
   , isRunning(false)
+  , tickLength(1000000 / tickRate)
 {
   if (enet_initialize() != 0) {
     std::cout << "Failed to initialize enet." << std::endl;
@@ -33,10 +35,8 @@ Server::Start(int port)
     return false;
   }
   isRunning = true;
-  enet_host_flush(server);
 
   pollThread = std::thread([this]() { PollLoop(); });
-  pollThread.detach();
 
   return true;
 }
@@ -48,76 +48,261 @@ Server::getPlayerUpdateFromEvent(ENetEvent& event)
   glm::vec3* data = reinterpret_cast<glm::vec3*>(event.packet->data);
   update.position = data[0];
   update.front = data[1];
-  update.playerID = event.peer->connectID;
+  update.playerID = (uint32_t)(uintptr_t)event.peer->data;
+  update.ackedTick = 0;
+  update.sequence = 0;
+  size_t offset = sizeof(glm::vec3) * 2;
+  if (event.packet->dataLength >= offset + sizeof(uint32_t)) {
+    memcpy(&update.ackedTick, event.packet->data + offset, sizeof(uint32_t));
+  }
+  offset += sizeof(uint32_t);
+  if (event.packet->dataLength >= offset + sizeof(uint32_t)) {
+    memcpy(&update.sequence, event.packet->data + offset, sizeof(uint32_t));
+  }
   return update;
 }
 
+// Every player but the client's own. Players further away are only due
+// every few ticks; until then the client keeps getting what it was last
+// sent for them, which costs nothing once it has acked that. Each carries
+// its interval so the client can tell the repeats from new samples.
+Snapshot
+Server::snapshotFor(uint32_t playerID, ClientView& client)
+{
+  Snapshot snapshot;
+  snapshot.tick = tick;
+  auto self = players.find(playerID);
+  for (auto& [otherID, other] : players) {
+    if (otherID == playerID) {
+      continue;
+    }
+    auto sampled = QuantizedPlayer::from(other);
+    if (self != players.end()) {
+      sampled.interval =
+        updateInterval(glm::length(other.position - self->second.position));
+    }
+    auto previous = client.last.find(otherID);
+    if (previous != NULL && !sampled.sampledAt(tick)) {
+      auto repeated = *previous;
+      repeated.interval = sampled.interval;
+      snapshot.players.push_back(repeated);
+      continue;
+    }
+    snapshot.players.push_back(sampled);
+  }
+  return snapshot;
+}
+
+void
+Server::sendSnapshots()
+{
+  tick++;
+  for (auto& [playerID, client] : clients) {
+    auto snapshot = snapshotFor(playerID, client);
+    auto base = client.sent.find(client.ackedTick);
+    auto data = encodeSnapshot(snapshot, base);
+    ENetPacket* packet = enet_packet_create(
+      data.data(), data.size(), ENET_PACKET_FLAG_UNSEQUENCED);
+    enet_peer_send(client.peer, SNAPSHOT, packet);
+    packetsThisTick++;
+    client.sent.add(snapshot);
+    client.last = std::move(snapshot);
+  }
+}
+
+// Updates are unsequenced, so one that was overtaken by a newer one from
+// the same client is stale and dropped.
 void
-Server::broadcastPlayerUpdate(PlayerUpdate update)
+Server::applyPlayerUpdate(const PlayerUpdate& update)
 {
+  auto client = clients.find(update.playerID);
+  if (client != clients.end()) {
+    auto& view = client->second;
+    if (update.sequence != 0 && update.sequence <= view.newestUpdate) {
+      return;
+    }
+    view.newestUpdate = update.sequence;
+    view.ackedTick = std::max(view.ackedTick, update.ackedTick);
+  }
+  players[update.playerID] = { update.playerID, update.position, update.front };
+}
+
+// Edits are applied as they arrive, which is the order every client will
+// apply them in. Ones the world can't hold are dropped.
+void
+Server::receiveEdits(ENetEvent& event)
+{
+  std::vector<BlockEdit> edits;
+  if (!decodeEdits(event.packet->data, event.packet->dataLength, edits)) {
+    return;
+  }
+  for (auto& edit : edits) {
+    if (worldEdits.apply(edit)) {
+      pendingEdits.push_back(edit);
+    }
+  }
+}
+
+// A tick's edits go to every client in one batch, the sender included, so
+// a client that already made its own edit ends up in the server's order.
+void
+Server::sendEdits()
+{
+  if (pendingEdits.empty()) {
+    return;
+  }
+  auto data = encodeEdits(pendingEdits);
   ENetPacket* packet =
-    enet_packet_create(NULL,
-                       sizeof(glm::vec3) * 2 + sizeof(uint32_t),
-                       ENET_PACKET_FLAG_UNSEQUENCED);
+    enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+  enet_host_broadcast(server, WORLD_EDIT, packet);
+  packetsThisTick++;
+  editsThisTick = pendingEdits.size();
+  pendingEdits.clear();
+}
 
-  memcpy(packet->data, &update.position, sizeof(glm::vec3));
-  memcpy(static_cast<unsigned char*>(packet->data) + sizeof(glm::vec3),
-         &update.front,
-         sizeof(glm::vec3));
-  memcpy(static_cast<unsigned char*>(packet->data) + sizeof(glm::vec3) * 2,
-         &update.playerID,
-         sizeof(uint32_t));
+void
+Server::handleEvent(ENetEvent& event)
+{
+  switch (event.type) {
+    case ENET_EVENT_TYPE_CONNECT: {
+      uint32_t playerId = event.peer->connectID;
+      event.peer->data = (void*)(uintptr_t)playerId;
+      ENetPacket* packet = enet_packet_create(
+        &playerId, sizeof(uint32_t), ENET_PACKET_FLAG_RELIABLE);
+      enet_host_broadcast(server, PLAYER_JOINED, packet);
+      packetsThisTick++;
 
-  enet_host_broadcast(server, 1, packet);
-  enet_host_flush(server);
+      for (auto& [client, view] : clients) {
+        ENetPacket* packet = enet_packet_create(
+          &client, sizeof(uint32_t), ENET_PACKET_FLAG_RELIABLE);
+        enet_peer_send(event.peer, PLAYER_JOINED, packet);
+        packetsThisTick++;
+      }
+      clients[playerId].peer = event.peer;
+
+      // the world as it is now rather than every edit that got it there.
+      // Edits still pending are in it too, and applying them again once
+      // their batch arrives changes nothing.
+      for (auto& data : worldEdits.encodeChunks()) {
+        ENetPacket* packet = enet_packet_create(
+          data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+        enet_peer_send(event.peer, WORLD_EDIT, packet);
+        packetsThisTick++;
+      }
+    } break;
+    case ENET_EVENT_TYPE_RECEIVE:
+      if (event.channelID == PLAYER_UPDATE &&
+          event.packet->dataLength >= sizeof(glm::vec3) * 2) {
+        applyPlayerUpdate(getPlayerUpdateFromEvent(event));
+      }
+      if (event.channelID == WORLD_EDIT) {
+        receiveEdits(event);
+      }
+      enet_packet_destroy(event.packet);
+      break;
+    case ENET_EVENT_TYPE_DISCONNECT: {
+      auto playerId = (uint32_t)(uintptr_t)event.peer->data;
+      clients.erase(playerId);
+      players.erase(playerId);
+      break;
+    }
+    default:
+      break;
+  }
 }
 
+// Fixed rate ticks. Within a tick the loop blocks in enet_host_service until
+// a packet arrives or the tick is up, so an incoming packet is handled as
+// soon as it lands. Whatever is sent in response is only queued, and goes
+// out in the one flush at the end of the tick, so nothing waits longer than
+// a tick.
 void
 Server::PollLoop()
 {
-  std::vector<uint32_t> clients;
+  using namespace std::chrono;
   ENetEvent event;
+  auto tickEnd = steady_clock::now() + tickLength;
   while (isRunning) {
-    if (enet_host_service(server, &event, 0) > 0) {
-      switch (event.type) {
-        case ENET_EVENT_TYPE_CONNECT: {
-          enet_host_flush(server);
-          uint32_t playerId = event.peer->connectID;
-          ENetPacket* packet = enet_packet_create(
-            &playerId, sizeof(uint32_t), ENET_PACKET_FLAG_RELIABLE);
-          enet_host_broadcast(server, 2, packet);
-          enet_host_flush(server);
-
-          for (auto client : clients) {
-            ENetPacket* packet = enet_packet_create(
-              &client, sizeof(uint32_t), ENET_PACKET_FLAG_RELIABLE);
-            enet_peer_send(event.peer, 2, packet);
-          }
-          enet_host_flush(server);
-          clients.push_back(playerId);
-        } break;
-        case ENET_EVENT_TYPE_RECEIVE:
-          if (event.channelID == PLAYER_UPDATE) {
-            auto update = getPlayerUpdateFromEvent(event);
-            broadcastPlayerUpdate(update);
-          }
-          break;
-        case ENET_EVENT_TYPE_DISCONNECT: {
-          break;
-        }
-        default:
-          break;
+    auto work = steady_clock::duration::zero();
+    size_t events = 0;
+    while (isRunning) {
+      auto remaining = ceil<milliseconds>(tickEnd - steady_clock::now());
+      int timeout = std::max((int)remaining.count(), 0);
+      int result = enet_host_service(server, &event, timeout);
+      if (result <= 0) {
+        break;
       }
-    } else {
-      usleep(10000);
+      auto handling = steady_clock::now();
+      handleEvent(event);
+      work += steady_clock::now() - handling;
+      events++;
+    }
+    if (!isRunning) {
+      break;
     }
+
+    auto sending = steady_clock::now();
+    if (tickListener) {
+      tickListener();
+    }
+    sendEdits();
+    sendSnapshots();
+    enet_host_flush(server);
+    work += steady_clock::now() - sending;
+    recordTick(work, events);
+
+    // a stall skips the ticks it missed rather than running them in a burst
+    tickEnd = std::max(tickEnd + tickLength, steady_clock::now());
   }
 }
 
+void
+Server::recordTick(std::chrono::steady_clock::duration work, size_t events)
+{
+  double workMs = std::chrono::duration<double, std::milli>(work).count();
+  double tickMs =
+    std::chrono::duration<double, std::milli>(tickLength).count();
+  std::lock_guard<std::mutex> lock(metricsMutex);
+  metrics.ticks++;
+  metrics.lastTickWork = workMs;
+  // moving average over roughly the last second at 20 ticks a second
+  metrics.averageTickWork = metrics.ticks == 1
+                              ? workMs
+                              : metrics.averageTickWork * 0.95 + workMs * 0.05;
+  metrics.maxTickWork = std::max(metrics.maxTickWork, workMs);
+  if (workMs > tickMs) {
+    metrics.overruns++;
+  }
+  metrics.eventsLastTick = events;
+  metrics.maxEventsPerTick = std::max(metrics.maxEventsPerTick, events);
+  metrics.packetsLastTick = packetsThisTick;
+  packetsThisTick = 0;
+  metrics.editsLastTick = editsThisTick;
+  editsThisTick = 0;
+  metrics.editedChunks = worldEdits.chunkCount();
+}
+
+void
+Server::onTick(std::function<void()> listener)
+{
+  tickListener = listener;
+}
+
+ServerMetrics
+Server::getMetrics()
+{
+  std::lock_guard<std::mutex> lock(metricsMutex);
+  return metrics;
+}
+
 void
 Server::Stop()
 {
   isRunning = false;
+  // the poll thread uses the host until it sees isRunning go false
+  if (pollThread.joinable()) {
+    pollThread.join();
+  }
   if (server != nullptr) {
     enet_host_destroy(server);
     server = nullptr;
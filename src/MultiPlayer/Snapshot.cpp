@@ -0,0 +1,297 @@
+#include "MultiPlayer/Snapshot.h"
+#include "MultiPlayer/Wire.h"
+#include <algorithm>
+#include <cmath>
+
+namespace MultiPlayer {
+
+using namespace wire;
+
+namespace {
+
+const float PI = 3.14159265358979f;
+const float ANGLE_SCALE = 32767.0f;
+
+enum FIELD
+{
+  FIELD_X = 1 << 0,
+  FIELD_Y = 1 << 1,
+  FIELD_Z = 1 << 2,
+  FIELD_YAW = 1 << 3,
+  FIELD_PITCH = 1 << 4,
+  FIELD_INTERVAL = 1 << 5,
+};
+const int FIELDS = 6;
+
+int32_t
+quantizePosition(float value)
+{
+  return (int32_t)std::lround(value * QuantizedPlayer::POSITION_SCALE);
+}
+
+int16_t
+quantizeAngle(float radians, float range)
+{
+  float clamped = std::clamp(radians / range, -1.0f, 1.0f);
+  return (int16_t)std::lround(clamped * ANGLE_SCALE);
+}
+
+// the fields of player that differ from from, as a mask and the zigzag
+// differences
+void
+writeFields(std::vector<uint8_t>& out,
+            const QuantizedPlayer& player,
+            const QuantizedPlayer& from)
+{
+  int64_t deltas[] = { (int64_t)player.x - from.x,
+                       (int64_t)player.y - from.y,
+                       (int64_t)player.z - from.z,
+                       (int64_t)player.yaw - from.yaw,
+                       (int64_t)player.pitch - from.pitch,
+                       (int64_t)player.interval - from.interval };
+  uint8_t mask = 0;
+  for (int field = 0; field < FIELDS; field++) {
+    if (deltas[field] != 0) {
+      mask |= 1 << field;
+    }
+  }
+  writeVarint(out, mask);
+  for (int field = 0; field < FIELDS; field++) {
+    if (mask & (1 << field)) {
+      writeSigned(out, deltas[field]);
+    }
+  }
+}
+
+void
+readFields(Reader& reader, QuantizedPlayer& player)
+{
+  uint64_t mask = reader.varint();
+  if (mask & FIELD_X) {
+    player.x += reader.signedVarint();
+  }
+  if (mask & FIELD_Y) {
+    player.y += reader.signedVarint();
+  }
+  if (mask & FIELD_Z) {
+    player.z += reader.signedVarint();
+  }
+  if (mask & FIELD_YAW) {
+    player.yaw += reader.signedVarint();
+  }
+  if (mask & FIELD_PITCH) {
+    player.pitch += reader.signedVarint();
+  }
+  if (mask & FIELD_INTERVAL) {
+    player.interval += reader.signedVarint();
+  }
+}
+
+// the players in snapshot that aren't the same in base
+void
+writeChanged(std::vector<uint8_t>& out,
+             const Snapshot& snapshot,
+             const Snapshot* base)
+{
+  std::vector<uint8_t> entries;
+  uint32_t changed = 0;
+  uint32_t previousID = 0;
+  for (auto& player : snapshot.players) {
+    const QuantizedPlayer* was = base ? base->find(player.playerID) : NULL;
+    if (was != NULL && *was == player) {
+      continue;
+    }
+    QuantizedPlayer from = was ? *was : QuantizedPlayer{ player.playerID };
+    writeVarint(entries, player.playerID - previousID);
+    writeFields(entries, player, from);
+    previousID = player.playerID;
+    changed++;
+  }
+  writeVarint(out, changed);
+  out.insert(out.end(), entries.begin(), entries.end());
+}
+
+void
+writeRemoved(std::vector<uint8_t>& out,
+             const Snapshot& snapshot,
+             const Snapshot* base)
+{
+  std::vector<uint32_t> removed;
+  if (base != NULL) {
+    for (auto& player : base->players) {
+      if (snapshot.find(player.playerID) == NULL) {
+        removed.push_back(player.playerID);
+      }
+    }
+  }
+  writeVarint(out, removed.size());
+  uint32_t previousID = 0;
+  for (auto playerID : removed) {
+    writeVarint(out, playerID - previousID);
+    previousID = playerID;
+  }
+}
+
+}
+
+QuantizedPlayer
+QuantizedPlayer::from(const PlayerState& state)
+{
+  glm::vec3 front = state.front;
+  float length = glm::length(front);
+  if (length > 0) {
+    front /= length;
+  }
+  float yaw = std::atan2(front.z, front.x);
+  float pitch = std::asin(std::clamp(front.y, -1.0f, 1.0f));
+  return { state.playerID,
+           quantizePosition(state.position.x),
+           quantizePosition(state.position.y),
+           quantizePosition(state.position.z),
+           quantizeAngle(yaw, PI),
+           quantizeAngle(pitch, PI / 2) };
+}
+
+PlayerState
+QuantizedPlayer::state() const
+{
+  float yawRadians = yaw / ANGLE_SCALE * PI;
+  float pitchRadians = pitch / ANGLE_SCALE * PI / 2;
+  glm::vec3 front(std::cos(yawRadians) * std::cos(pitchRadians),
+                  std::sin(pitchRadians),
+                  std::sin(yawRadians) * std::cos(pitchRadians));
+  glm::vec3 position(x, y, z);
+  return { playerID, position / POSITION_SCALE, front };
+}
+
+// the server samples a player every interval ticks, staggered by id so far
+// players don't all come due on the same tick
+bool
+QuantizedPlayer::sampledAt(uint32_t tick) const
+{
+  return interval <= 1 || (tick + playerID) % interval == 0;
+}
+
+const QuantizedPlayer*
+Snapshot::find(uint32_t playerID) const
+{
+  auto it = std::lower_bound(
+    players.begin(),
+    players.end(),
+    playerID,
+    [](const QuantizedPlayer& p, uint32_t id) { return p.playerID < id; });
+  if (it == players.end() || it->playerID != playerID) {
+    return NULL;
+  }
+  return &*it;
+}
+
+void
+SnapshotHistory::add(const Snapshot& snapshot)
+{
+  snapshots[snapshot.tick % SIZE] = snapshot;
+}
+
+const Snapshot*
+SnapshotHistory::find(uint32_t tick) const
+{
+  auto& snapshot = snapshots[tick % SIZE];
+  if (tick == 0 || snapshot.tick != tick) {
+    return NULL;
+  }
+  return &snapshot;
+}
+
+std::vector<uint8_t>
+encodeSnapshot(const Snapshot& snapshot, const Snapshot* base)
+{
+  std::vector<uint8_t> out;
+  writeVarint(out, snapshot.tick);
+  writeVarint(out, base ? base->tick : 0);
+  writeChanged(out, snapshot, base);
+  writeRemoved(out, snapshot, base);
+  return out;
+}
+
+bool
+decodeSnapshot(const uint8_t* data,
+               size_t size,
+               const SnapshotHistory& history,
+               Snapshot& snapshot)
+{
+  Reader reader(data, size);
+  uint32_t tick = reader.varint();
+  uint32_t baseTick = reader.varint();
+  if (reader.failed || tick == 0) {
+    return false;
+  }
+  const Snapshot* base = NULL;
+  if (baseTick != 0) {
+    base = history.find(baseTick);
+    if (base == NULL) {
+      return false;
+    }
+  }
+
+  Snapshot decoded;
+  decoded.tick = tick;
+  if (base != NULL) {
+    decoded.players = base->players;
+  }
+
+  std::vector<QuantizedPlayer> changed;
+  uint64_t changedCount = reader.varint();
+  uint32_t playerID = 0;
+  for (uint64_t i = 0; i < changedCount && !reader.failed; i++) {
+    playerID += reader.varint();
+    auto was = decoded.find(playerID);
+    QuantizedPlayer player = was ? *was : QuantizedPlayer{ playerID };
+    readFields(reader, player);
+    changed.push_back(player);
+  }
+
+  std::vector<uint32_t> removed;
+  uint64_t removedCount = reader.varint();
+  playerID = 0;
+  for (uint64_t i = 0; i < removedCount && !reader.failed; i++) {
+    playerID += reader.varint();
+    removed.push_back(playerID);
+  }
+  if (reader.failed || !reader.done()) {
+    return false;
+  }
+
+  // both lists are sorted by id, like players
+  std::vector<QuantizedPlayer> players;
+  auto next = changed.begin();
+  for (auto& player : decoded.players) {
+    while (next != changed.end() && next->playerID < player.playerID) {
+      players.push_back(*next++);
+    }
+    if (next != changed.end() && next->playerID == player.playerID) {
+      players.push_back(*next++);
+    } else if (!std::binary_search(
+                 removed.begin(), removed.end(), player.playerID)) {
+      players.push_back(player);
+    }
+  }
+  players.insert(players.end(), next, changed.end());
+  decoded.players = std::move(players);
+  snapshot = std::move(decoded);
+  return true;
+}
+
+// every tick up close, then half as often each time the distance doubles
+uint32_t
+updateInterval(float distance)
+{
+  const float NEAR = 16;
+  const uint32_t MAX_INTERVAL = 16;
+  uint32_t interval = 1;
+  while (interval < MAX_INTERVAL && distance >= NEAR * interval) {
+    interval *= 2;
+  }
+  return interval;
+}
+
+}
@@ -0,0 +1,190 @@
+#include "MultiPlayer/WorldEdits.h"
+#include "MultiPlayer/Wire.h"
+#include "miniz.h"
+
+namespace MultiPlayer {
+
+using namespace wire;
+
+namespace {
+
+const uint8_t UNTOUCHED = 0;
+const uint8_t REMOVED = 1;
+// placed cells hold the block type plus this
+const uint8_t PLACED = 2;
+
+// floor division, so -1 is in chunk -1 like translateToWorldPosition has it
+int32_t
+chunkOf(int32_t coordinate)
+{
+  int32_t width = WorldEdits::CHUNK_WIDTH;
+  return coordinate >= 0 ? coordinate / width : (coordinate - width + 1) / width;
+}
+
+// layer by layer, so the untouched runs are long
+size_t
+cellIndex(int32_t x, int32_t y, int32_t z)
+{
+  return ((size_t)y * WorldEdits::CHUNK_WIDTH + z) * WorldEdits::CHUNK_WIDTH +
+         x;
+}
+
+}
+
+std::vector<uint8_t>
+encodeEdits(const std::vector<BlockEdit>& edits)
+{
+  std::vector<uint8_t> out;
+  out.push_back(EDIT_BATCH);
+  writeVarint(out, edits.size());
+  BlockEdit previous = { 0, 0, 0, 0 };
+  for (auto& edit : edits) {
+    writeSigned(out, (int64_t)edit.x - previous.x);
+    writeSigned(out, (int64_t)edit.y - previous.y);
+    writeSigned(out, (int64_t)edit.z - previous.z);
+    writeSigned(out, (int64_t)edit.blockType - previous.blockType);
+    previous = edit;
+  }
+  return out;
+}
+
+bool
+decodeEdits(const uint8_t* data, size_t size, std::vector<BlockEdit>& edits)
+{
+  if (size == 0 || data[0] != EDIT_BATCH) {
+    return false;
+  }
+  Reader reader(data + 1, size - 1);
+  uint64_t count = reader.varint();
+  // every edit takes at least four bytes
+  if (reader.failed || count > reader.remaining() / 4) {
+    return false;
+  }
+  std::vector<BlockEdit> decoded;
+  decoded.reserve(count);
+  BlockEdit edit = { 0, 0, 0, 0 };
+  for (uint64_t i = 0; i < count && !reader.failed; i++) {
+    edit.x += reader.signedVarint();
+    edit.y += reader.signedVarint();
+    edit.z += reader.signedVarint();
+    edit.blockType += reader.signedVarint();
+    decoded.push_back(edit);
+  }
+  if (reader.failed || !reader.done()) {
+    return false;
+  }
+  edits = std::move(decoded);
+  return true;
+}
+
+WorldEdits::WorldEdits(int radius, size_t maxChunks)
+  : radius(radius)
+  , maxChunks(maxChunks)
+{
+}
+
+// in 64 bits, so neither the bounds nor chunkOf overflow near INT32_MIN
+bool
+WorldEdits::inside(int32_t coordinate) const
+{
+  int64_t min = -(int64_t)radius * CHUNK_WIDTH;
+  int64_t max = ((int64_t)radius + 1) * CHUNK_WIDTH;
+  return coordinate >= min && coordinate < max;
+}
+
+bool
+WorldEdits::apply(const BlockEdit& edit)
+{
+  if (edit.y < 0 || edit.y >= CHUNK_HEIGHT || edit.blockType < -1 ||
+      edit.blockType > MAX_BLOCK_TYPE || !inside(edit.x) || !inside(edit.z)) {
+    return false;
+  }
+  int32_t chunkX = chunkOf(edit.x);
+  int32_t chunkZ = chunkOf(edit.z);
+  auto chunk = chunks.find({ chunkX, chunkZ });
+  if (chunk == chunks.end()) {
+    if (chunks.size() >= maxChunks) {
+      return false;
+    }
+    chunk = chunks.emplace(std::make_pair(chunkX, chunkZ),
+                           std::vector<uint8_t>(CHUNK_CELLS, UNTOUCHED))
+              .first;
+  }
+  auto& cells = chunk->second;
+  size_t index = cellIndex(
+    edit.x - chunkX * CHUNK_WIDTH, edit.y, edit.z - chunkZ * CHUNK_WIDTH);
+  cells[index] = edit.blockType < 0 ? REMOVED : edit.blockType + PLACED;
+  return true;
+}
+
+size_t
+WorldEdits::chunkCount() const
+{
+  return chunks.size();
+}
+
+std::vector<std::vector<uint8_t>>
+WorldEdits::encodeChunks() const
+{
+  std::vector<std::vector<uint8_t>> packets;
+  for (auto& [position, cells] : chunks) {
+    std::vector<uint8_t> out;
+    out.push_back(CHUNK_STATE);
+    writeSigned(out, position.first);
+    writeSigned(out, position.second);
+    size_t header = out.size();
+    mz_ulong deflatedSize = mz_compressBound(cells.size());
+    out.resize(header + deflatedSize);
+    if (mz_compress2(out.data() + header,
+                     &deflatedSize,
+                     cells.data(),
+                     cells.size(),
+                     MZ_BEST_SPEED) != MZ_OK) {
+      continue;
+    }
+    out.resize(header + deflatedSize);
+    packets.push_back(std::move(out));
+  }
+  return packets;
+}
+
+bool
+WorldEdits::decodeChunk(const uint8_t* data,
+                        size_t size,
+                        std::vector<BlockEdit>& edits)
+{
+  Reader reader(data, size);
+  int32_t chunkX = reader.signedVarint();
+  int32_t chunkZ = reader.signedVarint();
+  if (reader.failed) {
+    return false;
+  }
+  std::vector<uint8_t> cells(CHUNK_CELLS);
+  mz_ulong cellsSize = cells.size();
+  if (mz_uncompress(
+        cells.data(), &cellsSize, reader.rest(), reader.remaining()) !=
+        MZ_OK ||
+      cellsSize != cells.size()) {
+    return false;
+  }
+  edits.clear();
+  size_t index = 0;
+  for (int32_t y = 0; y < CHUNK_HEIGHT; y++) {
+    for (int32_t z = 0; z < CHUNK_WIDTH; z++) {
+      for (int32_t x = 0; x < CHUNK_WIDTH; x++, index++) {
+        if (cells[index] == UNTOUCHED) {
+          continue;
+        }
+        int32_t blockType =
+          cells[index] == REMOVED ? -1 : cells[index] - PLACED;
+        edits.push_back({ chunkX * CHUNK_WIDTH + x,
+                          y,
+                          chunkZ * CHUNK_WIDTH + z,
+                          blockType });
+      }
+    }
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,73 @@
+#define ENET_IMPLEMENTATION
+#include "Config.h"
+#include "MultiPlayer/Server.h"
+#include "Simulation.h"
+#include "components/Key.h"
+#include "components/Lock.h"
+#include "components/Parent.h"
+#include "components/Positionable.h"
+#include "systems/Door.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// The dedicated server: the relay, the block edits and the world's systems
+// all on the server's poll thread, without a window or GL.
+//
+//   headlessServer [port] [database]
+
+namespace {
+std::atomic<bool> stopping = false;
+
+void
+stop(int)
+{
+  stopping = true;
+}
+
+// the engine's persisters, less the ones for what only a client draws
+std::shared_ptr<EntityRegistry>
+openRegistry(std::string database)
+{
+  auto registry = std::make_shared<EntityRegistry>(database);
+  registry->addPersister(std::make_shared<PositionablePersister>(registry));
+  registry->addPersister(std::make_shared<systems::DoorPersister>(registry));
+  registry->addPersister(std::make_shared<KeyPersister>(registry));
+  registry->addPersister(std::make_shared<LockPersister>(registry));
+  registry->addPersister(std::make_shared<ParentPersister>(registry));
+  registry->createTablesIfNeeded();
+  registry->loadAll();
+  return registry;
+}
+}
+
+int
+main(int argc, char** argv)
+{
+  int port = argc > 1 ? std::stoi(argv[1]) : 1234;
+  std::string database =
+    argc > 2 ? argv[2]
+             : Config::singleton()->get<std::string>("database_file");
+
+  auto registry = openRegistry(database);
+  Simulation simulation(registry, MultiPlayer::SNAPSHOT_RATE);
+  MultiPlayer::Server server;
+  server.onTick([&simulation]() { simulation.step(); });
+  if (!server.Start(port)) {
+    std::cerr << "Failed to listen on port " << port << std::endl;
+    return 1;
+  }
+  std::cout << "Serving on port " << port << std::endl;
+
+  std::signal(SIGINT, stop);
+  std::signal(SIGTERM, stop);
+  while (!stopping) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  server.Stop();
+  registry->flush();
+}
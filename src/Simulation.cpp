@@ -0,0 +1,74 @@
+#include "Simulation.h"
+#include "components/Door.h"
+#include "components/Key.h"
+#include "components/Lock.h"
+#include "components/Parent.h"
+#include "components/Positionable.h"
+#include "components/RotateMovement.h"
+#include "components/TranslateMovement.h"
+#include "systems/ApplyRotation.h"
+#include "systems/ApplyTranslation.h"
+#include "systems/Transforms.h"
+
+Simulation::Simulation(std::shared_ptr<EntityRegistry> registry,
+                       int tickRate,
+                       int workers)
+  : registry(registry)
+  , scheduler(workers)
+  , tickSeconds(1.0 / tickRate)
+{
+  addSystems();
+}
+
+// World::addSystems without the systems that need a renderer
+void
+Simulation::addSystems()
+{
+  using S = SystemScheduler;
+  scheduler.add("applyRotation",
+                S::components<>(),
+                S::components<Positionable, RotateMovement, Key, Lock, Door>(),
+                [this]() { systems::applyRotation(registry, tickSeconds); });
+  scheduler.add(
+    "applyTranslations",
+    S::components<>(),
+    S::components<Positionable, TranslateMovement>(),
+    [this]() { systems::applyTranslations(registry, tickSeconds); });
+  scheduler.add(
+    "updateTransforms",
+    S::components<Parent>(),
+    S::components<Positionable, Attached>(),
+    [this]() { systems::updateTransforms(registry, &scheduler); });
+}
+
+void
+Simulation::step()
+{
+  scheduler.run();
+  registry->stageDirty();
+  tick++;
+}
+
+uint64_t
+Simulation::getTick()
+{
+  return tick;
+}
+
+double
+Simulation::getTickSeconds()
+{
+  return tickSeconds;
+}
+
+std::shared_ptr<EntityRegistry>
+Simulation::getRegistry()
+{
+  return registry;
+}
+
+SystemScheduler&
+Simulation::getScheduler()
+{
+  return scheduler;
+}
@@ -0,0 +1,189 @@
+#include "StatePublisher.h"
+#include <zmq/zmq_addon.hpp>
+
+static const string POSITIONABLE_TOPIC = "positionable/";
+static const string CAMERA_TOPIC = "camera/";
+
+static Vector
+toVector(glm::vec3 v)
+{
+  Vector vector;
+  vector.set_x(v.x);
+  vector.set_y(v.y);
+  vector.set_z(v.z);
+  return vector;
+}
+
+PositionableState
+toPositionableState(entt::entity entity, Positionable& positionable)
+{
+  PositionableState state;
+  state.set_entityid((int64_t)entity);
+  *state.mutable_pos() = toVector(positionable.pos);
+  *state.mutable_rotate() = toVector(positionable.rotate);
+  state.set_scale(positionable.scale);
+  return state;
+}
+
+CameraState
+toCameraState(Camera* camera)
+{
+  CameraState state;
+  *state.mutable_position() = toVector(camera->position);
+  *state.mutable_front() = toVector(camera->front);
+  return state;
+}
+
+StatePublisher::StatePublisher(shared_ptr<EntityRegistry> registry,
+                               Camera* camera,
+                               zmq::context_t& context,
+                               std::string bindAddress,
+                               double publishRate)
+  : registry(registry)
+  , camera(camera)
+  , publishInterval(1.0 / publishRate)
+{
+  logger = make_shared<spdlog::logger>("StatePublisher", fileSink);
+  logger->set_level(spdlog::level::info);
+  socket = zmq::socket_t(context, zmq::socket_type::xpub);
+  socket.bind(bindAddress);
+  registry->on_destroy<Positionable>().connect<&StatePublisher::forget>(this);
+}
+
+StatePublisher::~StatePublisher()
+{
+  registry->on_destroy<Positionable>().disconnect(this);
+}
+
+// destroyed entities would otherwise stay in lastPublished forever
+void
+StatePublisher::forget(entt::registry&, entt::entity entity)
+{
+  lastPublished.erase(entity);
+}
+
+// subscription messages are a 1 (subscribe) or 0 (unsubscribe) byte followed
+// by the topic prefix
+void
+StatePublisher::readSubscriptions()
+{
+  zmq::message_t message;
+  bool changed = false;
+  while (socket.recv(message, zmq::recv_flags::dontwait)) {
+    if (message.size() == 0) {
+      continue;
+    }
+    auto data = (const char*)message.data();
+    string topic(data + 1, message.size() - 1);
+    if (data[0] == 1) {
+      topics.insert(topic);
+    } else {
+      topics.erase(topic);
+    }
+    changed = true;
+  }
+  if (!changed) {
+    return;
+  }
+
+  allPositionables = false;
+  cameraSubscribed = false;
+  subscribedEntities.clear();
+  for (auto& topic : topics) {
+    // a prefix of a topic subscribes to all of it, "" subscribes to everything
+    if (POSITIONABLE_TOPIC.starts_with(topic)) {
+      allPositionables = true;
+    }
+    if (CAMERA_TOPIC.starts_with(topic)) {
+      cameraSubscribed = true;
+    }
+    if (topic.starts_with(POSITIONABLE_TOPIC) &&
+        topic.size() > POSITIONABLE_TOPIC.size()) {
+      try {
+        auto id = stoll(topic.substr(POSITIONABLE_TOPIC.size()));
+        subscribedEntities.insert((entt::entity)id);
+      } catch (...) {
+        logger->error("bad subscription topic " + topic);
+      }
+    }
+  }
+  // new subscribers should get a full state, not just the next change
+  lastPublished.clear();
+  cameraPublished = false;
+}
+
+void
+StatePublisher::publish(double time)
+{
+  if (time < nextPublishTime) {
+    return;
+  }
+  nextPublishTime = time + publishInterval;
+
+  try {
+    readSubscriptions();
+
+    if (allPositionables) {
+      auto view = registry->view<Positionable>();
+      for (auto [entity, positionable] : view.each()) {
+        publishPositionable(entity, positionable);
+      }
+    } else {
+      for (auto entity : subscribedEntities) {
+        if (!registry->valid(entity)) {
+          continue;
+        }
+        auto positionable = registry->try_get<Positionable>(entity);
+        if (positionable) {
+          publishPositionable(entity, *positionable);
+        }
+      }
+    }
+
+    if (cameraSubscribed) {
+      publishCamera();
+    }
+  } catch (zmq::error_t& e) {
+  }
+}
+
+void
+StatePublisher::publishPositionable(entt::entity entity,
+                                    Positionable& positionable)
+{
+  auto last = lastPublished.find(entity);
+  if (last != lastPublished.end() && last->second.pos == positionable.pos &&
+      last->second.rotate == positionable.rotate &&
+      last->second.scale == positionable.scale) {
+    return;
+  }
+  lastPublished[entity] =
+    PublishedState{ positionable.pos, positionable.rotate, positionable.scale };
+  send(POSITIONABLE_TOPIC + to_string((int64_t)entity) + "/",
+       toPositionableState(entity, positionable));
+}
+
+void
+StatePublisher::publishCamera()
+{
+  if (cameraPublished && lastCameraPosition == camera->position &&
+      lastCameraFront == camera->front) {
+    return;
+  }
+  cameraPublished = true;
+  lastCameraPosition = camera->position;
+  lastCameraFront = camera->front;
+  send(CAMERA_TOPIC, toCameraState(camera));
+}
+
+void
+StatePublisher::send(const string& topic,
+                     const google::protobuf::Message& message)
+{
+  string serialized;
+  message.SerializeToString(&serialized);
+  array<zmq::const_buffer, 2> parts = { zmq::buffer(topic),
+                                        zmq::buffer(serialized) };
+  // a slow subscriber drops messages at its high water mark, never blocks us
+  zmq::send_multipart(socket, parts, zmq::send_flags::dontwait);
+}
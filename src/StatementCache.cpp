@@ -0,0 +1,21 @@
+#include "StatementCache.h"
+
+StatementCache::StatementCache(SQLite::Database& db)
+  : db(db)
+{
+}
+
+SQLite::Statement&
+StatementCache::get(const std::string& sql)
+{
+  auto it = statements.find(sql);
+  if (it == statements.end()) {
+    it = statements
+           .emplace(sql, std::make_unique<SQLite::Statement>(db, sql))
+           .first;
+  } else {
+    it->second->reset();
+    it->second->clearBindings();
+  }
+  return *it->second;
+}
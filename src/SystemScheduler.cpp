@@ -0,0 +1,223 @@
+#include "SystemScheduler.h"
+#include "tracy/Tracy.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+// set on the pool's threads, parallelFor from a system already running on
+// one of them runs inline instead of waiting on the pool it's part of
+thread_local bool onWorker = false;
+
+bool
+overlaps(const SystemScheduler::ComponentIds& a,
+         const SystemScheduler::ComponentIds& b)
+{
+  for (auto id : a) {
+    if (std::find(b.begin(), b.end(), id) != b.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+}
+
+SystemScheduler::SystemScheduler(int workerCount)
+{
+  if (workerCount < 0) {
+    workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+  }
+  for (int i = 0; i < workerCount; i++) {
+    workers.push_back(std::thread(&SystemScheduler::work, this));
+  }
+}
+
+SystemScheduler::~SystemScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    stopping = true;
+  }
+  batchReady.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+bool
+SystemScheduler::conflicts(const System& a, const System& b)
+{
+  return overlaps(a.writes, b.writes) || overlaps(a.writes, b.reads) ||
+         overlaps(a.reads, b.writes);
+}
+
+void
+SystemScheduler::add(std::string name,
+                     ComponentIds reads,
+                     ComponentIds writes,
+                     Run run,
+                     bool mainThread)
+{
+  systems.push_back({ name, reads, writes, run, mainThread });
+  size_t index = systems.size() - 1;
+
+  size_t wave = 0;
+  for (size_t w = 0; w < waves.size(); w++) {
+    for (auto other : waves[w]) {
+      if (conflicts(systems[index], systems[other])) {
+        wave = w + 1;
+      }
+    }
+  }
+  if (wave == waves.size()) {
+    waves.push_back({});
+  }
+  waves[wave].push_back(index);
+  timings.push_back({ name, (int)wave, 0 });
+}
+
+void
+SystemScheduler::runSystem(size_t index)
+{
+  ZoneScoped;
+  auto& system = systems[index];
+  ZoneName(system.name.c_str(), system.name.size());
+  auto started = std::chrono::steady_clock::now();
+  system.run();
+  std::chrono::duration<double, std::milli> took =
+    std::chrono::steady_clock::now() - started;
+  timings[index].milliseconds = took.count();
+}
+
+void
+SystemScheduler::run()
+{
+  ZoneScoped;
+  for (auto& wave : waves) {
+    std::vector<size_t> pooled;
+    for (auto index : wave) {
+      if (!systems[index].mainThread) {
+        pooled.push_back(index);
+      }
+    }
+    auto started =
+      start(pooled.size(), [this, &pooled](size_t i) { runSystem(pooled[i]); });
+    for (auto index : wave) {
+      if (systems[index].mainThread) {
+        runSystem(index);
+      }
+    }
+    finish(started);
+  }
+}
+
+void
+SystemScheduler::parallelFor(size_t count, size_t grain, Range fn)
+{
+  if (count == 0) {
+    return;
+  }
+  grain = std::max((size_t)1, grain);
+  size_t chunks = (count + grain - 1) / grain;
+  bool serial = chunks == 1 || onWorker || workers.empty();
+  if (!serial) {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    // a mainThread system asking while its wave is out on the pool
+    serial = dispatching;
+  }
+  if (serial) {
+    fn(0, count);
+    return;
+  }
+  finish(start(chunks, [&fn, count, grain](size_t chunk) {
+    size_t begin = chunk * grain;
+    fn(begin, std::min(count, begin + grain));
+  }));
+}
+
+std::shared_ptr<SystemScheduler::Batch>
+SystemScheduler::start(size_t count, std::function<void(size_t)> job)
+{
+  if (count == 0) {
+    return NULL;
+  }
+  auto started = std::make_shared<Batch>();
+  started->job = std::move(job);
+  started->count = count;
+  {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    batch = started;
+    dispatching = true;
+    generation++;
+  }
+  batchReady.notify_all();
+  return started;
+}
+
+void
+SystemScheduler::finish(std::shared_ptr<Batch> started)
+{
+  if (started == NULL) {
+    return;
+  }
+  help(*started);
+  std::unique_lock<std::mutex> lock(batchMutex);
+  batchDone.wait(lock, [&started]() {
+    return started->finished.load() == started->count;
+  });
+  batch = NULL;
+  dispatching = false;
+}
+
+void
+SystemScheduler::help(Batch& running)
+{
+  while (true) {
+    size_t i = running.next.fetch_add(1);
+    if (i >= running.count) {
+      return;
+    }
+    running.job(i);
+    if (running.finished.fetch_add(1) + 1 == running.count) {
+      // taken so the notify can't slip in between finish() checking and
+      // going to sleep
+      std::lock_guard<std::mutex> lock(batchMutex);
+      batchDone.notify_all();
+    }
+  }
+}
+
+void
+SystemScheduler::work()
+{
+  onWorker = true;
+  tracy::SetThreadName("SystemScheduler");
+  uint64_t seen = 0;
+  while (true) {
+    std::shared_ptr<Batch> running;
+    {
+      std::unique_lock<std::mutex> lock(batchMutex);
+      batchReady.wait(
+        lock, [this, seen]() { return stopping || generation != seen; });
+      if (stopping) {
+        return;
+      }
+      seen = generation;
+      running = batch;
+    }
+    if (running != NULL) {
+      help(*running);
+    }
+  }
+}
+
+const std::vector<SystemScheduler::Timing>&
+SystemScheduler::getTimings()
+{
+  return timings;
+}
+
+size_t
+SystemScheduler::workerCount()
+{
+  return workers.size();
+}
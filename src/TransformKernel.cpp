@@ -0,0 +1,282 @@
+#include "TransformKernel.h"
+#include <cmath>
+#include <immintrin.h>
+
+namespace {
+const float HALF_RADIANS = 3.14159265358979f / 360.0f;
+
+// the matrix glm::quat(glm::radians(rotate)) casts to, indexed [column][row]
+// like glm
+struct Rotation
+{
+  float m[3][3];
+};
+
+Rotation
+rotation(float sx, float cx, float sy, float cy, float sz, float cz)
+{
+  float w = cx * cy * cz + sx * sy * sz;
+  float x = sx * cy * cz - cx * sy * sz;
+  float y = cx * sy * cz + sx * cy * sz;
+  float z = cx * cy * sz - sx * sy * cz;
+
+  Rotation r;
+  r.m[0][0] = 1 - 2 * (y * y + z * z);
+  r.m[0][1] = 2 * (x * y + w * z);
+  r.m[0][2] = 2 * (x * z - w * y);
+  r.m[1][0] = 2 * (x * y - w * z);
+  r.m[1][1] = 1 - 2 * (x * x + z * z);
+  r.m[1][2] = 2 * (y * z + w * x);
+  r.m[2][0] = 2 * (x * z + w * y);
+  r.m[2][1] = 2 * (y * z - w * x);
+  r.m[2][2] = 1 - 2 * (x * x + y * y);
+  return r;
+}
+
+void
+write(const Rotation& r,
+      glm::vec3 pos,
+      glm::vec3 origin,
+      float scale,
+      glm::mat4& modelMatrix,
+      glm::mat3& normalMatrix)
+{
+  float inverseScale = 1.0f / scale;
+  for (int c = 0; c < 3; c++) {
+    for (int row = 0; row < 3; row++) {
+      modelMatrix[c][row] = r.m[c][row] * scale;
+      normalMatrix[c][row] = r.m[c][row] * inverseScale;
+    }
+    modelMatrix[c][3] = 0;
+  }
+  for (int row = 0; row < 3; row++) {
+    modelMatrix[3][row] = pos[row] - (r.m[0][row] * origin.x +
+                                      r.m[1][row] * origin.y +
+                                      r.m[2][row] * origin.z);
+  }
+  modelMatrix[3][3] = 1;
+}
+
+#define AVX2 __attribute__((target("avx2,fma")))
+
+// sin and cos of eight angles at once. The angle is reduced to
+// [-pi/4, pi/4] around the nearest multiple of pi/2, both polynomials are
+// evaluated there and the quadrant picks which is which and their signs.
+// Good to about 1e-7 for the angles a rotation in degrees produces.
+AVX2 void
+sincos8(__m256 x, __m256& sin, __m256& cos)
+{
+  const __m256 TWO_OVER_PI = _mm256_set1_ps(0.636619772367581f);
+  __m256 q =
+    _mm256_round_ps(_mm256_mul_ps(x, TWO_OVER_PI),
+                    _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256i quadrant = _mm256_cvtps_epi32(q);
+
+  // pi/2 split in three so the reduction keeps its precision
+  __m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(1.5703125f), x);
+  r = _mm256_fnmadd_ps(q, _mm256_set1_ps(4.837512969970703125e-4f), r);
+  r = _mm256_fnmadd_ps(q, _mm256_set1_ps(7.54978995489188216e-8f), r);
+  __m256 r2 = _mm256_mul_ps(r, r);
+
+  __m256 s = _mm256_set1_ps(-1.9515295891e-4f);
+  s = _mm256_fmadd_ps(s, r2, _mm256_set1_ps(8.3321608736e-3f));
+  s = _mm256_fmadd_ps(s, r2, _mm256_set1_ps(-1.6666654611e-1f));
+  s = _mm256_fmadd_ps(_mm256_mul_ps(s, r2), r, r);
+
+  __m256 c = _mm256_set1_ps(2.443315711809948e-5f);
+  c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps(-1.388731625493765e-3f));
+  c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps(4.166664568298827e-2f));
+  c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps(-0.5f));
+  c = _mm256_fmadd_ps(c, r2, _mm256_set1_ps(1.0f));
+
+  __m256i one = _mm256_set1_epi32(1);
+  __m256i two = _mm256_set1_epi32(2);
+  __m256 swap = _mm256_castsi256_ps(
+    _mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+  __m256i sinNegative = _mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30);
+  __m256i cosNegative = _mm256_slli_epi32(
+    _mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30);
+
+  sin = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap),
+                      _mm256_castsi256_ps(sinNegative));
+  cos = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap),
+                      _mm256_castsi256_ps(cosNegative));
+}
+}
+
+void
+transformKernel::compose(glm::vec3 pos,
+                         glm::vec3 origin,
+                         glm::vec3 rotate,
+                         float scale,
+                         glm::mat4& modelMatrix,
+                         glm::mat3& normalMatrix)
+{
+  glm::vec3 half = rotate * HALF_RADIANS;
+  auto r = rotation(std::sin(half.x),
+                    std::cos(half.x),
+                    std::sin(half.y),
+                    std::cos(half.y),
+                    std::sin(half.z),
+                    std::cos(half.z));
+  write(r, pos, origin, scale, modelMatrix, normalMatrix);
+}
+
+void
+TransformBatch::resize(size_t size)
+{
+  for (auto field : { &posX,
+                      &posY,
+                      &posZ,
+                      &originX,
+                      &originY,
+                      &originZ,
+                      &rotateX,
+                      &rotateY,
+                      &rotateZ,
+                      &scale }) {
+    field->resize(size);
+  }
+  modelMatrices.resize(size);
+  normalMatrices.resize(size);
+}
+
+size_t
+TransformBatch::size()
+{
+  return scale.size();
+}
+
+void
+TransformBatch::set(size_t index,
+                    glm::vec3 pos,
+                    glm::vec3 origin,
+                    glm::vec3 rotate,
+                    float scale)
+{
+  posX[index] = pos.x;
+  posY[index] = pos.y;
+  posZ[index] = pos.z;
+  originX[index] = origin.x;
+  originY[index] = origin.y;
+  originZ[index] = origin.z;
+  rotateX[index] = rotate.x;
+  rotateY[index] = rotate.y;
+  rotateZ[index] = rotate.z;
+  this->scale[index] = scale;
+}
+
+bool
+TransformBatch::hasAvx2()
+{
+  static bool supported =
+    __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  return supported;
+}
+
+void
+TransformBatch::compute(size_t begin, size_t end)
+{
+  size_t vectorEnd = begin;
+  if (hasAvx2()) {
+    vectorEnd = begin + (end - begin) / WIDTH * WIDTH;
+    computeAvx2(begin, vectorEnd);
+  }
+  computeScalar(vectorEnd, end);
+}
+
+void
+TransformBatch::computeScalar(size_t begin, size_t end)
+{
+  for (size_t i = begin; i < end; i++) {
+    transformKernel::compose(glm::vec3(posX[i], posY[i], posZ[i]),
+                             glm::vec3(originX[i], originY[i], originZ[i]),
+                             glm::vec3(rotateX[i], rotateY[i], rotateZ[i]),
+                             scale[i],
+                             modelMatrices[i],
+                             normalMatrices[i]);
+  }
+}
+
+// the same arithmetic as rotation() and write(), eight lanes wide. Lanes
+// are stored to a column per matrix element and copied out per entity.
+AVX2 void
+TransformBatch::computeAvx2(size_t begin, size_t end)
+{
+  const __m256 halfRadians = _mm256_set1_ps(HALF_RADIANS);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 two = _mm256_set1_ps(2.0f);
+  alignas(32) float model[12][WIDTH];
+  alignas(32) float normal[9][WIDTH];
+
+  for (size_t i = begin; i < end; i += WIDTH) {
+    __m256 sx, cx, sy, cy, sz, cz;
+    sincos8(_mm256_mul_ps(_mm256_loadu_ps(&rotateX[i]), halfRadians), sx, cx);
+    sincos8(_mm256_mul_ps(_mm256_loadu_ps(&rotateY[i]), halfRadians), sy, cy);
+    sincos8(_mm256_mul_ps(_mm256_loadu_ps(&rotateZ[i]), halfRadians), sz, cz);
+
+    __m256 cycz = _mm256_mul_ps(cy, cz);
+    __m256 sysz = _mm256_mul_ps(sy, sz);
+    __m256 sycz = _mm256_mul_ps(sy, cz);
+    __m256 cysz = _mm256_mul_ps(cy, sz);
+    __m256 w = _mm256_fmadd_ps(cx, cycz, _mm256_mul_ps(sx, sysz));
+    __m256 x = _mm256_fmsub_ps(sx, cycz, _mm256_mul_ps(cx, sysz));
+    __m256 y = _mm256_fmadd_ps(cx, sycz, _mm256_mul_ps(sx, cysz));
+    __m256 z = _mm256_fmsub_ps(cx, cysz, _mm256_mul_ps(sx, sycz));
+
+    __m256 xx = _mm256_mul_ps(x, x);
+    __m256 yy = _mm256_mul_ps(y, y);
+    __m256 zz = _mm256_mul_ps(z, z);
+    __m256 xy = _mm256_mul_ps(x, y);
+    __m256 xz = _mm256_mul_ps(x, z);
+    __m256 yz = _mm256_mul_ps(y, z);
+    __m256 wx = _mm256_mul_ps(w, x);
+    __m256 wy = _mm256_mul_ps(w, y);
+    __m256 wz = _mm256_mul_ps(w, z);
+
+    __m256 r[3][3];
+    r[0][0] = _mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one);
+    r[0][1] = _mm256_mul_ps(two, _mm256_add_ps(xy, wz));
+    r[0][2] = _mm256_mul_ps(two, _mm256_sub_ps(xz, wy));
+    r[1][0] = _mm256_mul_ps(two, _mm256_sub_ps(xy, wz));
+    r[1][1] = _mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one);
+    r[1][2] = _mm256_mul_ps(two, _mm256_add_ps(yz, wx));
+    r[2][0] = _mm256_mul_ps(two, _mm256_add_ps(xz, wy));
+    r[2][1] = _mm256_mul_ps(two, _mm256_sub_ps(yz, wx));
+    r[2][2] = _mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one);
+
+    __m256 s = _mm256_loadu_ps(&scale[i]);
+    __m256 inverseS = _mm256_div_ps(one, s);
+    __m256 ox = _mm256_loadu_ps(&originX[i]);
+    __m256 oy = _mm256_loadu_ps(&originY[i]);
+    __m256 oz = _mm256_loadu_ps(&originZ[i]);
+    const float* pos[3] = { &posX[i], &posY[i], &posZ[i] };
+    for (int row = 0; row < 3; row++) {
+      for (int c = 0; c < 3; c++) {
+        _mm256_store_ps(model[c * 3 + row], _mm256_mul_ps(r[c][row], s));
+        _mm256_store_ps(normal[c * 3 + row],
+                        _mm256_mul_ps(r[c][row], inverseS));
+      }
+      __m256 turned = _mm256_fmadd_ps(
+        r[0][row], ox, _mm256_fmadd_ps(r[1][row], oy, _mm256_mul_ps(r[2][row], oz)));
+      _mm256_store_ps(model[9 + row],
+                      _mm256_sub_ps(_mm256_loadu_ps(pos[row]), turned));
+    }
+
+    for (size_t lane = 0; lane < WIDTH; lane++) {
+      glm::mat4& modelMatrix = modelMatrices[i + lane];
+      glm::mat3& normalMatrix = normalMatrices[i + lane];
+      for (int c = 0; c < 4; c++) {
+        for (int row = 0; row < 3; row++) {
+          modelMatrix[c][row] = model[c * 3 + row][lane];
+        }
+        modelMatrix[c][3] = c == 3 ? 1 : 0;
+      }
+      for (int c = 0; c < 3; c++) {
+        for (int row = 0; row < 3; row++) {
+          normalMatrix[c][row] = normal[c * 3 + row][lane];
+        }
+      }
+    }
+  }
+}
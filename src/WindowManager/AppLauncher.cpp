@@ -0,0 +1,123 @@
+#include "WindowManager/AppLauncher.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace WindowManager {
+
+namespace {
+
+// deeper than any launcher, terminal or shell wrapper chain
+const int MAX_LINEAGE = 32;
+
+// WM_CLASS isn't capitalised consistently between versions of an app, but
+// "Microsoft-edge" must not take a "Microsoft-edge-beta" window
+bool
+sameClass(const std::string& a, const std::string& b)
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+    return std::tolower((unsigned char)x) == std::tolower((unsigned char)y);
+  });
+}
+
+bool
+matches(const AppLauncher::Launch& launch,
+        const std::vector<int>& lineage,
+        const std::string& className)
+{
+  if (launch.className.has_value() && !className.empty() &&
+      sameClass(className, launch.className.value())) {
+    return true;
+  }
+  return std::any_of(lineage.begin(), lineage.end(), [&launch](int pid) {
+    return pid == launch.forkedPid || pid == launch.pid;
+  });
+}
+
+}
+
+AppLauncher::Handle
+AppLauncher::expect(entt::entity entity,
+                    int forkedPid,
+                    std::optional<std::string> className)
+{
+  auto launch = std::make_shared<Launch>();
+  launch->entity = entity;
+  launch->forkedPid = forkedPid;
+  launch->className = className;
+  launch->window = launch->promise.get_future().share();
+  std::lock_guard<std::mutex> lock(mutex);
+  pending.push_back(launch);
+  return launch;
+}
+
+void
+AppLauncher::identify(Handle launch, int pid)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  launch->pid = pid;
+}
+
+void
+AppLauncher::cancel(Handle launch)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  std::erase(pending, launch);
+}
+
+// Launches are matched in the order they were made, so of two launches of
+// the same app the first gets the first window.
+std::optional<entt::entity>
+AppLauncher::claim(Window window,
+                   std::optional<int> pid,
+                   const std::string& className)
+{
+  std::vector<int> ancestors;
+  if (pid.has_value()) {
+    ancestors = lineage(pid.value());
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto it = pending.begin(); it != pending.end(); it++) {
+    if (matches(**it, ancestors, className)) {
+      auto launch = *it;
+      pending.erase(it);
+      launch->promise.set_value(window);
+      return launch->entity;
+    }
+  }
+  return std::nullopt;
+}
+
+size_t
+AppLauncher::pendingCount()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return pending.size();
+}
+
+// the parent is the fourth field of /proc/<pid>/stat, after a command name
+// in parentheses that can itself hold spaces
+std::vector<int>
+AppLauncher::lineage(int pid)
+{
+  std::vector<int> pids;
+  while (pid > 1 && (int)pids.size() < MAX_LINEAGE) {
+    pids.push_back(pid);
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string contents((std::istreambuf_iterator<char>(stat)),
+                         std::istreambuf_iterator<char>());
+    auto nameEnd = contents.rfind(')');
+    if (nameEnd == std::string::npos) {
+      break;
+    }
+    std::istringstream fields(contents.substr(nameEnd + 1));
+    char state;
+    int parent = 0;
+    fields >> state >> parent;
+    pid = parent;
+  }
+  return pids;
+}
+
+}
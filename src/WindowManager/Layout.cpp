@@ -0,0 +1,253 @@
+#include "WindowManager/Layout.h"
+#include <algorithm>
+#include <cmath>
+
+namespace WindowManager {
+
+Layout::Layout()
+  : Layout(Wall())
+{
+}
+
+Layout::Layout(Wall wall)
+  : wall(wall)
+{
+  this->wall.columns = std::max(wall.columns, 1);
+}
+
+int
+Layout::span(float aspect)
+{
+  return std::max(1, (int)std::ceil(aspect / wall.cell.y - 1e-3f));
+}
+
+bool
+Layout::isFree(int cell)
+{
+  return cell >= nextCell || freeCells.contains(cell);
+}
+
+void
+Layout::take(int cell)
+{
+  if (cell >= nextCell) {
+    for (int skipped = nextCell; skipped < cell; skipped++) {
+      freeCells.insert(freeCells.end(), skipped);
+    }
+    nextCell = cell + 1;
+  } else {
+    freeCells.erase(cell);
+  }
+}
+
+void
+Layout::release(int cell)
+{
+  freeCells.insert(cell);
+  while (nextCell > 0 && freeCells.contains(nextCell - 1)) {
+    freeCells.erase(nextCell - 1);
+    nextCell--;
+  }
+}
+
+void
+Layout::takeColumn(int cell, int span)
+{
+  for (int row = 0; row < span; row++) {
+    take(cell + row * wall.columns);
+  }
+}
+
+void
+Layout::releaseColumn(int cell, int span)
+{
+  for (int row = 0; row < span; row++) {
+    release(cell + row * wall.columns);
+  }
+}
+
+// One cell tall apps take the lowest free cell. Taller ones look for a free
+// cell with enough free above it, past the end of the wall if need be.
+int
+Layout::allocate(int span)
+{
+  auto fits = [this, span](int cell) {
+    for (int row = 1; row < span; row++) {
+      if (!isFree(cell + row * wall.columns)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  int cell = nextCell;
+  for (int candidate : freeCells) {
+    if (fits(candidate)) {
+      cell = candidate;
+      break;
+    }
+  }
+  takeColumn(cell, span);
+  return cell;
+}
+
+glm::vec3
+Layout::positionOf(const Slot& slot)
+{
+  int column = slot.cell % wall.columns;
+  int row = slot.cell / wall.columns;
+  glm::vec3 pos = wall.origin + glm::vec3(column * wall.cell.x,
+                                          (row + (slot.span - 1) / 2.0f) *
+                                            wall.cell.y,
+                                          0);
+  return pos + wall.stackStep * (float)slot.depth;
+}
+
+glm::vec3
+Layout::place(entt::entity entity, float aspect, Mode mode)
+{
+  remove(entity);
+  Slot slot;
+  slot.mode = mode;
+  if (mode == Mode::STACK) {
+    if (!stackCell.has_value()) {
+      stackCell = allocate(1);
+    }
+    slot.cell = stackCell.value();
+    slot.span = 1;
+    slot.depth = stack.empty() ? 0 : stack.rbegin()->first + 1;
+    stack[slot.depth] = entity;
+  } else {
+    slot.span = span(aspect);
+    slot.cell = allocate(slot.span);
+  }
+  slots[entity] = slot;
+  return positionOf(slot);
+}
+
+void
+Layout::occupy(entt::entity entity, glm::vec3 pos, float aspect)
+{
+  remove(entity);
+  glm::vec3 offset = pos - wall.origin;
+  if (std::abs(offset.z) > wall.cell.y / 2) {
+    return;
+  }
+  int column = std::round(offset.x / wall.cell.x);
+  int cells = span(aspect);
+  int bottom = std::round(offset.y / wall.cell.y - (cells - 1) / 2.0f);
+  if (column < 0 || column >= wall.columns || bottom < 0) {
+    return;
+  }
+  int cell = bottom * wall.columns + column;
+  for (int row = 0; row < cells; row++) {
+    if (!isFree(cell + row * wall.columns)) {
+      cells = row;
+      break;
+    }
+  }
+  if (cells > 0) {
+    takeColumn(cell, cells);
+    occupied[entity] = { cell, cells };
+  }
+}
+
+void
+Layout::remove(entt::entity entity)
+{
+  auto taken = occupied.find(entity);
+  if (taken != occupied.end()) {
+    releaseColumn(taken->second.first, taken->second.second);
+    occupied.erase(taken);
+  }
+  auto slot = slots.find(entity);
+  if (slot == slots.end()) {
+    return;
+  }
+  if (slot->second.mode == Mode::STACK) {
+    stack.erase(slot->second.depth);
+    if (stack.empty()) {
+      release(stackCell.value());
+      stackCell = std::nullopt;
+    }
+  } else {
+    releaseColumn(slot->second.cell, slot->second.span);
+  }
+  slots.erase(slot);
+}
+
+bool
+Layout::contains(entt::entity entity)
+{
+  return slots.contains(entity);
+}
+
+std::optional<glm::vec3>
+Layout::positionOf(entt::entity entity)
+{
+  auto slot = slots.find(entity);
+  if (slot == slots.end()) {
+    return std::nullopt;
+  }
+  return positionOf(slot->second);
+}
+
+size_t
+Layout::size()
+{
+  return slots.size();
+}
+
+// Apps placed some other way keep their cells, everything else is laid out
+// again from scratch in order of the cell it had.
+std::vector<Layout::Move>
+Layout::relayout()
+{
+  std::vector<std::pair<int, entt::entity>> tiled;
+  for (auto& [entity, slot] : slots) {
+    if (slot.mode == Mode::TILE) {
+      tiled.push_back({ slot.cell, entity });
+    }
+  }
+  std::sort(tiled.begin(), tiled.end());
+  auto before = slots;
+
+  freeCells.clear();
+  nextCell = 0;
+  for (auto& [entity, taken] : occupied) {
+    takeColumn(taken.first, taken.second);
+  }
+  // the stack goes where its cell comes in the order
+  bool stackPlaced = !stackCell.has_value();
+  auto placeStack = [&]() {
+    stackCell = allocate(1);
+    int depth = 0;
+    std::map<int, entt::entity> packed;
+    for (auto& [oldDepth, entity] : stack) {
+      slots[entity].cell = stackCell.value();
+      slots[entity].depth = depth;
+      packed[depth++] = entity;
+    }
+    stack = packed;
+    stackPlaced = true;
+  };
+  for (auto& [cell, entity] : tiled) {
+    if (!stackPlaced && stackCell.value() < cell) {
+      placeStack();
+    }
+    slots[entity].cell = allocate(slots[entity].span);
+  }
+  if (!stackPlaced) {
+    placeStack();
+  }
+
+  std::vector<Move> moves;
+  for (auto& [entity, slot] : slots) {
+    auto& old = before[entity];
+    if (old.cell != slot.cell || old.depth != slot.depth) {
+      moves.push_back({ entity, positionOf(slot) });
+    }
+  }
+  return moves;
+}
+
+}
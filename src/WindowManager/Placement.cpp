@@ -0,0 +1,107 @@
+#include "WindowManager/Placement.h"
+#include <algorithm>
+#include <cmath>
+
+namespace WindowManager {
+
+namespace placement {
+
+namespace {
+
+// nearer than this the quad is behind the near plane, further it's too
+// small to read. The range the old search covered.
+const float MIN_DISTANCE = 0;
+const float MAX_DISTANCE = 10.5;
+
+float
+projectX(const glm::mat4& projection, float x, float distance)
+{
+  glm::vec4 clip = projection * glm::vec4(x, 0, -distance, 1);
+  return clip.x / clip.w;
+}
+
+}
+
+float
+viewDistance(const glm::mat4& projection,
+             float width,
+             float screenWidth,
+             float scale)
+{
+  // where x = 0.5 should land in normalized device coordinates, which
+  // span the screen's width twice
+  float target = width / screenWidth / scale;
+  auto& p = projection;
+  float denominator = target * p[2][3] - p[2][0];
+  if (std::abs(denominator) < 1e-9f) {
+    return MAX_DISTANCE;
+  }
+  float distance = (target * (0.5f * p[0][3] + p[3][3]) - 0.5f * p[0][0] -
+                    p[3][0]) /
+                   denominator;
+  return std::clamp(distance, MIN_DISTANCE, MAX_DISTANCE);
+}
+
+float
+pixelsPerUnit(const glm::mat4& projection, float distance, float screenWidth)
+{
+  return (projectX(projection, 1, distance) -
+          projectX(projection, 0, distance)) *
+         screenWidth / 2;
+}
+
+std::vector<Placed>
+tile(const glm::mat4& projection,
+     float screenWidth,
+     glm::vec3 eye,
+     glm::quat facing,
+     float distance,
+     const std::vector<glm::vec2>& sizes,
+     const Grid& grid)
+{
+  std::vector<Placed> placed(sizes.size());
+  if (sizes.empty()) {
+    return placed;
+  }
+  float unitPixels = pixelsPerUnit(projection, distance, screenWidth);
+  glm::vec3 rotate = glm::degrees(glm::eulerAngles(facing));
+  size_t columns = std::max(grid.columns, 1);
+
+  // laid out in pixels first, y down from the top of the first row
+  std::vector<glm::vec2> centres(sizes.size());
+  std::vector<float> rowWidths;
+  float top = 0;
+  for (size_t rowStart = 0; rowStart < sizes.size(); rowStart += columns) {
+    size_t rowEnd = std::min(rowStart + columns, sizes.size());
+    float rowHeight = 0;
+    float rowWidth = -grid.gap;
+    for (size_t i = rowStart; i < rowEnd; i++) {
+      rowHeight = std::max(rowHeight, sizes[i].y);
+      rowWidth += sizes[i].x + grid.gap;
+    }
+    float left = -rowWidth / 2;
+    for (size_t i = rowStart; i < rowEnd; i++) {
+      float slack = rowHeight - sizes[i].y;
+      float offset = grid.align == Align::TOP      ? 0
+                     : grid.align == Align::CENTER ? slack / 2
+                                                   : slack;
+      centres[i] =
+        glm::vec2(left + sizes[i].x / 2, top + offset + sizes[i].y / 2);
+      left += sizes[i].x + grid.gap;
+    }
+    top += rowHeight + grid.gap;
+  }
+  float gridHeight = top - grid.gap;
+
+  for (size_t i = 0; i < sizes.size(); i++) {
+    glm::vec2 centre = centres[i] / unitPixels;
+    glm::vec3 offset(
+      centre.x, gridHeight / 2 / unitPixels - centre.y, -distance);
+    placed[i] = { eye + facing * offset, rotate, sizes[i].x / unitPixels };
+  }
+  return placed;
+}
+
+}
+
+}
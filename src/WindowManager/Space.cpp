@@ -2,6 +2,7 @@
 #include "app.h"
 #include "components/Bootable.h"
 #include "camera.h"
+#include "Config.h"
 #include "entity.h"
 #include "glm/ext/quaternion_trigonometric.hpp"
 #include "glm/gtc/quaternion.hpp"
@@ -14,58 +15,70 @@
 
 namespace WindowManager {
 
-void Space::initAppPositions() {
-  float z = -2;
-  float xOffset = -1.2;
-  float yOffset = -2.4;
-  availableAppPositions.push(glm::vec3(0.0 + xOffset, 3.5 + yOffset, z));
-  availableAppPositions.push(glm::vec3(1.2 + xOffset, 3.5 + yOffset, z));
-  availableAppPositions.push(glm::vec3(1.2 + xOffset, 4.25 + yOffset, z));
-  availableAppPositions.push(glm::vec3(1.2 + xOffset, 5.00 + yOffset, z));
-  availableAppPositions.push(glm::vec3(2.4 + xOffset, 3.5 + yOffset, z));
-  availableAppPositions.push(glm::vec3(0 + xOffset, 4.25 + yOffset, z));
-  availableAppPositions.push(glm::vec3(2.4 + xOffset, 4.25 + yOffset, z));
-  availableAppPositions.push(glm::vec3(2.4 + xOffset, 7 + yOffset, z));
+// the wall the first apps used to be placed on by hand
+Layout::Wall Space::wallFromConfig() {
+  Layout::Wall wall;
+  wall.columns = Config::singleton()->get<int>("layout.columns", wall.columns);
+  return wall;
+}
+
+Layout::Mode Space::layoutModeFromConfig() {
+  auto mode = Config::singleton()->get<std::string>("layout.mode", "tile");
+  if (mode == "stack") {
+    return Layout::Mode::STACK;
+  }
+  if (mode != "tile") {
+    logger->warn("unknown layout.mode {}, tiling", mode);
+  }
+  return Layout::Mode::TILE;
 }
 
   Space::Space(shared_ptr<EntityRegistry> registry, Renderer *renderer,
                Camera *camera, spdlog::sink_ptr loggerSink)
-    : renderer(renderer), camera(camera), registry(registry) {
-  initAppPositions();
+    : renderer(renderer), camera(camera), registry(registry),
+      layout(wallFromConfig()) {
+  reflowOnClose = Config::singleton()->get<bool>("layout.reflow_on_close",
+                                                 reflowOnClose);
   logger = make_shared<spdlog::logger>("WindowManager::Space", loggerSink);
   logger->set_level(spdlog::level::debug);
+  layoutMode = layoutModeFromConfig();
 }
 
   void Space::removeApp(entt::entity entity) {
   if(registry->all_of<Positionable>(entity)) {
     numPositionableApps--;
   }
+  bool laidOut = layout.contains(entity);
+  layout.remove(entity);
 
   auto &app = registry->get<X11App>(entity);
+  app.release();
   renderer->deregisterApp(app.getAppIndex());
   registry->remove<X11App>(entity);
   //registry->destroy(entity);
+  if (laidOut && reflowOnClose) {
+    relayout();
+  }
 }
 
 float Space::getViewDistanceForWindowSize(entt::entity entity) {
   auto &app = registry->get<X11App>(entity);
   auto positionable = registry->try_get<Positionable>(entity);
-  // view = projection^-1 * gl_vertex * vertex^-1
   float scaleFactor = positionable != NULL ? positionable->scale : 1;
-  float glVertexX = float(app.width) / SCREEN_WIDTH / scaleFactor;
-  glm::vec4 gl_pos = glm::vec4(10000, 0, 0, 0);
-  float zBest;
-  float target = glVertexX;
-  for (float z = 0.0; z <= 10.5; z = z + 0.001) {
-    glm::vec4 candidate;
-    candidate = camera->getProjectionMatrix() * glm::vec4(0.5, 0, -z, 1);
-    candidate = candidate / candidate.w;
-    if (abs(candidate.x - target) < abs(gl_pos.x - target)) {
-      gl_pos = candidate;
-      zBest = z;
-    }
+  auto &projection = camera->getProjectionMatrix();
+  if (projection != viewDistanceProjection) {
+    viewDistances.clear();
+    viewDistanceProjection = projection;
   }
-  return zBest;
+  glm::vec2 key(app.width, scaleFactor);
+  auto cached = viewDistances.find(key);
+  if (cached != viewDistances.end()) {
+    return cached->second;
+  }
+  float distance = placement::viewDistance(projection, app.width, SCREEN_WIDTH,
+                                           scaleFactor);
+  viewDistances[key] = distance;
+  return distance;
 }
 
 glm::vec3 Space::getAppPosition(entt::entity entity) {
@@ -125,6 +138,45 @@ optional<entt::entity> Space::getLookedAtApp() {
   return std::nullopt;
 }
 
+void Space::placePixelPerfect(const vector<entt::entity> &entities,
+                              const placement::Grid &grid) {
+  vector<entt::entity> apps;
+  vector<glm::vec2> sizes;
+  for (auto entity : entities) {
+    auto app = registry->try_get<X11App>(entity);
+    if (app != NULL && !app->isAccessory()) {
+      apps.push_back(entity);
+      sizes.push_back(glm::vec2(app->width, app->height));
+    }
+  }
+  float yaw = camera->getYaw();
+  float pitch = camera->getPitch();
+  glm::quat facing =
+    glm::angleAxis(glm::radians(90 + yaw), glm::vec3(0.0f, -1.0f, 0.0f)) *
+    glm::angleAxis(glm::radians(pitch), glm::vec3(1.0f, 0.0f, 0.0f));
+  auto &projection = camera->getProjectionMatrix();
+  // where a window as wide as the screen fills it
+  float distance =
+    placement::viewDistance(projection, SCREEN_WIDTH, SCREEN_WIDTH);
+  auto placed = placement::tile(projection, SCREEN_WIDTH, camera->position,
+                                facing, distance, sizes, grid);
+  for (size_t i = 0; i < apps.size(); i++) {
+    layout.remove(apps[i]);
+    auto positionable = registry->try_get<Positionable>(apps[i]);
+    if (positionable == NULL) {
+      numPositionableApps++;
+      positionable = &registry->emplace<Positionable>(
+        apps[i], placed[i].pos, glm::vec3(0.0), placed[i].rotate,
+        placed[i].scale);
+    } else {
+      positionable->pos = placed[i].pos;
+      positionable->rotate = placed[i].rotate;
+      positionable->scale = placed[i].scale;
+    }
+    positionable->damage();
+  }
+}
+
 size_t Space::getNumPositionableApps() {
   return numPositionableApps;
 }
@@ -154,15 +206,24 @@ void Space::addApp(entt::entity entity, bool spawnAtCamera) {
           finalRotation * glm::vec3(0,0,-dist);
 
       } else {
-        pos = availableAppPositions.front();
-        if (availableAppPositions.size() > 1) {
-          availableAppPositions.pop();
-        }
+        float aspect = app.width > 0 ? float(app.height) / app.width : 1;
+        pos = layout.place(entity, aspect, layoutMode);
       }
 
       int index = numPositionableApps++;
       registry->emplace<Positionable>(entity, pos, glm::vec3(0.0), rot, 1);
     }
+    // apps loaded with a position of their own, bootables from the
+    // database, keep tiled apps out from under them
+    if (!app.isAccessory() && hasPositionable) {
+      int width = bootable ? bootable->getWidth() : app.width;
+      int height = bootable ? bootable->getHeight() : app.height;
+      if (width > 0) {
+        auto &positionable = registry->get<Positionable>(entity);
+        layout.occupy(entity, positionable.pos,
+                      positionable.scale * height / width);
+      }
+    }
     if (!app.isAccessory() && bootable) {
       systems::resizeBootable(registry, entity, bootable->getWidth(),
           bootable->getHeight());
@@ -196,4 +257,18 @@ void Space::toggleAppSelect(entt::entity appEntt) {
     logger->error("attempted to select a non existent app");
   }
 }
+
+void Space::setLayoutMode(Layout::Mode mode) {
+  layoutMode = mode;
+}
+
+void Space::relayout() {
+  for (auto &move : layout.relayout()) {
+    auto positionable = registry->try_get<Positionable>(move.entity);
+    if (positionable != NULL) {
+      positionable->pos = move.pos;
+      positionable->damage();
+    }
+  }
+}
 } // namespace WindowManager
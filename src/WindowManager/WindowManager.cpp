@@ -12,6 +12,7 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <glm/glm.hpp>
 #include <iostream>
@@ -21,6 +22,7 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <poll.h>
 #include <spdlog/common.h>
 #include <sstream>
 #include <thread>
@@ -53,21 +55,32 @@ int forkApp(string cmd, char **envp, string args) {
   }
 }
 
+// Launched apps are added by createApp when their window maps, these are
+// only upper bounds on waiting for that
+const std::chrono::seconds SLOW_APP_TIMEOUT(30);
+const std::chrono::seconds APP_TIMEOUT(10);
+
 void WindowManager::forkOrFindApp(string cmd, string pidOf, string className,
                                   entt::entity &appEntity, char **envp,
                                   string args) {
-  char *line;
+  char *line = NULL;
   std::size_t len = 0;
   FILE *pidPipe = popen(string("pgrep " + pidOf).c_str(), "r");
-  if (getline(&line, &len, pidPipe) == -1) {
-    forkApp(cmd, envp, args);
-    if (className == "obs") {
-      sleep(30);
-    } else if (className == "magicavoxel.exe") {
-      sleep(6);
-    } else {
-      sleep(4);
+  bool running = getline(&line, &len, pidPipe) != -1;
+  free(line);
+  pclose(pidPipe);
+  if (!running) {
+    appEntity = registry->create();
+    auto launch =
+      launcher.expect(appEntity, forkApp(cmd, envp, args), className);
+    auto timeout = className == "obs" ? SLOW_APP_TIMEOUT : APP_TIMEOUT;
+    if (launch->window.wait_for(timeout) != std::future_status::ready) {
+      launcher.cancel(launch);
+      logger->error("no window for " + className);
+      return;
     }
+    logger->info("launched " + className + " app");
+    return;
   }
   X11App *app =
     X11App::byClass(className, display, screen,
@@ -76,6 +89,7 @@ void WindowManager::forkOrFindApp(string cmd, string pidOf, string className,
   appEntity = registry->create();
   registry->emplace<X11App>(appEntity, std::move(*app));
   dynamicApps[app->getWindow()] = appEntity;
+  knowWindow(app->getWindow());
   logger->info("created " + className + " app");
 }
 
@@ -85,17 +99,44 @@ void WindowManager::createAndRegisterApps(char **envp) {
   if (EDGE) {
     forkOrFindApp("/usr/bin/microsoft-edge", "msedge", "Microsoft-edge",
                   microsoftEdge, envp);
+    std::lock_guard<std::mutex> lock(renderLoopMutex);
     appsWithHotKeys.push_back(microsoftEdge);
   }
   auto alreadyBooted = systems::getAlreadyBooted(registry);
   for(auto entityAndPid : alreadyBooted) {
     auto bootable = registry->get<Bootable>(entityAndPid.first);
-    appsWithHotKeys.push_back(entityAndPid.first);
+    {
+      std::lock_guard<std::mutex> lock(renderLoopMutex);
+      appsWithHotKeys.push_back(entityAndPid.first);
+    }
     auto app = X11App::byPID(entityAndPid.second, display, screen,
                              bootable.getWidth(), bootable.getHeight());
     addApp(app, entityAndPid.first);
   }
-  systems::bootAll(registry, envp);
+  // every app is forked before any pid is waited on, so this takes as long
+  // as the slowest shell script rather than all of them in turn
+  auto launched = systems::launchAll(registry, envp);
+  vector<AppLauncher::Handle> launches;
+  for (auto& app : launched) {
+    launches.push_back(launcher.expect(app.entity, app.forkedPid));
+  }
+  for (size_t i = 0; i < launched.size(); i++) {
+    auto pid = launched[i].pid.get();
+    registry->get<Bootable>(launched[i].entity).pid = pid;
+    if (pid.has_value()) {
+      launcher.identify(launches[i], pid.value());
+    }
+  }
+  // the apps start together, so they share one deadline
+  auto deadline = std::chrono::steady_clock::now() + APP_TIMEOUT;
+  for (size_t i = 0; i < launches.size(); i++) {
+    if (launches[i]->window.wait_until(deadline) !=
+        std::future_status::ready) {
+      launcher.cancel(launches[i]);
+      logger->error("no window for bootable " +
+                    to_string((int)launched[i].entity));
+    }
+  }
 
   //forkOrFindApp("/usr/bin/emacs", "emacs", "Emacs", ideSelection.emacs, envp);
   //forkOrFindApp("/usr/bin/code", "emacs", "Emacs", ideSelection.vsCode, envp);
@@ -171,13 +212,19 @@ void WindowManager::addApps() {
     return currentlyFocusedApp;
  }
 
+// on the render thread, which is the one tick adds apps on
 void WindowManager::addApp(X11App *app, entt::entity entity) {
+  appsWaitingToAdd.push_back({ app, app->getWindow(), entity });
+  knowWindow(app->getWindow());
+}
+
+void WindowManager::knowWindow(Window window) {
   std::lock_guard<std::mutex> lock(renderLoopMutex);
-  auto window = app->getWindow();
-  appsToAdd.push_back(app);
-  dynamicApps[window] = entity;
+  knownWindows.insert(window);
 }
 
+// event thread, so the entity is left to tick unless a launch claims the
+// window
 void WindowManager::createApp(Window window, unsigned int width,
                                  unsigned int height) {
 
@@ -188,28 +235,69 @@ void WindowManager::createApp(Window window, unsigned int width,
     app->unfocus(matrix);
   }
 
-  if(currentlyFocusedApp.has_value()) {
-    auto& app = registry->get<X11App>(currentlyFocusedApp.value());
-    app.focus(matrix);
+  // popups and splash screens share the app's pid, only its own window
+  // answers the launch
+  optional<entt::entity> launched;
+  if (!app->isAccessory()) {
+    int pid = app->getPID();
+    launched = launcher.claim(
+      window, pid == -1 ? nullopt : optional<int>(pid), windowClass(window));
   }
+  std::lock_guard<std::mutex> lock(renderLoopMutex);
+  changes.pending().added.push_back({ app, window, launched });
+  knownWindows.insert(window);
+}
 
-  entt::entity entity;
+// render thread, once per added window
+void WindowManager::resolveEntity(WindowChanges::Added &added) {
+  if (added.entity.has_value()) {
+    auto bootable = registry->try_get<Bootable>(added.entity.value());
+    if (bootable != NULL) {
+      added.app->resize(bootable->getWidth(), bootable->getHeight());
+    }
+    return;
+  }
+  added.entity = systems::matchApp(registry, added.app);
+  if (!added.entity.has_value()) {
+    added.entity = registry->create();
+  }
+}
 
-  auto bootableEntity = systems::matchApp(registry, app);
+// NULL once the entity has moved on to another window's X11App, like a
+// bootable's relaunch
+X11App* WindowManager::appForWindow(Window window) {
+  auto found = dynamicApps.find(window);
+  if (found == dynamicApps.end()) {
+    return NULL;
+  }
+  auto app = registry->try_get<X11App>(found->second);
+  if (app == NULL || app->getWindow() != window) {
+    return NULL;
+  }
+  return app;
+}
 
-  if(bootableEntity.has_value()) {
-    entity = bootableEntity.value();
-  } else {
-    entity = registry->create();
+string WindowManager::windowClass(Window window) {
+  XClassHint classHint;
+  classHint.res_class = NULL;
+  classHint.res_name = NULL;
+  XGetClassHint(display, window, &classHint);
+  string className = classHint.res_class != NULL ? classHint.res_class : "";
+  if (classHint.res_class != NULL) {
+    XFree(classHint.res_class);
   }
-  if(!app->isAccessory()) {
-    appsWithHotKeys.push_back(entity);
+  if (classHint.res_name != NULL) {
+    XFree(classHint.res_name);
   }
-  addApp(app, entity);
+  return className;
 }
 
 void WindowManager::onMapRequest(XMapRequestEvent event) {
-  bool alreadyRegistered = dynamicApps.count(event.window);
+  bool alreadyRegistered;
+  {
+    std::lock_guard<std::mutex> lock(renderLoopMutex);
+    alreadyRegistered = knownWindows.contains(event.window);
+  }
 
   stringstream ss;
   ss << "map request for window: " << event.window << ", "
@@ -223,17 +311,21 @@ void WindowManager::onMapRequest(XMapRequestEvent event) {
 }
 
 void WindowManager::removeAppForWindow(Window window) {
-  renderLoopMutex.lock();
-  if (dynamicApps.contains(window)) {
-    auto appEntity = dynamicApps.at(window);
-    dynamicApps.erase(window);
-    auto hotkey = find(appsWithHotKeys.begin(), appsWithHotKeys.end(), appEntity);
-    if(hotkey != appsWithHotKeys.end()) {
-      appsWithHotKeys.erase(hotkey);
-    }
-    appsToRemove.push_back(appEntity);
-  }
-  renderLoopMutex.unlock();
+  std::lock_guard<std::mutex> lock(renderLoopMutex);
+  if (!knownWindows.erase(window)) {
+    return;
+  }
+  // gone before tick saw it, there is nothing to remove
+  auto &added = changes.pending().added;
+  auto unapplied = find_if(added.begin(), added.end(), [window](auto &app) {
+    return app.window == window;
+  });
+  if (unapplied != added.end()) {
+    delete unapplied->app;
+    added.erase(unapplied);
+    return;
+  }
+  changes.pending().removed.push_back(window);
 }
 
 void WindowManager::swapHotKeys(int a, int b) {
@@ -278,22 +370,28 @@ void WindowManager::onHotkeyPress(XKeyEvent event) {
 
   if (event.keycode == windowLargerCode && event.state & Mod4Mask) {
     if (currentlyFocusedApp.has_value()) {
-      lock_guard<mutex> lock(renderLoopMutex);
-      events.push_back(WindowEvent{ LARGER, currentlyFocusedApp.value() });
+      changes.pending().events.push_back(
+        WindowEvent{ LARGER, currentlyFocusedApp.value() });
     }
   }
 
   if (event.keycode == windowSmallerCode && event.state & Mod4Mask) {
     if (currentlyFocusedApp.has_value()) {
-      lock_guard<mutex> lock(renderLoopMutex);
-      events.push_back(WindowEvent{ SMALLER, currentlyFocusedApp.value() });
+      changes.pending().events.push_back(
+        WindowEvent{ SMALLER, currentlyFocusedApp.value() });
     }
   }
 
-  for (int i = 0; i < min((int)appsWithHotKeys.size(), 9); i++) {
+  vector<optional<entt::entity>> hotKeys;
+  {
+    std::lock_guard<std::mutex> lock(renderLoopMutex);
+    hotKeys = appsWithHotKeys;
+  }
+  for (int i = 0; i < min((int)hotKeys.size(), HOTKEY_SLOTS); i++) {
     KeyCode code = XKeysymToKeycode(display, XK_1 + i);
     if (event.keycode == code && event.state & Mod4Mask && event.state & ShiftMask) {
       if (currentlyFocusedApp.has_value()) {
+        std::lock_guard<std::mutex> lock(renderLoopMutex);
         int source = findAppsHotKey(currentlyFocusedApp.value());
         swapHotKeys(source, i);
         return;
@@ -301,8 +399,8 @@ void WindowManager::onHotkeyPress(XKeyEvent event) {
     }
     if (event.keycode == code && event.state & Mod4Mask) {
       unfocusApp();
-      if(appsWithHotKeys[i]) {
-        controls->goToApp(appsWithHotKeys[i].value());
+      if(hotKeys[i]) {
+        controls->goToApp(hotKeys[i].value());
       }
     }
   }
@@ -313,7 +411,17 @@ void WindowManager::onHotkeyPress(XKeyEvent event) {
   }
 }
 
+// how long the event thread sleeps on the connection, shorter while a batch
+// of changes is waiting for tick to hand the last one back. Events another
+// thread's round trip read off the connection are picked up within it too.
+const int EVENT_POLL_MS = 10;
+const int PUBLISH_RETRY_MS = 2;
+
+// Drains whatever events have arrived without blocking, then offers tick
+// what came of them as one batch.
 void WindowManager::handleSubstructure() {
+  int connection = ConnectionNumber(display);
+  bool published = true;
   for (;;) {
     {
       lock_guard<std::mutex> continueLock(continueMutex);
@@ -321,71 +429,86 @@ void WindowManager::handleSubstructure() {
         break;
       }
     }
-    XEvent e;
-    XNextEvent(display, &e);
-    stringstream eventInfo;
-    Window root = XRootWindow(display, 0);
-
-    XWindowAttributes attrs;
+    while (XPending(display) > 0) {
+      XEvent e;
+      XNextEvent(display, &e);
+      handleEvent(e);
+    }
+    published = changes.publish();
+    pollfd readable = { connection, POLLIN, 0 };
+    poll(&readable, 1, published ? EVENT_POLL_MS : PUBLISH_RETRY_MS);
+  }
+}
 
-    switch (e.type) {
-    case CreateNotify:
-      logger->info("CreateNotify event");
-      logger->flush();
-      XGetWindowAttributes(display, e.xcreatewindow.window, &attrs);
-      if (e.xcreatewindow.override_redirect == True) {
-        if(e.xcreatewindow.width > 30) {
-          createApp(e.xcreatewindow.window, e.xcreatewindow.width,
-                    e.xcreatewindow.height);
-        }
+void WindowManager::handleEvent(XEvent &e) {
+  if (e.type == damageEventBase + XDamageNotify) {
+    onDamage((XDamageNotifyEvent*)&e);
+    return;
+  }
+  XWindowAttributes attrs;
+
+  switch (e.type) {
+  case CreateNotify:
+    logger->info("CreateNotify event");
+    logger->flush();
+    XGetWindowAttributes(display, e.xcreatewindow.window, &attrs);
+    if (e.xcreatewindow.override_redirect == True) {
+      if(e.xcreatewindow.width > 30) {
+        createApp(e.xcreatewindow.window, e.xcreatewindow.width,
+                  e.xcreatewindow.height);
       }
-      break;
-    case DestroyNotify:
-      logger->info("DestroyNotify event");
-      logger->flush();
-      removeAppForWindow(e.xdestroywindow.window);
-      break;
-    case UnmapNotify:
-      logger->info("UnmapNotify event");
-      removeAppForWindow(e.xunmap.window);
-      break;
-
-    case MapNotify:
-      {
-        logger->info("MapNotify event");
-        renderLoopMutex.lock();
-        bool alreadyCreated = dynamicApps.contains(e.xmap.window);
-        renderLoopMutex.unlock();
-        XGetWindowAttributes(display, e.xmap.window, &attrs);
-        if (!alreadyCreated && e.xmap.override_redirect == True) {
-          if(attrs.width > 30) {
-            createApp(e.xmap.window, attrs.width,
-                attrs.height);
-          }
+    }
+    break;
+  case DestroyNotify:
+    logger->info("DestroyNotify event");
+    logger->flush();
+    removeAppForWindow(e.xdestroywindow.window);
+    break;
+  case UnmapNotify:
+    logger->info("UnmapNotify event");
+    removeAppForWindow(e.xunmap.window);
+    break;
+
+  case MapNotify:
+    {
+      logger->info("MapNotify event");
+      renderLoopMutex.lock();
+      bool alreadyCreated = knownWindows.contains(e.xmap.window);
+      renderLoopMutex.unlock();
+      XGetWindowAttributes(display, e.xmap.window, &attrs);
+      if (!alreadyCreated && e.xmap.override_redirect == True) {
+        if(attrs.width > 30) {
+          createApp(e.xmap.window, attrs.width,
+              attrs.height);
         }
-        break;
       }
-    case MapRequest:
-      logger->info("MapRequest event");
-      onMapRequest(e.xmaprequest);
-      break;
-    case KeyPress:
-      onHotkeyPress(e.xkey);
-      break;
-    case ConfigureNotify:
-      logger->info("ConfigureNotify");
-      reconfigureWindow(e.xconfigure);
       break;
     }
+  case MapRequest:
+    logger->info("MapRequest event");
+    onMapRequest(e.xmaprequest);
+    break;
+  case KeyPress:
+    onHotkeyPress(e.xkey);
+    break;
+  case ConfigureNotify: {
+    lock_guard<mutex> lock(renderLoopMutex);
+    if (knownWindows.contains(e.xconfigure.window)) {
+      changes.pending().configure(e.xconfigure.window, e.xconfigure.width,
+                                  e.xconfigure.height);
+    }
+    break;
+  }
   }
 }
 
-void WindowManager::reconfigureWindow(XConfigureEvent configureEvent) {
-  if(dynamicApps.contains(configureEvent.window)) {
-    auto app = registry->try_get<X11App>(dynamicApps[configureEvent.window]);
-    if(app!=NULL) {
-      app->resize(configureEvent.width, configureEvent.height);
-    }
+void WindowManager::onDamage(XDamageNotifyEvent* event) {
+  // re-arm the damage object so the next draw reports again
+  XDamageSubtract(display, event->damage, None, None);
+  // tick flags the redraw, the X11App may be mid add or removal
+  lock_guard<mutex> lock(renderLoopMutex);
+  if (knownWindows.contains(event->drawable)) {
+    changes.pending().damage(event->drawable);
   }
 }
 
@@ -424,21 +547,37 @@ void WindowManager::logWaitForRemovalChangeSize(int changeSize) {
   return changeSize;
 }
 
-void WindowManager::adjustAppsToAddAfterAdditions(vector<X11App*> &waitForRemoval) {
-  appsToAdd.clear();
+void WindowManager::adjustAppsToAddAfterAdditions(
+    vector<WindowChanges::Added> &waitForRemoval) {
   int changeSize = waitForRemovalChangeSize(waitForRemoval.size());
   logWaitForRemovalChangeSize(changeSize);
   if(waitForRemoval.size() >= 10) {
     logger->critical("waitForRemoval size is critically large");
   }
-  appsToAdd.assign(waitForRemoval.begin(), waitForRemoval.end());
+  appsWaitingToAdd.assign(waitForRemoval.begin(), waitForRemoval.end());
 }
 
 void WindowManager::tick() {
-  lock_guard<mutex> lock(renderLoopMutex);
+  auto batch = changes.take();
+  if (batch != NULL) {
+    applyChanges(*batch);
+    changes.release(batch);
+  } else if (!appsWaitingToAdd.empty()) {
+    WindowChanges none;
+    applyChanges(none);
+  }
+}
 
-  for (auto it = events.begin(); it != events.end(); it++) {
+void WindowManager::applyChanges(WindowChanges &batch) {
+  if (batch.coalesced > 0) {
+    logger->debug("coalesced " + to_string(batch.coalesced) +
+                  " window events");
+  }
+  for (auto it = batch.events.begin(); it != batch.events.end(); it++) {
     auto app = registry->try_get<X11App>(it->window);
+    if (app == NULL) {
+      continue;
+    }
     if(it->type == SMALLER) {
       app->smaller();
     }
@@ -446,17 +585,44 @@ void WindowManager::tick() {
       app->larger();
     }
   }
-  events.clear();
 
-  for (auto it = appsToRemove.begin(); it != appsToRemove.end(); it++) {
+  for (auto window : batch.removed) {
+    // still waiting for its entity's last X11App to go
+    auto waiting = find_if(
+      appsWaitingToAdd.begin(), appsWaitingToAdd.end(),
+      [window](auto &app) { return app.window == window; });
+    if (waiting != appsWaitingToAdd.end()) {
+      delete waiting->app;
+      appsWaitingToAdd.erase(waiting);
+      continue;
+    }
+    auto found = dynamicApps.find(window);
+    if (found == dynamicApps.end()) {
+      continue;
+    }
+    auto entity = found->second;
+    bool replaced =
+      registry->all_of<X11App>(entity) && appForWindow(window) == NULL;
+    dynamicApps.erase(found);
+    if (replaced) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(renderLoopMutex);
+      auto hotkey =
+        find(appsWithHotKeys.begin(), appsWithHotKeys.end(), entity);
+      if (hotkey != appsWithHotKeys.end()) {
+        appsWithHotKeys.erase(hotkey);
+      }
+    }
     try {
-      if (currentlyFocusedApp == *it) {
+      if (currentlyFocusedApp == entity) {
         unfocusApp();
       }
-      if (registry->all_of<X11App>(*it)) {
-        space->removeApp(*it);
-        if (registry->orphan(*it)) {
-          registry->destroy(*it);
+      if (registry->all_of<X11App>(entity)) {
+        space->removeApp(entity);
+        if (registry->orphan(entity)) {
+          registry->destroy(entity);
         }
       }
     } catch (exception &e) {
@@ -464,28 +630,39 @@ void WindowManager::tick() {
       logger->flush();
     }
   }
-  appsToRemove.clear();
 
-  vector<X11App *> waitForRemoval;
+  for (auto &added : batch.added) {
+    resolveEntity(added);
+  }
+  vector<WindowChanges::Added> appsToAdd;
+  appsToAdd.swap(appsWaitingToAdd);
+  appsToAdd.insert(appsToAdd.end(), batch.added.begin(), batch.added.end());
+  vector<WindowChanges::Added> waitForRemoval;
   for (auto it = appsToAdd.begin(); it != appsToAdd.end(); it++) {
     try {
-
-      auto appEntity = dynamicApps[(*it)->getWindow()];
-
+      auto appEntity = it->entity.value();
       if(registry->valid(appEntity)) {
         if(registry->all_of<X11App>(appEntity)) {
           waitForRemoval.push_back(*it);
         } else {
-          registry->emplace<X11App>(appEntity, std::move(**it));
-          delete *it;
+          bool accessory = it->app->isAccessory();
+          registry->emplace<X11App>(appEntity, std::move(*it->app));
+          delete it->app;
+          dynamicApps[it->window] = appEntity;
+          if (!accessory) {
+            std::lock_guard<std::mutex> lock(renderLoopMutex);
+            if (findAppsHotKey(appEntity) == -1) {
+              appsWithHotKeys.push_back(appEntity);
+            }
+          }
 
           auto spawnAtCamera = !currentlyFocusedApp.has_value();
           space->addApp(appEntity, spawnAtCamera);
 
+          // an app that failed to register stays in dynamicApps until its
+          // window unmaps, and until then its events find no X11App
           if(registry->all_of<X11App>(appEntity)) {
             createUnfocusHackThread(appEntity);
-          } else {
-            dynamicApps.erase((*it)->getWindow());
           }
         }
       }
@@ -495,6 +672,28 @@ void WindowManager::tick() {
     }
   }
   adjustAppsToAddAfterAdditions(waitForRemoval);
+
+  // new windows may have taken the focused app's focus
+  if (!batch.added.empty() && currentlyFocusedApp.has_value()) {
+    auto app = registry->try_get<X11App>(currentlyFocusedApp.value());
+    if (app != NULL) {
+      app->focus(matrix);
+    }
+  }
+
+  // only the size each window ended up at
+  for (auto &[window, size] : batch.configured) {
+    auto app = appForWindow(window);
+    if (app != NULL) {
+      app->resize(size.width, size.height);
+    }
+  }
+  for (auto window : batch.damaged) {
+    auto app = appForWindow(window);
+    if (app != NULL) {
+      app->damageNotify();
+    }
+  }
 }
 
 void WindowManager::focusApp(entt::entity appEntity) {
@@ -611,6 +810,9 @@ WindowManager::WindowManager(shared_ptr<EntityRegistry> registry, Window matrix,
   display = XOpenDisplay(NULL);
   screen = XDefaultScreen(display);
   X11App::initAppClass(display, screen);
+  if (!XDamageQueryExtension(display, &damageEventBase, &damageErrorBase)) {
+    logger->error("XDamage extension unavailable");
+  }
   Window root = RootWindow(display, screen);
   setWMProps(root);
   XCompositeRedirectSubwindows(display, RootWindow(display, screen),
@@ -628,7 +830,7 @@ WindowManager::WindowManager(shared_ptr<EntityRegistry> registry, Window matrix,
 
   XSelectInput(display, matrix, FocusChangeMask | LeaveWindowMask);
 
-  for (int i = 0; i < 10; i++) {
+  for (int i = 0; i <= HOTKEY_SLOTS; i++) {
     KeyCode code = XKeysymToKeycode(display, XK_0 + i);
     XGrabKey(display, code, Mod4Mask, root, true, GrabModeAsync, GrabModeAsync);
     XGrabKey(display, code, Mod4Mask | ShiftMask, root, true, GrabModeAsync, GrabModeAsync);
@@ -0,0 +1,115 @@
+#include "WriteBehind.h"
+#include "logger.h"
+#include "tracy/Tracy.hpp"
+#include <chrono>
+
+WriteBehind::Connection::Connection(std::string dbFile)
+  : db(dbFile, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE)
+  , statements(db)
+{
+  db.exec("PRAGMA journal_mode=WAL");
+  db.exec("PRAGMA synchronous=NORMAL");
+  db.setBusyTimeout(5000);
+}
+
+WriteBehind::WriteBehind(std::string dbFile, int flushInterval)
+  : connection(dbFile)
+  , flushInterval(flushInterval)
+{
+  logger = std::make_shared<spdlog::logger>("WriteBehind", fileSink);
+  logger->set_level(spdlog::level::info);
+  writer = std::thread(&WriteBehind::run, this);
+}
+
+WriteBehind::~WriteBehind()
+{
+  {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  writer.join();
+}
+
+void
+WriteBehind::stage(const std::string& key, Write write)
+{
+  std::lock_guard<std::mutex> lock(pendingMutex);
+  auto it = pendingByKey.find(key);
+  if (it != pendingByKey.end()) {
+    pending[it->second] = std::nullopt;
+    it->second = pending.size();
+  } else {
+    pendingByKey[key] = pending.size();
+  }
+  pending.push_back(std::move(write));
+}
+
+size_t
+WriteBehind::pendingWrites()
+{
+  std::lock_guard<std::mutex> lock(pendingMutex);
+  return pendingByKey.size();
+}
+
+void
+WriteBehind::flush()
+{
+  drain();
+}
+
+void
+WriteBehind::run()
+{
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(pendingMutex);
+      wake.wait_for(lock, std::chrono::milliseconds(flushInterval), [this]() {
+        return stopping;
+      });
+      if (stopping) {
+        break;
+      }
+    }
+    drain();
+  }
+  drain();
+}
+
+void
+WriteBehind::drain()
+{
+  ZoneScoped;
+  std::lock_guard<std::mutex> connectionLock(connectionMutex);
+  std::vector<std::optional<Write>> batch;
+  {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    batch.swap(pending);
+    pendingByKey.clear();
+  }
+  if (batch.empty()) {
+    return;
+  }
+
+  int written = 0;
+  try {
+    SQLite::Transaction transaction(connection.getDatabase());
+    for (auto& write : batch) {
+      if (!write) {
+        continue;
+      }
+      try {
+        (*write)(connection);
+        written++;
+      } catch (std::exception& e) {
+        logger->error(std::string("write failed: ") + e.what());
+      }
+    }
+    transaction.commit();
+  } catch (std::exception& e) {
+    logger->error(std::string("flush failed, ") + std::to_string(written) +
+                  " writes lost: " + e.what());
+    return;
+  }
+  logger->debug("flushed " + std::to_string(written) + " writes");
+}
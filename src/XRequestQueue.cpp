@@ -0,0 +1,182 @@
+#include "XRequestQueue.h"
+
+XRequestQueue::XRequestQueue(Display* display)
+  : display(display)
+{
+  sender = std::thread(&XRequestQueue::run, this);
+}
+
+XRequestQueue::XRequestQueue(const char* displayName)
+  : ownsDisplay(true)
+{
+  display = XOpenDisplay(displayName);
+  sender = std::thread(&XRequestQueue::run, this);
+}
+
+XRequestQueue::~XRequestQueue()
+{
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    stopping = true;
+  }
+  queued.notify_one();
+  sender.join();
+  if (ownsDisplay && display != NULL) {
+    XCloseDisplay(display);
+  }
+}
+
+bool
+XRequestQueue::isConnected()
+{
+  return display != NULL;
+}
+
+void
+XRequestQueue::moveResize(Window window,
+                          int x,
+                          int y,
+                          int width,
+                          int height,
+                          State state)
+{
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    geometry[window] = { x, y, width, height, state };
+    queuedCount++;
+  }
+  queued.notify_one();
+}
+
+// a resize still waiting to go out keeps its size
+void
+XRequestQueue::move(Window window, int x, int y)
+{
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    auto& pending = geometry[window];
+    pending.x = x;
+    pending.y = y;
+    queuedCount++;
+  }
+  queued.notify_one();
+}
+
+void
+XRequestQueue::locate(Window window, State state)
+{
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    locates.push_back({ window, state });
+    queuedCount++;
+  }
+  queued.notify_one();
+}
+
+void
+XRequestQueue::request(std::function<void(Display*)> request)
+{
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    requests.push_back(request);
+    queuedCount++;
+  }
+  queued.notify_one();
+}
+
+void
+XRequestQueue::flush()
+{
+  std::unique_lock<std::mutex> lock(queueMutex);
+  uint64_t target = queuedCount;
+  sent.wait(lock, [this, target]() { return sentCount >= target; });
+}
+
+uint64_t
+XRequestQueue::getBatchCount()
+{
+  std::lock_guard<std::mutex> lock(queueMutex);
+  return batchCount;
+}
+
+// whatever queued up while the last batch was going out is the next batch
+void
+XRequestQueue::run()
+{
+  std::vector<std::function<void(Display*)>> batchRequests;
+  std::map<Window, Geometry> batchGeometry;
+  std::vector<std::pair<Window, State>> batchLocates;
+  for (;;) {
+    uint64_t batchQueued;
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      queued.wait(lock, [this]() {
+        return stopping || sentCount < queuedCount;
+      });
+      if (stopping && sentCount == queuedCount) {
+        return;
+      }
+      batchRequests.swap(requests);
+      batchGeometry.swap(geometry);
+      batchLocates.swap(locates);
+      batchQueued = queuedCount;
+    }
+    if (display != NULL) {
+      send(batchRequests, batchGeometry, batchLocates);
+    }
+    batchRequests.clear();
+    batchGeometry.clear();
+    batchLocates.clear();
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      sentCount = batchQueued;
+      batchCount++;
+    }
+    sent.notify_all();
+  }
+}
+
+void
+XRequestQueue::send(std::vector<std::function<void(Display*)>>& batchRequests,
+                    std::map<Window, Geometry>& batchGeometry,
+                    std::vector<std::pair<Window, State>>& batchLocates)
+{
+  for (auto& request : batchRequests) {
+    request(display);
+  }
+  bool resized = false;
+  for (auto& [window, change] : batchGeometry) {
+    if (change.width.has_value() && change.height.has_value()) {
+      XMoveResizeWindow(display,
+                        window,
+                        change.x,
+                        change.y,
+                        change.width.value(),
+                        change.height.value());
+      resized = true;
+    } else {
+      XMoveWindow(display, window, change.x, change.y);
+    }
+  }
+  Window root = DefaultRootWindow(display);
+  for (auto& [window, state] : batchLocates) {
+    Window child;
+    int x;
+    int y;
+    if (XTranslateCoordinates(display, window, root, 0, 0, &x, &y, &child)) {
+      state->x = x;
+      state->y = y;
+      state->located = true;
+    }
+  }
+  if (!resized) {
+    XFlush(display);
+    return;
+  }
+  XSync(display, False);
+  for (auto& [window, change] : batchGeometry) {
+    if (change.state != NULL && change.width.has_value()) {
+      change.state->resized = true;
+    }
+  }
+}
@@ -1,4 +1,6 @@
 #include "api.h"
+#include "Config.h"
+#include "camera.h"
 #include "controls.h"
 #include "dynamicObject.h"
 #include "glm/fwd.hpp"
@@ -15,70 +17,169 @@
 #include <sstream>
 #include <string>
 #include <zmq/zmq.hpp>
+#include <zmq/zmq_addon.hpp>
 #undef Status
 #include "protos/api.pb.h"
 
 using namespace std;
 
-int BatchedRequest::nextId = 0;
+atomic<int64_t> BatchedRequest::nextId = 0;
 
 Api::Api(std::string bindAddress,
+         std::string batchBindAddress,
+         std::string stateBindAddress,
          shared_ptr<EntityRegistry> registry,
          Controls* controls,
+         Camera* camera,
          shared_ptr<WindowManager::WindowManager> wm)
   : registry(registry)
   , controls(controls)
+  , camera(camera)
   , wm(wm)
+  , batchedRequests(MAX_QUEUED_REQUESTS)
 {
   context = zmq::context_t(2);
   logger = make_shared<spdlog::logger>("Api", fileSink);
   logger->set_level(spdlog::level::debug);
+  answersIn = zmq::socket_t(context, zmq::socket_type::pair);
+  answersIn.bind("inproc://api-answers");
+  answersOut = zmq::socket_t(context, zmq::socket_type::pair);
+  answersOut.connect("inproc://api-answers");
   commandServer = new ProtobufCommandServer(this, bindAddress, context);
+  batchCommandServer = new BatchCommandServer(this, batchBindAddress, context);
+  double publishRate = Config::singleton()->get<int>("api.publish_rate", 60);
+  statePublisher = new StatePublisher(
+    registry, camera, context, stateBindAddress, publishRate);
   offRenderThread = thread(&Api::poll, this);
 }
 
 CommandServer::CommandServer(Api* api,
                              std::string bindAddress,
-                             zmq::context_t& context)
+                             zmq::context_t& context,
+                             zmq::socket_type type)
   : api(api)
 {
   logger = make_shared<spdlog::logger>("CommandServer", fileSink);
   logger->set_level(spdlog::level::info);
-  socket = zmq::socket_t(context, zmq::socket_type::rep);
+  socket = zmq::socket_t(context, type);
   socket.bind(bindAddress);
 }
 
+Api::ProtobufCommandServer::ProtobufCommandServer(Api* api,
+                                                  std::string bindAddress,
+                                                  zmq::context_t& context)
+  : CommandServer(api, bindAddress, context, zmq::socket_type::router)
+{
+}
+
+Api::BatchCommandServer::BatchCommandServer(Api* api,
+                                            std::string bindAddress,
+                                            zmq::context_t& context)
+  : CommandServer(api, bindAddress, context, zmq::socket_type::router)
+{
+}
+
 void
 Api::ProtobufCommandServer::poll()
 {
   try {
-    zmq::message_t recv;
-    zmq::recv_result_t result = socket.recv(recv);
+    // [identity, empty delimiter, request] from REQ clients
+    vector<zmq::message_t> parts;
+    auto result =
+      zmq::recv_multipart(socket, back_inserter(parts), zmq::recv_flags::none);
+    if (!result || parts.size() < 2) {
+      return;
+    }
 
-    if (result >= 0) {
-      ApiRequest apiRequest;
-      apiRequest.ParseFromArray(recv.data(), recv.size());
+    ApiRequest apiRequest;
+    apiRequest.ParseFromArray(parts.back().data(), parts.back().size());
 
-      api->grabBatched();
-      auto batchedRequests = api->getBatchedRequests();
-      auto request = BatchedRequest(apiRequest);
-      batchedRequests->push(request);
-      api->releaseBatched();
+    // answered by the render thread, the reply goes out through forward
+    if (apiRequest.type() == QUERY_POSITIONABLE ||
+        apiRequest.type() == QUERY_CAMERA) {
+      PendingQuery query;
+      for (size_t i = 0; i + 1 < parts.size(); i++) {
+        query.envelope.push_back(
+          string((const char*)parts[i].data(), parts[i].size()));
+      }
+      query.request = apiRequest;
+      api->queueQuery(std::move(query));
+      return;
+    }
+
+    ApiRequestResponse response;
+    auto request = BatchedRequest(apiRequest);
+    bool queued = api->queueRequest(request);
+    response.set_requestid(request.id);
+    response.set_rejected(!queued);
+
+    // Serialize the protocol buffer object to a byte array
+    std::string serializedResponse;
+    response.SerializeToString(&serializedResponse);
 
-      ApiRequestResponse response;
-      response.set_requestid(request.id);
+    parts.back().rebuild(serializedResponse.data(), serializedResponse.size());
+    zmq::send_multipart(socket, parts, zmq::send_flags::dontwait);
+  } catch (zmq::error_t& e) {
+  }
+}
+
+void
+Api::ProtobufCommandServer::forward(vector<zmq::message_t>& reply)
+{
+  try {
+    zmq::send_multipart(socket, reply, zmq::send_flags::dontwait);
+  } catch (zmq::error_t& e) {
+  }
+}
+
+void
+Api::BatchCommandServer::poll()
+{
+  try {
+    // [identity, (empty delimiter from REQ clients), batch]
+    vector<zmq::message_t> parts;
+    auto result =
+      zmq::recv_multipart(socket, back_inserter(parts), zmq::recv_flags::none);
+    if (!result || parts.size() < 2) {
+      return;
+    }
 
-      // Serialize the protocol buffer object to a byte array
-      std::string serializedResponse;
-      response.SerializeToString(&serializedResponse);
+    ApiBatch batch;
+    if (!batch.ParseFromArray(parts.back().data(), parts.back().size())) {
+      logger->error("failed to parse ApiBatch");
+      return;
+    }
 
-      // Create a zmq::message_t object from the serialized data
-      zmq::message_t reply(serializedResponse.size());
-      memcpy(
-        reply.data(), serializedResponse.c_str(), serializedResponse.size());
+    // requests are queued in order until the queue is full, the rest of the
+    // batch is rejected and the client always hears about it
+    int64_t firstRequestId = -1;
+    int count = 0;
+    for (auto& apiRequest : batch.requests()) {
+      auto request = BatchedRequest(apiRequest);
+      if (!api->queueRequest(request)) {
+        break;
+      }
+      if (firstRequestId == -1) {
+        firstRequestId = request.id;
+      }
+      count++;
+    }
+    int rejected = batch.requests_size() - count;
 
-      socket.send(reply, zmq::send_flags::none);
+    if (!batch.ack() && rejected == 0) {
+      return;
     }
+
+    ApiBatchResponse response;
+    response.set_batchid(batch.batchid());
+    response.set_firstrequestid(firstRequestId);
+    response.set_count(count);
+    response.set_rejected(rejected);
+    std::string serializedResponse;
+    response.SerializeToString(&serializedResponse);
+
+    parts.back().rebuild(serializedResponse.data(), serializedResponse.size());
+    zmq::send_multipart(socket, parts, zmq::send_flags::dontwait);
   } catch (zmq::error_t& e) {
   }
 }
@@ -86,10 +187,41 @@ Api::ProtobufCommandServer::poll()
 void
 Api::poll()
 {
+  zmq::pollitem_t items[] = {
+    { commandServer->getSocket().handle(), 0, ZMQ_POLLIN, 0 },
+    { batchCommandServer->getSocket().handle(), 0, ZMQ_POLLIN, 0 },
+    { answersIn.handle(), 0, ZMQ_POLLIN, 0 }
+  };
   while (continuePolling) {
-    if (commandServer != NULL) {
+    // stop reading commands while the render loop catches up, clients then
+    // block on their socket's high water mark instead of piling up
+    // rejections. Query answers still go out meanwhile.
+    bool full = batchedRequests.size() >= batchedRequests.capacity();
+    items[0].events = full ? 0 : ZMQ_POLLIN;
+    items[1].events = full ? 0 : ZMQ_POLLIN;
+    try {
+      zmq::poll(items, 3, std::chrono::milliseconds(full ? 1 : 100));
+    } catch (zmq::error_t& e) {
+      // the context was shut down
+      continue;
+    }
+    if (items[0].revents & ZMQ_POLLIN) {
       commandServer->poll();
     }
+    if (items[1].revents & ZMQ_POLLIN) {
+      batchCommandServer->poll();
+    }
+    if (items[2].revents & ZMQ_POLLIN) {
+      try {
+        vector<zmq::message_t> reply;
+        while (zmq::recv_multipart(
+          answersIn, back_inserter(reply), zmq::recv_flags::dontwait)) {
+          commandServer->forward(reply);
+          reply.clear();
+        }
+      } catch (zmq::error_t& e) {
+      }
+    }
   }
 }
 
@@ -137,33 +269,69 @@ Api::processBatchedRequest(BatchedRequest batchedRequest)
 void
 Api::mutateEntities()
 {
-  long time = glfwGetTime();
-  long target = time + 0.005;
-  grabBatched();
-  auto batchedRequests = getBatchedRequests();
-  for (; time <= target && batchedRequests->size() != 0; time = glfwGetTime()) {
-    processBatchedRequest(batchedRequests->front());
-    batchedRequests->pop();
+  double target = glfwGetTime() + 0.005;
+  answerQueries();
+  BatchedRequest request;
+  while (glfwGetTime() <= target && batchedRequests.pop(request)) {
+    processBatchedRequest(request);
   }
-  releaseBatched();
 }
 
 void
-Api::grabBatched()
+Api::publishState()
+{
+  statePublisher->publish(glfwGetTime());
+}
+
+// called from the poll thread, the registry is only read on the render
+// thread so the query is answered there on the next frame
+void
+Api::queueQuery(PendingQuery query)
 {
-  renderMutex.lock();
+  lock_guard<mutex> lock(queryMutex);
+  pendingQueries.push_back(std::move(query));
 }
 
 void
-Api::releaseBatched()
+Api::answerQueries()
 {
-  renderMutex.unlock();
+  vector<PendingQuery> queries;
+  {
+    lock_guard<mutex> lock(queryMutex);
+    queries.swap(pendingQueries);
+  }
+  for (auto& query : queries) {
+    ApiRequestResponse response;
+    if (query.request.type() == QUERY_CAMERA) {
+      *response.mutable_camera() = toCameraState(camera);
+    } else {
+      auto entity = (entt::entity)query.request.entityid();
+      if (registry->valid(entity)) {
+        auto positionable = registry->try_get<Positionable>(entity);
+        if (positionable) {
+          *response.mutable_positionable() =
+            toPositionableState(entity, *positionable);
+        }
+      }
+    }
+    std::string serializedResponse;
+    response.SerializeToString(&serializedResponse);
+    vector<zmq::const_buffer> reply;
+    for (auto& frame : query.envelope) {
+      reply.push_back(zmq::buffer(frame));
+    }
+    reply.push_back(zmq::buffer(serializedResponse));
+    try {
+      zmq::send_multipart(answersOut, reply, zmq::send_flags::dontwait);
+    } catch (zmq::error_t& e) {
+    }
+  }
 }
 
-queue<BatchedRequest>*
-Api::getBatchedRequests()
+bool
+Api::queueRequest(BatchedRequest& request)
 {
-  return &batchedRequests;
+  return batchedRequests.push(request);
 }
 
 Api::~Api()
@@ -172,4 +340,6 @@ Api::~Api()
   context.shutdown();
   offRenderThread.join();
   delete commandServer;
+  delete batchCommandServer;
+  delete statePublisher;
 }
@@ -24,6 +24,7 @@
 using namespace std;
 
 std::shared_ptr<spdlog::logger> app_logger;
+shared_ptr<XRequestQueue> X11App::requests;
 
 X11App::X11App(X11App&& other) noexcept
   : display(other.display)
@@ -35,9 +36,19 @@ X11App::X11App(X11App&& other) noexcept
   , textureUnit(other.textureUnit)
   , textureId(other.textureId)
   , focused(other.focused.load())
+  , accessory(other.accessory)
   , x(other.x)
   , y(other.y)
   , appIndex(other.appIndex)
+  , pixmap(other.pixmap)
+  , glxPixmap(other.glxPixmap)
+  , damage(other.damage)
+  , damaged(other.damaged.load())
+  , damageCount(other.damageCount.load())
+  , lastSampleCount(other.lastSampleCount)
+  , lastSampleTime(other.lastSampleTime)
+  , updateRate(other.updateRate)
+  , requestState(other.requestState)
   , width(other.width)
   , height(other.height)
 {
@@ -52,6 +63,9 @@ X11App::X11App(X11App&& other) noexcept
   other.x = 0;
   other.y = 0;
   other.appIndex = 0;
+  other.pixmap = None;
+  other.glxPixmap = None;
+  other.damage = None;
   other.width = 0;
   other.height = 0;
 }
@@ -61,6 +75,7 @@ X11App::initAppClass(Display* display, int screen)
 {
   app_logger = make_shared<spdlog::logger>("app", fileSink);
   app_logger->set_level(spdlog::level::info);
+  requests = make_shared<XRequestQueue>(display);
   if (!gladLoadGLXLoader((GLADloadproc)glfwGetProcAddress, display, screen)) {
     std::cout << "Failed to initialize GLAD for GLX" << std::endl;
     app_logger->error("Failed to initialize GLAD for GLX");
@@ -346,6 +361,7 @@ X11App::fetchInfo(Identifier identifier)
   app_logger->info("XGetWindowAttributes()");
   app_logger->flush();
   XGetWindowAttributes(display, appWindow, &attrs);
+  accessory = attrs.override_redirect;
   fbConfigs = glXChooseFBConfig(display, 0, pixmap_config, &fbConfigCount);
 }
 
@@ -434,25 +450,26 @@ void
 X11App::unfocus(Window matrix)
 {
   focused = false;
-  XSelectInput(display, matrix, 0);
-  Window root = DefaultRootWindow(display);
-  KeyCode eKeyCode = XKeysymToKeycode(display, XK_e);
-  XUngrabKey(display, eKeyCode, AnyModifier, root);
-  KeyCode bKeyCode = XKeysymToKeycode(display, XK_b);
-  XUngrabKey(display, bKeyCode, AnyModifier, root);
-
-  XSetInputFocus(display, matrix, RevertToParent, CurrentTime);
-  XSync(display, False);
-  XFlush(display);
+  requests->request([matrix](Display* display) {
+    XSelectInput(display, matrix, 0);
+    Window root = DefaultRootWindow(display);
+    KeyCode eKeyCode = XKeysymToKeycode(display, XK_e);
+    XUngrabKey(display, eKeyCode, AnyModifier, root);
+    KeyCode bKeyCode = XKeysymToKeycode(display, XK_b);
+    XUngrabKey(display, bKeyCode, AnyModifier, root);
+
+    XSetInputFocus(display, matrix, RevertToParent, CurrentTime);
+  });
 }
 
 void
 X11App::takeInputFocus()
 {
-  XSetInputFocus(display, appWindow, RevertToParent, CurrentTime);
-  XRaiseWindow(display, appWindow);
-  XSync(display, False);
-  XFlush(display);
+  Window window = appWindow;
+  requests->request([window](Display* display) {
+    XSetInputFocus(display, window, RevertToParent, CurrentTime);
+    XRaiseWindow(display, window);
+  });
 }
 
 int isFocusedCount = 0;
@@ -467,44 +484,32 @@ void
 X11App::focus(Window matrix)
 {
   focused = true;
-  Window root = DefaultRootWindow(display);
+  Window window = appWindow;
 
   // Set _NET_SUPPORTING_WM_CHECK property on the root window
-  Atom net_supporting_wm_check =
-    XInternAtom(display, "_NET_SUPPORTING_WM_CHECK", False);
-  XChangeProperty(display,
-                  RootWindow(display, DefaultScreen(display)),
-                  net_supporting_wm_check,
-                  XA_WINDOW,
-                  32,
-                  PropModeReplace,
-                  (unsigned char*)&appWindow,
-                  1);
+  requests->request([window](Display* display) {
+    Atom net_supporting_wm_check =
+      XInternAtom(display, "_NET_SUPPORTING_WM_CHECK", False);
+    XChangeProperty(display,
+                    RootWindow(display, DefaultScreen(display)),
+                    net_supporting_wm_check,
+                    XA_WINDOW,
+                    32,
+                    PropModeReplace,
+                    (unsigned char*)&window,
+                    1);
+  });
 
   takeInputFocus();
 
-  KeyCode eKeyCode = XKeysymToKeycode(display, XK_e);
-  XGrabKey(
-    display, eKeyCode, Mod4Mask, root, true, GrabModeAsync, GrabModeAsync);
-
-  KeyCode bKeyCode = XKeysymToKeycode(display, XK_b);
-  XGrabKey(
-    display, bKeyCode, Mod4Mask, root, true, GrabModeAsync, GrabModeAsync);
-
-  KeyCode qKeyCode = XKeysymToKeycode(display, XK_q);
-  XGrabKey(
-    display, qKeyCode, Mod4Mask, root, true, GrabModeAsync, GrabModeAsync);
-
-  KeyCode equalKeyCode = XKeysymToKeycode(display, XK_equal);
-  XGrabKey(
-    display, equalKeyCode, Mod4Mask, root, true, GrabModeAsync, GrabModeAsync);
-
-  KeyCode minusKeyCode = XKeysymToKeycode(display, XK_minus);
-  XGrabKey(
-    display, minusKeyCode, Mod4Mask, root, true, GrabModeAsync, GrabModeAsync);
-
-  XSync(display, False);
-  XFlush(display);
+  requests->request([](Display* display) {
+    Window root = DefaultRootWindow(display);
+    for (auto key : { XK_e, XK_b, XK_q, XK_equal, XK_minus }) {
+      KeyCode keyCode = XKeysymToKeycode(display, key);
+      XGrabKey(
+        display, keyCode, Mod4Mask, root, true, GrabModeAsync, GrabModeAsync);
+    }
+  });
 }
 
 void
@@ -513,9 +518,11 @@ X11App::appTexture()
   glActiveTexture(textureUnit);
   glBindTexture(GL_TEXTURE_2D, textureId);
 
+  releaseTexture();
+
   app_logger->info("XCompositeNameWindowPixmap()");
   app_logger->flush();
-  Pixmap pixmap = XCompositeNameWindowPixmap(display, appWindow);
+  pixmap = XCompositeNameWindowPixmap(display, appWindow);
 
   const int pixmap_attribs[] = { GLX_TEXTURE_TARGET_EXT,
                                  GLX_TEXTURE_2D_EXT,
@@ -538,8 +545,7 @@ X11App::appTexture()
 
   app_logger->info("glXCreatePixmap()");
   app_logger->flush();
-  GLXPixmap glxPixmap =
-    glXCreatePixmap(display, fbConfigs[i], pixmap, pixmap_attribs);
+  glxPixmap = glXCreatePixmap(display, fbConfigs[i], pixmap, pixmap_attribs);
   app_logger->info("glXBindTexImageEXT()");
   app_logger->flush();
 
@@ -550,9 +556,98 @@ X11App::appTexture()
   if (error != GL_NO_ERROR) {
     throw "failed to bind tex image (bad pixmap)";
   }
+  damaged = false;
+  if (damage == None) {
+    trackDamage();
+  }
   app_logger->info("appTexture() success");
 }
 
+void
+X11App::releaseTexture()
+{
+  if (glxPixmap != None) {
+    glXReleaseTexImageEXT(display, glxPixmap, GLX_FRONT_LEFT_EXT);
+    glXDestroyPixmap(display, glxPixmap);
+    glxPixmap = None;
+  }
+  if (pixmap != None) {
+    XFreePixmap(display, pixmap);
+    pixmap = None;
+  }
+}
+
+// render thread, before the app is removed. The window may already be gone,
+// in which case the server has freed the damage and the error is only
+// logged.
+void
+X11App::release()
+{
+  releaseTexture();
+  if (damage != None) {
+    XDamageDestroy(display, damage);
+    damage = None;
+  }
+  XFlush(display);
+}
+
+void
+X11App::trackDamage()
+{
+  // NonEmpty sends one event until the damage is subtracted, so a window
+  // that redraws continuously costs one event per handled notify
+  damage = XDamageCreate(display, appWindow, XDamageReportNonEmpty);
+  lastSampleTime = chrono::steady_clock::now();
+  XFlush(display);
+}
+
+// called from the window manager's event thread
+void
+X11App::damageNotify()
+{
+  damaged = true;
+  damageCount++;
+}
+
+// called from the render thread, idle windows return without touching GL.
+// A resize that has landed needs the window's new pixmap.
+bool
+X11App::refreshTexture()
+{
+  if (glxPixmap == None) {
+    return false;
+  }
+  if (requestState->resized.exchange(false)) {
+    try {
+      appTexture();
+    } catch (...) {
+    }
+    return true;
+  }
+  if (!damaged.exchange(false)) {
+    return false;
+  }
+  glActiveTexture(textureUnit);
+  glBindTexture(GL_TEXTURE_2D, textureId);
+  glXReleaseTexImageEXT(display, glxPixmap, GLX_FRONT_LEFT_EXT);
+  glXBindTexImageEXT(display, glxPixmap, GLX_FRONT_LEFT_EXT, NULL);
+  return true;
+}
+
+double
+X11App::getUpdateRate()
+{
+  auto now = chrono::steady_clock::now();
+  chrono::duration<double> elapsed = now - lastSampleTime;
+  if (elapsed.count() >= 1.0) {
+    unsigned int count = damageCount;
+    updateRate = (count - lastSampleCount) / elapsed.count();
+    lastSampleCount = count;
+    lastSampleTime = now;
+  }
+  return updateRate;
+}
+
 void
 getAbsoluteMousePosition(Display* display, int* x_out, int* y_out)
 {
@@ -588,50 +683,8 @@ X11App::resizeMove(int width, int height, int x, int y)
   this->x = x;
   this->y = SCREEN_HEIGHT - y - height;
   if (!isAccessory()) {
-    XMoveResizeWindow(display, appWindow, x, y, width, height);
-    XFlush(display);
-  }
-}
-
-std::pair<int, int>
-getWindowPosition(Window window)
-{
-  std::stringstream ss;
-  ss << "0x" << std::hex << window;
-  std::string windowId = ss.str();
-
-  std::string command = "xwininfo -id " + windowId;
-  FILE* pipe = popen(command.c_str(), "r");
-  if (!pipe) {
-    std::cerr << "Failed to execute xwininfo command." << std::endl;
-    return std::make_pair(-1, -1);
-  }
-
-  char buffer[128];
-  std::string output;
-  while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-    output += buffer;
+    requests->moveResize(appWindow, x, y, width, height, requestState);
   }
-  pclose(pipe);
-
-  std::string searchString = "Absolute upper-left X:";
-  size_t pos = output.find(searchString);
-  if (pos != std::string::npos) {
-    pos += searchString.length();
-    int x = std::stoi(output.substr(pos));
-
-    searchString = "Absolute upper-left Y:";
-    pos = output.find(searchString);
-    if (pos != std::string::npos) {
-      pos += searchString.length();
-      int y = std::stoi(output.substr(pos));
-
-      return std::make_pair(x, y);
-    }
-  }
-
-  std::cerr << "Failed to parse xwininfo output." << std::endl;
-  return std::make_pair(-1, -1);
 }
 
 void
@@ -649,54 +702,28 @@ X11App::larger()
   resize(this->width + dSize, this->height + dSize);
 }
 
+// Nothing here waits on the server. The size last asked for stands in for
+// the window's, and the texture is rebound once the X thread has seen the
+// resize through. Accessories place themselves, where they went is looked
+// up on the X thread and picked up by getPosition.
 void
 X11App::resize(int width, int height)
 {
+  bool resized = this->width != width || this->height != height;
   this->width = width;
   this->height = height;
-  bool resized = false;
-  XWindowAttributes attributes;
-  XGetWindowAttributes(display, appWindow, &attributes);
-  if (attributes.width != width || attributes.height != height) {
-    resized = true;
-  }
   if (!isAccessory()) {
     x = (SCREEN_WIDTH - width) / 2;
     y = (SCREEN_HEIGHT - height) / 2;
-    if (attributes.x != x || attributes.y != y || attributes.width != width ||
-        attributes.height != height) {
-      XMoveResizeWindow(display, appWindow, x, y, width, height);
+    if (resized) {
+      requests->moveResize(appWindow, x, y, width, height, requestState);
     }
     heightScalar = recomputeHeightScaler(width, height);
   } else {
-    auto position = getWindowPosition(appWindow);
-    int newX;
-    int newY;
-    if (position.first != -1 && position.second != -1) {
-      newX = position.first;
-      newY = position.second;
-    } else {
-      newX = attributes.x;
-      newY = attributes.y;
-    }
-    int invertedY = SCREEN_HEIGHT - newY;
-    invertedY -= height;
-
-    if (newX != x || invertedY != y || attributes.width != width ||
-        attributes.height != height) {
-      x = newX;
-      y = invertedY;
-      // XMoveResizeWindow(display, appWindow, x,y, width, height);
-    }
-  }
-  if (resized) {
-    XFlush(display);
-    XSync(display, false);
-    if (textureId != -1) {
-      try {
-        appTexture();
-      } catch (...) {
-      }
+    requests->locate(appWindow, requestState);
+    // the server already has the size, it is what was configured
+    if (resized) {
+      requestState->resized = true;
     }
   }
 }
@@ -712,12 +739,16 @@ X11App::positionNotify(int x, int y)
 {
   this->x = x;
   this->y = y;
-  XMoveWindow(display, appWindow, x, y);
+  requests->move(appWindow, x, y);
 }
 
 array<int, 2>
 X11App::getPosition()
 {
+  if (requestState->located.exchange(false)) {
+    x = requestState->x;
+    y = SCREEN_HEIGHT - requestState->y - height;
+  }
   return { x, y };
 }
 
@@ -732,18 +763,7 @@ X11App::attachTexture(int textureUnit, int textureId, size_t appIndex)
 bool
 X11App::isAccessory()
 {
-  XWindowAttributes attrs;
-
-  glGetError();
-  XGetWindowAttributes(display, appWindow, &attrs);
-  GLenum error = glGetError();
-  if (error != GL_NO_ERROR) {
-    throw "XGetWindowAttributes failed";
-  }
-  if (attrs.override_redirect) {
-    return true;
-  }
-  return false;
+  return accessory;
 }
 
 int
@@ -82,96 +82,91 @@ void BootablePersister::createTablesIfNeeded() {
   db.exec(create.str());
 }
 void BootablePersister::saveAll() {
-    auto view = registry->view<Persistable, Bootable>();
-    SQLite::Database &db = registry->getDatabase();
-
-    stringstream queryStream;
-    queryStream << "INSERT OR REPLACE INTO " << entityName << " "
-                << "(entity_id, cmd, args, kill_on_exit, pid, "
-                << "transparent, width, height, name, boot_on_startup, x, y)"
-                << "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
-    SQLite::Statement query(db, queryStream.str());
-
-    db.exec("BEGIN TRANSACTION");
-    for (auto [entity, persist, bootable] : view.each()) {
-      query.bind(1, persist.entityId);
-      query.bind(2, bootable.cmd);
-      query.bind(3, bootable.args);
-      query.bind(4, bootable.killOnExit ? 1 : 0);
-      if(bootable.pid.has_value()) {
-        query.bind(5, bootable.pid.value());
-      } else {
-        query.bind(5, nullptr);
-      }
-      query.bind(6, bootable.transparent ? 1 : 0);
-      query.bind(7, bootable.width);
-      query.bind(8, bootable.height);
-      if (bootable.name.has_value()) {
-        query.bind(9, bootable.name.value());
-      } else {
-        query.bind(9, nullptr);
-      }
-      query.bind(10, bootable.bootOnStartup ? 1 : 0);
-      query.bind(11, bootable.x);
-      query.bind(12, bootable.y);
-      query.exec();
-      query.reset();
-    }
-    db.exec("COMMIT");
+  auto view = registry->view<Persistable, Bootable>();
+  for (auto entity : view) {
+    save(entity);
+  }
 }
 
-void BootablePersister::save(entt::entity){}
-void BootablePersister::loadAll() {
-  auto view = registry->view<Persistable>();
-  SQLite::Database &db = registry->getDatabase();
-
-  stringstream queryStream;
-  queryStream << "SELECT entity_id, cmd, args, kill_on_exit, pid ,"
-              << "transparent, width, height, name, boot_on_startup, x, y "
-              << "FROM " << entityName;
-  SQLite::Statement query(db, queryStream.str());
-
-  while(query.executeStep()) {
-    auto entityId = query.getColumn(0).getInt();
-    auto cmd = query.getColumn(1).getText();
-    auto args = query.getColumn(2).getText();
-    bool killOnExit = query.getColumn(3).getInt() == 0 ? false : true;
-    optional<int> pid;
-    if(query.isColumnNull(4)) {
-      pid = nullopt;
-    } else {
-      pid = query.getColumn(4).getInt();
-    }
-    bool transparent = query.getColumn(5).getInt() == 0 ? false : true;
-    auto width = query.getColumn(6).getInt();
-    auto height = query.getColumn(7).getInt();
-    optional<std::string> name;
-    if(query.isColumnNull(8)) {
-      name = nullopt;
-    } else {
-      name = query.getColumn(8).getText();
-    }
-    bool bootOnStartup = query.getColumn(9).getInt() == 0 ? false : true;
-    optional<int> x, y;
-    if(query.isColumnNull(10)) {
-      x = nullopt;
+void BootablePersister::save(entt::entity entity) {
+  if (!registry->all_of<Persistable, Bootable>(entity)) {
+    return;
+  }
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  Bootable bootable = registry->get<Bootable>(entity);
+  stage(entityId, [entityId, bootable](WriteBehind::Connection &connection) {
+    auto &query = connection.statement(
+        "INSERT OR REPLACE INTO Bootable "
+        "(entity_id, cmd, args, kill_on_exit, pid, "
+        "transparent, width, height, name, boot_on_startup, x, y) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.bind(1, entityId);
+    query.bind(2, bootable.cmd);
+    query.bind(3, bootable.args);
+    query.bind(4, bootable.killOnExit ? 1 : 0);
+    if (bootable.pid.has_value()) {
+      query.bind(5, bootable.pid.value());
     } else {
-      x = query.getColumn(10).getInt();
+      query.bind(5, nullptr);
     }
-    if(query.isColumnNull(11)) {
-      y = nullopt;
+    query.bind(6, bootable.transparent ? 1 : 0);
+    query.bind(7, bootable.width);
+    query.bind(8, bootable.height);
+    if (bootable.name.has_value()) {
+      query.bind(9, bootable.name.value());
     } else {
-      y = query.getColumn(11).getInt();
+      query.bind(9, nullptr);
     }
-    auto entity = registry->locateEntity(entityId);
+    query.bind(10, bootable.bootOnStartup ? 1 : 0);
+    query.bind(11, bootable.x);
+    query.bind(12, bootable.y);
+    query.exec();
+  });
+}
 
-    if(entity.has_value()) {
-      registry->emplace<Bootable>(entity.value(), cmd, args, killOnExit,
-                                  pid, transparent, name, bootOnStartup,
-                                  width, height, x, y);
-    }
+std::string BootablePersister::selectAllQuery() {
+  return "SELECT entity_id, cmd, args, kill_on_exit, pid, "
+         "transparent, width, height, name, boot_on_startup, x, y "
+         "FROM Bootable ORDER BY entity_id";
+}
+
+void BootablePersister::loadRow(entt::entity entity,
+                                SQLite::Statement &query) {
+  auto cmd = query.getColumn(1).getText();
+  auto args = query.getColumn(2).getText();
+  bool killOnExit = query.getColumn(3).getInt() == 0 ? false : true;
+  optional<int> pid;
+  if(query.isColumnNull(4)) {
+    pid = nullopt;
+  } else {
+    pid = query.getColumn(4).getInt();
+  }
+  bool transparent = query.getColumn(5).getInt() == 0 ? false : true;
+  auto width = query.getColumn(6).getInt();
+  auto height = query.getColumn(7).getInt();
+  optional<std::string> name;
+  if(query.isColumnNull(8)) {
+    name = nullopt;
+  } else {
+    name = query.getColumn(8).getText();
   }
+  bool bootOnStartup = query.getColumn(9).getInt() == 0 ? false : true;
+  optional<int> x, y;
+  if(query.isColumnNull(10)) {
+    x = nullopt;
+  } else {
+    x = query.getColumn(10).getInt();
+  }
+  if(query.isColumnNull(11)) {
+    y = nullopt;
+  } else {
+    y = query.getColumn(11).getInt();
+  }
+  registry->emplace<Bootable>(entity, cmd, args, killOnExit,
+                              pid, transparent, name, bootOnStartup,
+                              width, height, x, y);
 }
+
 void BootablePersister::load(entt::entity){}
 void BootablePersister::depersistIfGone(entt::entity entity) {
   depersistIfGoneTyped<Bootable>(entity);
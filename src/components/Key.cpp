@@ -31,12 +31,14 @@ void KeyPersister::createTablesIfNeeded() {
          <<"FOREIGN KEY (unturn_movement_id) REFERENCES RotateMovement(id) "
          <<")";
   db.exec(create.str());
+  db.exec("CREATE INDEX IF NOT EXISTS KeyEntity ON Key (entity_id)");
 }
 
-void updateKey(SQLite::Database &db, int entityId,  TurnState state, int lockable) {
-  SQLite::Statement updateKey(db, "UPDATE Key SET "
-                                   "state = ?, lockable_id = ? "
-                                   "WHERE entity_id = ?");
+void updateKey(WriteBehind::Connection &connection, int64_t entityId,
+               TurnState state, int lockable) {
+  auto &updateKey = connection.statement("UPDATE Key SET "
+                                         "state = ?, lockable_id = ? "
+                                         "WHERE entity_id = ?");
 
   updateKey.bind(1, (int)state);
   updateKey.bind(2, lockable);
@@ -45,107 +47,109 @@ void updateKey(SQLite::Database &db, int entityId,  TurnState state, int lockabl
   updateKey.exec();
 }
 
-void insertKey(SQLite::Database &db, int entityId,
+void insertKey(WriteBehind::Connection &connection, int64_t entityId,
                int turnMovementId, int unturnMovementId,
                TurnState state, int lockableId) {
-  std::stringstream insertKeyQuery;
-  insertKeyQuery << "INSERT INTO Key (entity_id, turn_movement_id, "
-                     "unturn_movement_id, state, lockable_id) "
-                  << "VALUES (?, ?, ?, ?, ?)";
-  SQLite::Statement insertKeyStmt(db, insertKeyQuery.str());
+  auto &insertKeyStmt =
+      connection.statement("INSERT INTO Key (entity_id, turn_movement_id, "
+                           "unturn_movement_id, state, lockable_id) "
+                           "VALUES (?, ?, ?, ?, ?)");
 
   insertKeyStmt.bind(1, entityId);
   insertKeyStmt.bind(2, turnMovementId);
   insertKeyStmt.bind(3, unturnMovementId);
   insertKeyStmt.bind(4, static_cast<int>(state));
-  // what is static_cast again?
   insertKeyStmt.bind(5, lockableId);
 
   insertKeyStmt.exec();
 }
 
 void KeyPersister::saveAll() {
-    auto view = registry->view<Persistable, Key>();
-    SQLite::Database &db = registry->getDatabase();
-
-    db.exec("BEGIN TRANSACTION");
-    for (auto [entity, persist, key] : view.each()) {
-      SQLite::Statement checkKey(db, "SELECT id, turn_movement_id, unturn_movement_id FROM Key WHERE entity_id = ?");
-      checkKey.bind(1, persist.entityId);
-
-      if (checkKey.executeStep()) {
-        int turnMovementId = checkKey.getColumn(1).getInt();
-        int unturnMovementId = checkKey.getColumn(2).getInt();
-
-        updateMovement(db, turnMovementId, key.turnMovement);
-        updateMovement(db, unturnMovementId, key.unturnMovement);
-
-        updateKey(db, persist.entityId, key.state, key.lockable);
-      } else {
-        int openMovementId = insertMovement(db, key.turnMovement);
-        int closeMovementId = insertMovement(db, key.unturnMovement);
-        insertKey(db, persist.entityId, openMovementId, closeMovementId,
-                  key.state, key.lockable);
-      }
-    }
-    db.exec("COMMIT");
+  auto view = registry->view<Persistable, Key>();
+  for (auto entity : view) {
+    save(entity);
+  }
 };
-void KeyPersister::save(entt::entity){};
-
-void KeyPersister::loadAll() {
-    auto view = registry->view<Persistable>();
-    SQLite::Database& db = registry->getDatabase();
-
-    // Cache query data
-    std::unordered_map<int, Key> keyDataCache;
-
-    // Prepare the query
-    SQLite::Statement query(db, "SELECT entity_id, turn_movement_id, unturn_movement_id, state, lockable_id FROM Key");
-
-    // Fetch results from the database
-    while (query.executeStep()) {
-        int entityId = query.getColumn(0).getInt();
-        int turnMovementId = query.getColumn(1).getInt();
-        int unturnMovementId = query.getColumn(2).getInt();
-        TurnState state = static_cast<TurnState>(query.getColumn(3).getInt());
-        int lockableId = query.getColumn(4).getInt();
-
-        auto turnMovement = getMovementData(db, turnMovementId);
-        auto unturnMovement = getMovementData(db, unturnMovementId);
-        auto pair = std::pair(entityId, Key{lockableId, state, turnMovement, unturnMovement});
-        keyDataCache.insert(pair);
+void KeyPersister::save(entt::entity entity) {
+  if (!registry->all_of<Persistable, Key>(entity)) {
+    return;
+  }
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  Key key = registry->get<Key>(entity);
+  stage(entityId, [entityId, key](WriteBehind::Connection &connection) {
+    auto &checkKey = connection.statement(
+        "SELECT id, turn_movement_id, unturn_movement_id FROM Key "
+        "WHERE entity_id = ?");
+    checkKey.bind(1, entityId);
+
+    if (checkKey.executeStep()) {
+      int turnMovementId = checkKey.getColumn(1).getInt();
+      int unturnMovementId = checkKey.getColumn(2).getInt();
+      checkKey.reset();
+
+      updateMovement(connection, turnMovementId, key.turnMovement);
+      updateMovement(connection, unturnMovementId, key.unturnMovement);
+
+      updateKey(connection, entityId, key.state, key.lockable);
+    } else {
+      int turnMovementId = insertMovement(connection, key.turnMovement);
+      int unturnMovementId = insertMovement(connection, key.unturnMovement);
+      insertKey(connection, entityId, turnMovementId, unturnMovementId,
+                key.state, key.lockable);
     }
+  });
+};
 
-    for (auto [entity, persist] : view.each()) {
-        auto it = keyDataCache.find(persist.entityId);
-        if (it != keyDataCache.end()) {
-          auto& [lockable, state, turnMovement, unturnMovement] = it->second;
-          registry->emplace<Key>(entity, lockable, state, turnMovement, unturnMovement);
-        }
-    }
+// both movements are joined in so loading doesn't go back to the database
+// for every key. Left joined, so a key whose movement row is gone still
+// loads.
+std::string KeyPersister::selectAllQuery() {
+  return "SELECT k.entity_id, k.lockable_id, k.state, "
+         "t.axis_x, t.axis_y, t.axis_z, t.degrees, t.degrees_per_second, "
+         "u.axis_x, u.axis_y, u.axis_z, u.degrees, u.degrees_per_second "
+         "FROM Key k "
+         "LEFT JOIN RotateMovement t ON t.id = k.turn_movement_id "
+         "LEFT JOIN RotateMovement u ON u.id = k.unturn_movement_id "
+         "ORDER BY k.entity_id";
+}
+
+void KeyPersister::loadRow(entt::entity entity, SQLite::Statement &query) {
+  int lockableId = query.getColumn(1).getInt();
+  TurnState state = static_cast<TurnState>(query.getColumn(2).getInt());
+  auto turnMovement = movementFromColumns(query, 3);
+  auto unturnMovement = movementFromColumns(query, 8);
+  registry->emplace<Key>(entity, lockableId, state, turnMovement,
+                         unturnMovement);
 }
 void KeyPersister::load(entt::entity){};
 
 void KeyPersister::depersistIfGone(entt::entity entity) {
-  auto persistable = registry->get<Persistable>(entity);
-  auto &db = registry->getDatabase();
-  try {
-    SQLite::Statement query(db, "SELECT open_movement_id, close_movement_id "
-                                "FROM Door where entity_id = ?");
-    query.bind(1, persistable.entityId);
-    query.executeStep();
+  if (registry->any_of<Key>(entity)) {
+    return;
+  }
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  stage(entityId, [this, entityId](WriteBehind::Connection &connection) {
+    auto &query = connection.statement(
+        "SELECT turn_movement_id, unturn_movement_id "
+        "FROM Key where entity_id = ?");
+    query.bind(1, entityId);
+    if (!query.executeStep()) {
+      return;
+    }
     int64_t turn_movement_id = query.getColumn(0).getInt64();
     int64_t unturn_movment_id = query.getColumn(1).getInt64();
+    query.reset();
 
-    SQLite::Statement deleteQuery(db,
-                                  "DELETE FROM RotateMovement WHERE id = ?");
+    auto &deleteQuery = connection.statement(
+        "DELETE FROM RotateMovement WHERE id = ?");
     deleteQuery.bind(1, turn_movement_id);
     deleteQuery.exec();
     deleteQuery.reset();
     deleteQuery.bind(1, unturn_movment_id);
     deleteQuery.exec();
 
-    depersistIfGoneTyped<KeyPersister>(entity);
-  } catch (...) {
-  }
+    auto &deleteKey = connection.statement(this->deleteQuery);
+    deleteKey.bind(1, entityId);
+    deleteKey.exec();
+  });
 }
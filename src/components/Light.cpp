@@ -83,89 +83,50 @@ void LightPersister::createTablesIfNeeded() {
   db.exec(createTableStream.str());
 }
 
-void LightPersister::loadAll() {
-  auto view = registry->view<Persistable>();
-  SQLite::Database &db = registry->getDatabase();
-
-  // Cache query data
-  std::unordered_map<int, glm::vec3> lightDataCache;
-  std::stringstream queryStream;
-  queryStream << "SELECT entity_id, color_r, color_g, color_b FROM " << entityName;
-  SQLite::Statement query(db, queryStream.str());
-
-  while (query.executeStep()) {
-    int entityId = query.getColumn(0).getInt();
-    float r = query.getColumn(1).getDouble();
-    float g = query.getColumn(2).getDouble();
-    float b = query.getColumn(3).getDouble();
-
-    lightDataCache[entityId] = glm::vec3(r, g, b);
-  }
+std::string LightPersister::selectAllQuery() {
+  return "SELECT entity_id, color_r, color_g, color_b FROM Light "
+         "ORDER BY entity_id";
+}
 
-  // Iterate and emplace
-  view.each([&lightDataCache, this](auto entity, auto &persistable) {
-    auto it = lightDataCache.find(persistable.entityId);
-    if (it != lightDataCache.end()) {
-      auto &color = it->second;
-      registry->emplace<Light>(entity, color);
-    }
-  });
+void LightPersister::loadRow(entt::entity entity, SQLite::Statement &query) {
+  float r = query.getColumn(1).getDouble();
+  float g = query.getColumn(2).getDouble();
+  float b = query.getColumn(3).getDouble();
+  registry->emplace<Light>(entity, glm::vec3(r, g, b));
 }
 
 void LightPersister::saveAll() {
   auto view = registry->view<Persistable, Light>();
-  SQLite::Database &db = registry->getDatabase();
-  std::stringstream queryStream;
-  queryStream << "INSERT OR REPLACE INTO " << entityName
-              << " (entity_id, color_r, color_g, color_b) VALUES (?, ?, ?, ?)";
-  SQLite::Statement query(db, queryStream.str());
-
-  db.exec("BEGIN TRANSACTION");
-
-  for (auto [entity, persist, light] : view.each()) {
-    query.bind(1, persist.entityId);
-    query.bind(2, light.color.x);
-    query.bind(3, light.color.y);
-    query.bind(4, light.color.z);
-    query.exec();
-    query.reset();
+  for (auto entity : view) {
+    save(entity);
   }
-
-  db.exec("COMMIT");
 }
 
 void LightPersister::save(entt::entity entity) {
-  auto &light = registry->get<Light>(entity);
-  auto &persistable = registry->get<Persistable>(entity);
-  SQLite::Database &db = registry->getDatabase();
-
-  std::stringstream queryStream;
-  queryStream << "INSERT OR REPLACE INTO " << entityName
-             << " (entity_id, color_r, color_g, color_b) VALUES (?, ?, ?, ?)";
-  SQLite::Statement query(db, queryStream.str());
-  query.bind(1, persistable.entityId);
-  query.bind(2, light.color.x);
-  query.bind(3, light.color.y);
-  query.bind(4, light.color.z);
-  query.exec();
+  if (!registry->all_of<Persistable, Light>(entity)) {
+    return;
+  }
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  glm::vec3 color = registry->get<Light>(entity).color;
+  stage(entityId, [entityId, color](WriteBehind::Connection &connection) {
+    auto &query = connection.statement(
+        "INSERT OR REPLACE INTO Light (entity_id, color_r, color_g, color_b) "
+        "VALUES (?, ?, ?, ?)");
+    query.bind(1, entityId);
+    query.bind(2, color.x);
+    query.bind(3, color.y);
+    query.bind(4, color.z);
+    query.exec();
+  });
 }
 
 void LightPersister::load(entt::entity entity) {
-  auto &persistable = registry->get<Persistable>(entity);
-  SQLite::Database &db = registry->getDatabase();
-
-  std::stringstream queryStream;
-  queryStream << "INSERT OR REPLACE INTO " << entityName
-              << " (entity_id, color_r, color_g, color_b) VALUES (?, ?, ?, ?)";
-  SQLite::Statement query(db, queryStream.str());
-  query.bind(1, persistable.entityId);
-
+  auto &query = registry->statement(
+      "SELECT entity_id, color_r, color_g, color_b FROM Light "
+      "WHERE entity_id = ?");
+  query.bind(1, registry->get<Persistable>(entity).entityId);
   if (query.executeStep()) {
-    float r = query.getColumn(0).getDouble();
-    float g = query.getColumn(1).getDouble();
-    float b = query.getColumn(2).getDouble();
-
-    registry->emplace<Light>(entity, glm::vec3(r, g, b));
+    loadRow(entity, query);
   }
 }
 
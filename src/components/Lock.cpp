@@ -14,22 +14,23 @@ void LockPersister::createTablesIfNeeded() {
   db.exec(create.str());
 }
 void LockPersister::saveAll() {
-   auto view = registry->view<Persistable, Lock>();
-
-  SQLite::Database &db = registry->getDatabase(); // Get database reference
-
-  std::stringstream queryStream;
-  queryStream << "INSERT OR REPLACE INTO " << entityName
-              << " (entity_id, position_x, position_y, position_z, "
-              << "tolerance_x, tolerance_y, tolerance_z, "
-              << "state)"
-              << " VALUES (?, ?, ?, ?, ?, ?, ?, ?)";
-    SQLite::Statement query(db, queryStream.str());
-  // Use a transaction for efficiency
-  db.exec("BEGIN TRANSACTION");
-
-  for (auto [entity, persist, lock] : view.each()) {
-    query.bind(1, persist.entityId);
+  auto view = registry->view<Persistable, Lock>();
+  for (auto entity : view) {
+    save(entity);
+  }
+};
+void LockPersister::save(entt::entity entity) {
+  if (!registry->all_of<Persistable, Lock>(entity)) {
+    return;
+  }
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  Lock lock = registry->get<Lock>(entity);
+  stage(entityId, [entityId, lock](WriteBehind::Connection &connection) {
+    auto &query = connection.statement(
+        "INSERT OR REPLACE INTO Lock (entity_id, position_x, position_y, "
+        "position_z, tolerance_x, tolerance_y, tolerance_z, state) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    query.bind(1, entityId);
     query.bind(2, lock.position.x);
     query.bind(3, lock.position.y);
     query.bind(4, lock.position.z);
@@ -38,48 +39,25 @@ void LockPersister::saveAll() {
     query.bind(7, lock.tolerance.z);
     query.bind(8, lock.state);
     query.exec();
-    query.reset();
-  }
-  db.exec("COMMIT");
+  });
 };
-void LockPersister::save(entt::entity){};
-void LockPersister::loadAll() {
-    auto view = registry->view<Persistable>();
-    SQLite::Database& db = registry->getDatabase();
-
-    // Cache query data
-    std::unordered_map<int, Lock> positionDataCache;
-
-    std::stringstream queryStream;
-    queryStream << "SELECT entity_id, position_x, position_y, position_z, "
-                << "tolerance_x, tolerance_y, tolerance_z, "
-                << "state FROM "
-                << entityName;
-    SQLite::Statement query(db, queryStream.str());
-    while (query.executeStep()) {
-      int dbId = query.getColumn(0).getInt();
-      float x = query.getColumn(1).getDouble();
-      float y = query.getColumn(2).getDouble();
-      float z = query.getColumn(3).getDouble();
-      float toleranceX = query.getColumn(4).getDouble();
-      float toleranceY = query.getColumn(5).getDouble();
-      float toleranceZ = query.getColumn(6).getDouble();
-      float state = query.getColumn(7).getInt();
-
-      Lock l = {glm::vec3(x,y,z),
-        glm::vec3(toleranceX, toleranceY, toleranceZ),
-        LockState(state)};
-      positionDataCache[dbId] = l;
-    }
+std::string LockPersister::selectAllQuery() {
+  return "SELECT entity_id, position_x, position_y, position_z, "
+         "tolerance_x, tolerance_y, tolerance_z, state FROM Lock "
+         "ORDER BY entity_id";
+}
+void LockPersister::loadRow(entt::entity entity, SQLite::Statement &query) {
+  float x = query.getColumn(1).getDouble();
+  float y = query.getColumn(2).getDouble();
+  float z = query.getColumn(3).getDouble();
+  float toleranceX = query.getColumn(4).getDouble();
+  float toleranceY = query.getColumn(5).getDouble();
+  float toleranceZ = query.getColumn(6).getDouble();
+  int state = query.getColumn(7).getInt();
 
-    // Iterate and emplace
-    for(auto [entity, persistable]: view.each()) {
-        auto it = positionDataCache.find(persistable.entityId);
-        if (it != positionDataCache.end()) {
-          auto& [position, tolerance, state] = it->second;
-          registry->emplace<Lock>(entity, position, tolerance, state);
-        }
-    }
+  registry->emplace<Lock>(entity, glm::vec3(x, y, z),
+                          glm::vec3(toleranceX, toleranceY, toleranceZ),
+                          LockState(state));
 }
 void LockPersister::load(entt::entity){};
 void LockPersister::depersistIfGone(entt::entity entity) {
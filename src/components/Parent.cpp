@@ -2,6 +2,20 @@
 #include "SQLiteCpp/Statement.h"
 #include <sstream>
 
+const std::vector<entt::entity> &Parent::children(EntityRegistry &registry) {
+  if (resolvedAt != registry.getLocatorGeneration()) {
+    childEntities.clear();
+    for (auto childId : childrenIds) {
+      auto child = registry.locateEntity(childId);
+      if (child.has_value()) {
+        childEntities.push_back(child.value());
+      }
+    }
+    resolvedAt = registry.getLocatorGeneration();
+  }
+  return childEntities;
+}
+
 void ParentPersister::createTablesIfNeeded() {
   std::stringstream createQueryStream;
   createQueryStream << "CREATE TABLE IF NOT EXISTS " << entityName << "( "
@@ -17,55 +31,41 @@ void ParentPersister::createTablesIfNeeded() {
 }
 
 void ParentPersister::saveAll() {
-  auto &db = registry->getDatabase();
-  auto parentView = registry->view<Persistable, Parent>();
-
-  std::stringstream insertQueryStream;
-  insertQueryStream << "INSERT OR REPLACE INTO "
-                    << entityName << " "
-                    << "(entity_id, child_id) "
-                    << "VALUES (?, ?)";
-
-  SQLite::Statement query(db, insertQueryStream.str());
-
-  db.exec("BEGIN TRANSACTION");
-  for(auto [entity, persistable, parent]: parentView.each()) {
-    for(auto childId: parent.childrenIds) {
-      query.bind(1, persistable.entityId);
-      query.bind(2, childId);
-      query.exec();
-      query.reset();
-    }
+  auto view = registry->view<Persistable, Parent>();
+  for (auto entity : view) {
+    save(entity);
   }
-  db.exec("COMMIT");
 }
 
-void ParentPersister::save(entt::entity){}
-void ParentPersister::loadAll() {
-  auto &db = registry->getDatabase();
-
-  std::unordered_map<int, std::vector<int>> parentCache;
-
-  std::stringstream queryStream;
-  queryStream << "SELECT entity_id, child_id FROM " << entityName;
-  SQLite::Statement query(db, queryStream.str());
-  while(query.executeStep()) {
-    int entityId = query.getColumn(0).getInt();
-    int childId = query.getColumn(1).getInt();
-    if(!parentCache.contains(entityId)) {
-      parentCache[entityId] = std::vector<int>();
-    }
-    parentCache[entityId].push_back(childId);
+// one write per parent replaces its whole set of child rows
+void ParentPersister::save(entt::entity entity) {
+  if (!registry->all_of<Persistable, Parent>(entity)) {
+    return;
   }
-
-  auto view = registry->view<Persistable>();
-  for(auto [entity, persistable]: view.each()) {
-    if(parentCache.contains(persistable.entityId)) {
-      registry->emplace<Parent>(entity, parentCache[persistable.entityId]);
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  std::vector<int> childrenIds = registry->get<Parent>(entity).childrenIds;
+  stage(entityId, [this, entityId, childrenIds](WriteBehind::Connection &connection) {
+    auto &clear = connection.statement(deleteQuery);
+    clear.bind(1, entityId);
+    clear.exec();
+    auto &insert = connection.statement(
+        "INSERT OR REPLACE INTO Parent (entity_id, child_id) VALUES (?, ?)");
+    for (auto childId : childrenIds) {
+      insert.bind(1, entityId);
+      insert.bind(2, childId);
+      insert.exec();
+      insert.reset();
     }
-  }
+  });
+}
+std::string ParentPersister::selectAllQuery() {
+  return "SELECT entity_id, child_id FROM Parent ORDER BY entity_id, id";
+}
+void ParentPersister::loadRow(entt::entity entity, SQLite::Statement &query) {
+  int childId = query.getColumn(1).getInt();
+  registry->get_or_emplace<Parent>(entity).childrenIds.push_back(childId);
 }
 void ParentPersister::load(entt::entity){}
 void ParentPersister::depersistIfGone(entt::entity entity) {
-  depersistIfGoneTyped<ParentPersister>(entity);
+  depersistIfGoneTyped<Parent>(entity);
 }
@@ -0,0 +1,171 @@
+#include "components/Positionable.h"
+#include "TransformKernel.h"
+#include "persister.h"
+#include <glm/gtc/quaternion.hpp>
+#include <sstream>
+
+using namespace std;
+
+glm::mat4
+Positionable::transform()
+{
+  glm::mat4 matrix;
+  glm::mat3 normal;
+  transformKernel::compose(pos, origin, rotate, scale, matrix, normal);
+  return matrix;
+}
+
+// the normal matrix comes from the rotation and scale directly, see
+// TransformKernel.h
+void
+Positionable::update()
+{
+  transformKernel::compose(
+    pos, origin, rotate, scale, modelMatrix, normalMatrix);
+  damaged = false;
+}
+
+// transform() maps x to pos + R * (scale * x - origin), so scale is the
+// length of any column, R is what's left after dividing it out and pos is
+// where origin / scale lands
+void
+Positionable::follow(const glm::mat4& world, const glm::mat3& normal)
+{
+  modelMatrix = world;
+  normalMatrix = normal;
+  glm::mat3 linear = glm::mat3(world);
+  float worldScale = glm::length(linear[0]);
+  if (worldScale > 0) {
+    scale = worldScale;
+    rotate = glm::degrees(glm::eulerAngles(glm::quat_cast(linear / scale)));
+    pos = glm::vec3(world * glm::vec4(origin / scale, 1.0f));
+  }
+  damaged = false;
+}
+
+void
+Positionable::damage()
+{
+  damaged = true;
+}
+
+Positionable::Positionable(glm::vec3 pos,
+                           glm::vec3 origin,
+                           glm::vec3 rotate,
+                           float scale)
+  : pos(pos)
+  , origin(origin)
+  , scale(scale)
+  , rotate(rotate)
+{
+  // the matrices always hold the last place the entity was put, so a
+  // parent's can be measured against before its first update
+  transformKernel::compose(
+    pos, origin, rotate, scale, modelMatrix, normalMatrix);
+}
+
+Positionable::Positionable(Positionable* p)
+  : Positionable(p->pos, p->origin, p->rotate, p->scale)
+{
+}
+
+void
+PositionablePersister::createTablesIfNeeded()
+{
+  stringstream queryStream;
+  queryStream << "CREATE TABLE IF NOT EXISTS " << entityName << " ("
+              << "entity_id INTEGER PRIMARY KEY, "
+              << "pos_x REAL, pos_y REAL, pos_z REAL, "
+              << "origin_x REAL, origin_y REAL, origin_z REAL, scale REAL, "
+              << "rot_x REAL, rot_y REAL, rot_z REAL, "
+              << "FOREIGN KEY(entity_id) REFERENCES Entity(id))";
+  registry->getDatabase().exec(queryStream.str());
+}
+
+void
+PositionablePersister::save(entt::entity entity)
+{
+  if (!registry->all_of<Persistable, Positionable>(entity)) {
+    return;
+  }
+  auto& pos = registry->get<Positionable>(entity);
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  glm::vec3 p = pos.pos;
+  glm::vec3 origin = pos.origin;
+  glm::vec3 rotate = pos.rotate;
+  float scale = pos.scale;
+  stage(entityId, [=](WriteBehind::Connection& connection) {
+    auto& query = connection.statement(
+      "INSERT OR REPLACE INTO Positionable (entity_id, pos_x, pos_y, pos_z, "
+      "origin_x, origin_y, origin_z, rot_x, rot_y, rot_z, scale) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.bind(1, entityId);
+    query.bind(2, p.x);
+    query.bind(3, p.y);
+    query.bind(4, p.z);
+    query.bind(5, origin.x);
+    query.bind(6, origin.y);
+    query.bind(7, origin.z);
+    query.bind(8, rotate.x);
+    query.bind(9, rotate.y);
+    query.bind(10, rotate.z);
+    query.bind(11, scale);
+    query.exec();
+  });
+}
+
+void
+PositionablePersister::saveAll()
+{
+  auto view = registry->view<Persistable, Positionable>();
+  for (auto entity : view) {
+    save(entity);
+  }
+}
+
+void
+PositionablePersister::load(entt::entity entity)
+{
+  auto& query = registry->statement(
+    "SELECT entity_id, pos_x, pos_y, pos_z, origin_x, origin_y, origin_z, "
+    "rot_x, rot_y, rot_z, scale FROM Positionable WHERE entity_id = ?");
+  query.bind(1, registry->get<Persistable>(entity).entityId);
+  if (query.executeStep()) {
+    loadRow(entity, query);
+  }
+}
+
+std::string
+PositionablePersister::selectAllQuery()
+{
+  return "SELECT entity_id, pos_x, pos_y, pos_z, origin_x, origin_y, "
+         "origin_z, rot_x, rot_y, rot_z, scale FROM Positionable "
+         "ORDER BY entity_id";
+}
+
+void
+PositionablePersister::loadRow(entt::entity entity, SQLite::Statement& query)
+{
+  float x = query.getColumn(1).getDouble();
+  float y = query.getColumn(2).getDouble();
+  float z = query.getColumn(3).getDouble();
+  float originX = query.getColumn(4).getDouble();
+  float originY = query.getColumn(5).getDouble();
+  float originZ = query.getColumn(6).getDouble();
+  float rotx = query.getColumn(7).getDouble();
+  float roty = query.getColumn(8).getDouble();
+  float rotz = query.getColumn(9).getDouble();
+  float scale = query.getColumn(10).getDouble();
+
+  registry->emplace<Positionable>(entity,
+                                  glm::vec3(x, y, z),
+                                  glm::vec3(originX, originY, originZ),
+                                  glm::vec3(rotx, roty, rotz),
+                                  scale);
+}
+
+void
+PositionablePersister::depersistIfGone(entt::entity entity)
+{
+  depersistIfGoneTyped<Positionable>(entity);
+}
@@ -1,9 +1,8 @@
 #include "components/RotateMovement.h"
 
-void updateMovement(SQLite::Database &db, int movementId,
+void updateMovement(WriteBehind::Connection &connection, int movementId,
                     const RotateMovement &movement) {
-  SQLite::Statement updateMovementStmt(
-      db,
+  auto &updateMovementStmt = connection.statement(
       "UPDATE RotateMovement SET "
       "axis_x = ?, axis_y = ?, axis_z = ?, degrees = ?, degrees_per_second = ?"
       "WHERE id = ?");
@@ -17,12 +16,12 @@ void updateMovement(SQLite::Database &db, int movementId,
   updateMovementStmt.exec();
 }
 
-int insertMovement(SQLite::Database &db, const RotateMovement &movement) {
-  std::stringstream insertMovementQuery;
-  insertMovementQuery << "INSERT INTO RotateMovement (axis_x, axis_y, axis_z, "
-                         "degrees, degrees_per_second) "
-                      << "VALUES (?, ?, ?, ?, ?)";
-  SQLite::Statement insertMovementStmt(db, insertMovementQuery.str());
+int insertMovement(WriteBehind::Connection &connection,
+                   const RotateMovement &movement) {
+  auto &insertMovementStmt = connection.statement(
+      "INSERT INTO RotateMovement (axis_x, axis_y, axis_z, "
+      "degrees, degrees_per_second) "
+      "VALUES (?, ?, ?, ?, ?)");
 
   insertMovementStmt.bind(1, movement.axis.x);
   insertMovementStmt.bind(2, movement.axis.y);
@@ -31,10 +30,23 @@ int insertMovement(SQLite::Database &db, const RotateMovement &movement) {
   insertMovementStmt.bind(5, movement.degreesPerSecond);
   insertMovementStmt.exec();
 
-  int movementId = db.getLastInsertRowid();
+  int movementId = connection.getDatabase().getLastInsertRowid();
   return movementId;
 }
 
+RotateMovement movementFromColumns(SQLite::Statement &query, int first) {
+  if (query.getColumn(first).isNull()) {
+    return RotateMovement(0, 0, glm::vec3(0, 1, 0));
+  }
+  double axisX = query.getColumn(first).getDouble();
+  double axisY = query.getColumn(first + 1).getDouble();
+  double axisZ = query.getColumn(first + 2).getDouble();
+  double degrees = query.getColumn(first + 3).getDouble();
+  double degreesPerSecond = query.getColumn(first + 4).getDouble();
+  return RotateMovement(degrees, degreesPerSecond,
+                        glm::vec3(axisX, axisY, axisZ));
+}
+
 RotateMovement getMovementData(SQLite::Database &db, int movementId) {
   // Prepare query
   SQLite::Statement query(
@@ -43,15 +55,7 @@ RotateMovement getMovementData(SQLite::Database &db, int movementId) {
   query.bind(1, movementId);
 
   if (query.executeStep()) {
-    // Extract data and construct RotateMovement object
-    double axisX = query.getColumn(0).getDouble();
-    double axisY = query.getColumn(1).getDouble();
-    double axisZ = query.getColumn(2).getDouble();
-    double degrees = query.getColumn(3).getDouble();
-    double degreesPerSecond = query.getColumn(4).getDouble();
-
-    return RotateMovement(degrees, degreesPerSecond,
-                          glm::vec3(axisX, axisY, axisZ));
+    return movementFromColumns(query, 0);
   } else {
     // Handle the case where the movement is not found
     throw std::runtime_error("Movement not found in database");
@@ -40,71 +40,39 @@ void ScriptablePersister::createTablesIfNeeded() {
 }
 
 void ScriptablePersister::saveAll() {
-  auto &db = registry->getDatabase();
-  auto parentView = registry->view<Persistable, Scriptable>();
-
-  std::stringstream insertQueryStream;
-  insertQueryStream << "INSERT OR REPLACE INTO " << entityName << " "
-                    << "(entity_id, script, language) "
-                    << "VALUES (?, ?, ?)";
-
-  SQLite::Statement query(db, insertQueryStream.str());
-
-  db.exec("BEGIN TRANSACTION");
-  for (auto [entity, persistable, scriptable] : parentView.each()) {
-    query.bind(1, persistable.entityId);
-    query.bind(2, scriptable.getScript());
-    query.bind(3, scriptable.language);
-    query.exec();
-    query.reset();
+  auto view = registry->view<Persistable, Scriptable>();
+  for (auto entity : view) {
+    save(entity);
   }
-  db.exec("COMMIT");
 };
 void ScriptablePersister::save(entt::entity entity) {
-  auto &db = registry->getDatabase();
+  if (!registry->all_of<Persistable, Scriptable>(entity)) {
+    return;
+  }
   auto [persistable, scriptable] = registry->get<Persistable, Scriptable>(entity);
-
-  std::stringstream insertQueryStream;
-  insertQueryStream << "INSERT OR REPLACE INTO " << entityName << " "
-                    << "(entity_id, script, language) "
-                    << "VALUES (?, ?, ?)";
-
-  SQLite::Statement query(db, insertQueryStream.str());
-
-  query.bind(1, persistable.entityId);
-  query.bind(2, scriptable.getScript());
-  query.bind(3, scriptable.language);
-  query.exec();
+  int64_t entityId = persistable.entityId;
+  std::string script = scriptable.getScript();
+  int language = scriptable.language;
+  stage(entityId, [=](WriteBehind::Connection &connection) {
+    auto &query = connection.statement(
+        "INSERT OR REPLACE INTO Scriptable (entity_id, script, language) "
+        "VALUES (?, ?, ?)");
+    query.bind(1, entityId);
+    query.bind(2, script);
+    query.bind(3, language);
+    query.exec();
+  });
 };
 
-void ScriptablePersister::loadAll(){
-  auto &db = registry->getDatabase();
-
-  struct ScriptableCache {
-    std::string script;
-    ScriptLanguage language;
-  };
-  std::unordered_map<int, ScriptableCache> parentCache;
-
-  std::stringstream queryStream;
-  queryStream << "SELECT entity_id, script, language FROM " << entityName;
-  SQLite::Statement query(db, queryStream.str());
-  while (query.executeStep()) {
-    int entityId = query.getColumn(0).getInt();
-    std::string script = query.getColumn(1).getText();
-    int language = query.getColumn(2).getInt();
-    parentCache[entityId] = ScriptableCache{script, (ScriptLanguage)language};
-  }
-
-  auto view = registry->view<Persistable>();
-  for (auto [entity, persistable] : view.each()) {
-    if (parentCache.contains(persistable.entityId)) {
-      auto scriptableCache = parentCache[persistable.entityId];
-      registry->emplace<Scriptable>(entity,
-                                    scriptableCache.script,
-                                    scriptableCache.language);
-    }
-  }
+std::string ScriptablePersister::selectAllQuery() {
+  return "SELECT entity_id, script, language FROM Scriptable "
+         "ORDER BY entity_id";
+}
+void ScriptablePersister::loadRow(entt::entity entity,
+                                  SQLite::Statement &query) {
+  std::string script = query.getColumn(1).getText();
+  int language = query.getColumn(2).getInt();
+  registry->emplace<Scriptable>(entity, script, (ScriptLanguage)language);
 };
 void ScriptablePersister::load(entt::entity){};
 void ScriptablePersister::depersistIfGone(entt::entity entity) {
@@ -53,6 +53,7 @@ Controls::handleKeys(GLFWwindow* window, Camera* camera, World* world)
     handleToggleCursor(window);
     handleToggleApp(window, world, camera);
     handleScreenshot(window);
+    handleToggleRecording(window);
     handleSave(window);
     handleSelection(window);
     handleCodeBlock(window);
@@ -180,6 +181,16 @@ Controls::handleScreenshot(GLFWwindow* window)
   }
 }
 
+void
+Controls::handleToggleRecording(GLFWwindow* window)
+{
+  int recordingKey = controlMappings.getKey("toggle_recording");
+  bool shouldToggle = glfwGetKey(window, recordingKey) == GLFW_PRESS;
+  if (shouldToggle && debounce(lastKeyPressTime)) {
+    renderer->toggleRecording();
+  }
+}
+
 void
 Controls::handleClicks(GLFWwindow* window, World* world)
 {
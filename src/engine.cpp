@@ -12,6 +12,7 @@
 #include "components/Parent.h"
 #include "components/Scriptable.h"
 #include "components/Light.h"
+#include "Config.h"
 #include "entity.h"
 #include "logger.h"
 #include "model.h"
@@ -109,8 +110,6 @@ Engine::Engine(GLFWwindow* window, char** envp)
   // Has to be be created after the cursorCallback because gui wraps the
   // callback
   engineGui = make_shared<EngineGui>(this, window, registry, loggerVector);
-  // turn off vsync
-  // glfwSwapInterval(0);
 }
 
 Engine::~Engine()
@@ -122,7 +121,9 @@ Engine::~Engine()
   delete world;
   delete camera;
   delete api;
+  delete frames;
   registry->saveAll();
+  registry->flush();
 }
 
 void
@@ -136,41 +137,75 @@ Engine::initialize()
     registry, camera, texturePack, "/home/collin/midtown/", true, loggerSink);
   renderer = new Renderer(registry, camera, world, texturePack);
   controls = new Controls(wm, world, camera, renderer, texturePack);
-  api = new Api("tcp://*:3333", registry, controls, wm);
+  api = new Api("tcp://*:3333",
+                "tcp://*:3334",
+                "tcp://*:3335",
+                registry,
+                controls,
+                camera,
+                wm);
   wm->registerControls(controls);
+
+  // a late frame under vsync waits for the next refresh, tearing it in is
+  // the lesser evil where the driver allows it
+  auto config = Config::singleton();
+  double targetFps = config->get<double>("frame.target_fps", 60);
+  int lateSwapInterval =
+    glfwExtensionSupported("GLX_EXT_swap_control_tear") ? -1 : 0;
+  frames = new FrameScheduler(glfwGetTime, 1.0 / targetFps, lateSwapInterval);
+  frames->setAdaptiveVsync(config->get<bool>("frame.adaptive_vsync", true));
 }
 
 void
 Engine::wire()
 {
   world->attachRenderer(renderer);
+  world->attachFrameScheduler(frames);
   wm->wire(wm, camera, renderer);
 }
 
 void
 Engine::loop()
 {
-  vector<double> frameTimes(20, 0);
   double frameStart;
-  int frameIndex = 0;
-  double fps;
   double lastPlayerUpdate = 0;
+  // shares of the target frame time, what's left after them goes to
+  // deferred work and the swap
+  int eventsPhase = frames->addPhase("events", 0.02);
+  int renderPhase = frames->addPhase("render", 0.45);
+  int guiPhase = frames->addPhase("gui", 0.05);
+  int worldPhase = frames->addPhase("world", 0.1);
+  int apiPhase = frames->addPhase("api", 0.05);
+  int wmPhase = frames->addPhase("wm", 0.05);
+  int controlsPhase = frames->addPhase("controls", 0.03);
+  int networkPhase = frames->addPhase("network", 0.05);
+  glfwSwapInterval(frames->getSwapInterval());
   systems::updateLighting(registry, renderer);
   try {
     while (!glfwWindowShouldClose(window)) {
       TracyGpuZone("loop");
+      frames->beginFrame();
       glfwPollEvents();
       frameStart = glfwGetTime();
+      frames->endPhase(eventsPhase);
 
       renderer->render();
-      engineGui->render(fps, frameIndex, frameTimes);
+      frames->endPhase(renderPhase);
+      engineGui->render();
+      frames->endPhase(guiPhase);
 
       // this has the potential to make OpenGL calls (for lighting; 1 render
       // call per light)
       world->tick();
+      frames->endPhase(worldPhase);
 
       api->mutateEntities();
+      api->publishState();
+      frames->defer(FrameScheduler::PERSISTENCE,
+                    [this]() { registry->stageDirty(); });
+      frames->endPhase(apiPhase);
       wm->tick();
+      frames->endPhase(wmPhase);
 
       if(ImGui::IsAnyItemActive()) {
         controls->disableKeys();
@@ -178,6 +213,7 @@ Engine::loop()
         controls->enableKeys();
       }
       controls->poll(window, camera, world);
+      frames->endPhase(controlsPhase);
 
       if (client) {
         client->poll();
@@ -187,14 +223,20 @@ Engine::loop()
         client->sendPlayer(camera->position, camera->front);
         lastPlayerUpdate = frameStart;
       }
+      frames->endPhase(networkPhase);
+
+      frames->runDeferred();
+      if (frames->takeSwapIntervalChange()) {
+        glfwSwapInterval(frames->getSwapInterval());
+        logger->info("swap interval " +
+                     to_string(frames->getSwapInterval()));
+      }
 
       ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+      renderer->captureFrame();
       glfwSwapBuffers(window);
       TracyGpuCollect;
       FrameMark;
-
-      frameTimes[frameIndex] = glfwGetTime() - frameStart;
-      frameIndex = (frameIndex + 1) % 10;
     }
   } catch (const std::exception& e) {
     logger->error(e.what());
@@ -206,6 +248,14 @@ void
 Engine::registerClient(shared_ptr<MultiPlayer::Client> _client)
 {
   client = _client;
+  if (client) {
+    client->attachWorld(world);
+    world->onCubeEdit([client = client](int x, int y, int z, int blockType) {
+      client->sendBlockEdit({ x, y, z, blockType });
+    });
+  } else {
+    world->onCubeEdit(nullptr);
+  }
 }
 
 void
@@ -219,3 +269,15 @@ Engine::getRegistry()
 {
   return registry;
 }
+
+SystemScheduler&
+Engine::getScheduler()
+{
+  return world->getScheduler();
+}
+
+FrameScheduler&
+Engine::getFrameScheduler()
+{
+  return *frames;
+}
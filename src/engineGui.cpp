@@ -54,7 +54,7 @@ EngineGui::EngineGui(Engine* engine,
 }
 
 void
-EngineGui::render(double& fps, int frameIndex, vector<double>& frameTimes)
+EngineGui::render()
 {
   ZoneScoped;
   static MultiPlayer::Gui gui(engine);
@@ -63,20 +63,49 @@ EngineGui::render(double& fps, int frameIndex, vector<double>& frameTimes)
   ImGui::NewFrame();
   // ImGui::ShowDemoWindow();
   // ImGui::SetNextWindowSize(ImVec2(120, 5));
-  if (frameIndex == 0) {
-    fps = 0;
-    for (int i = 0; i < 20; i++) {
-      fps = fps + frameTimes[i];
-    }
-    fps /= 20.0;
-    if (fps > 0)
-      fps = 1.0 / fps;
-  }
   ImGui::Begin("HackMatrix");
   vector<string> debugMessages = loggerVector->fetch();
   if (ImGui::BeginTabBar("Developer Menu")) {
     if (ImGui::BeginTabItem("FPS")) {
-      ImGui::Text("%f fps", fps);
+      auto& frames = engine->getFrameScheduler();
+      auto percentiles = frames.percentiles();
+      ImGui::Text("%.1f fps", percentiles.p50 > 0 ? 1 / percentiles.p50 : 0);
+      ImGui::Text("p50 %.2f ms, p95 %.2f ms, p99 %.2f ms",
+                  percentiles.p50 * 1000,
+                  percentiles.p95 * 1000,
+                  percentiles.p99 * 1000);
+      ImGui::Text("swap interval %d", frames.getSwapInterval());
+      for (auto& phase : frames.getPhases()) {
+        ImGui::Text("%s: %.3f of %.3f ms, %d over",
+                    phase.name.c_str(),
+                    phase.seconds * 1000,
+                    phase.budget * frames.getTargetSeconds() * 1000,
+                    phase.overruns);
+      }
+      ImGui::Text("deferred frames: meshing %d, shadows %d, persistence %d",
+                  frames.getDeferredCount(FrameScheduler::MESHING),
+                  frames.getDeferredCount(FrameScheduler::SHADOWS),
+                  frames.getDeferredCount(FrameScheduler::PERSISTENCE));
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("Apps")) {
+      auto apps = registry->view<X11App>();
+      for (auto [entity, app] : apps.each()) {
+        ImGui::Text("%s: %.1f updates/s",
+                    app.getWindowName().c_str(),
+                    app.getUpdateRate());
+      }
+      ImGui::EndTabItem();
+    }
+    if (ImGui::BeginTabItem("Systems")) {
+      auto& scheduler = engine->getScheduler();
+      ImGui::Text("%zu workers", scheduler.workerCount());
+      for (auto& timing : scheduler.getTimings()) {
+        ImGui::Text("wave %d %s: %.3f ms",
+                    timing.wave,
+                    timing.name.c_str(),
+                    timing.milliseconds);
+      }
       ImGui::EndTabItem();
     }
     if (ImGui::BeginTabItem("Debug Log")) {
@@ -357,8 +386,10 @@ EngineGui::renderComponentPanel(entt::entity entity)
     auto& light = registry->get<Light>(entity);
     ImGui::Text("Light Component:");
     ImGui::BeginGroup();
-    ImGui::ColorEdit3(("Color##" + to_string((int)entity)).c_str(),
-                      (float*)&light.color);
+    if (ImGui::ColorEdit3(("Color##" + to_string((int)entity)).c_str(),
+                          (float*)&light.color)) {
+      registry->markDirty(entity);
+    }
     if (ImGui::Button(
           ("Delete Component##Light" + to_string((int)entity)).c_str())) {
       registry->removePersistent<Light>(entity);
@@ -564,16 +595,24 @@ EngineGui::renderComponentPanel(entt::entity entity)
   if (registry->any_of<Parent>(entity)) {
     auto& parent = registry->get<Parent>(entity);
     ImGui::Text("Parent Component:");
+    bool edited = false;
     for (int i = 0; i < parent.childrenIds.size(); i++) {
-      ImGui::InputInt(
+      edited |= ImGui::InputInt(
         ("Child Id##" + to_string(i) + to_string((int)entity)).c_str(),
         &parent.childrenIds[i]);
     }
     if (ImGui::Button(("- Remove Child##" + to_string((int)entity)).c_str())) {
       parent.childrenIds.pop_back();
+      edited = true;
     }
     if (ImGui::Button(("+ Add Child##" + to_string((int)entity)).c_str())) {
       parent.childrenIds.push_back(0);
+      edited = true;
+    }
+    if (edited) {
+      parent.invalidate();
+      registry->patch<Parent>(entity);
+      registry->markDirty(entity);
     }
     if (ImGui::Button(
           ("Delete Component##Parent" + to_string((int)entity)).c_str())) {
@@ -644,26 +683,35 @@ EngineGui::renderComponentPanel(entt::entity entity)
     int oldX = xy[0];
     int oldY = xy[1];
 
-    ImGui::InputText(label("Command").c_str(), cmd, IM_ARRAYSIZE(cmd));
-    ImGui::InputText(label("Args").c_str(), args, IM_ARRAYSIZE(args));
-    ImGui::InputText(label("Name").c_str(), name, IM_ARRAYSIZE(name));
-    ImGui::InputInt(label("Width").c_str(), &width);
-    ImGui::InputInt(label("Height").c_str(), &height);
-    ImGui::InputInt2(label("X,Y").c_str(), xy);
+    bool edited = false;
+    edited |=
+      ImGui::InputText(label("Command").c_str(), cmd, IM_ARRAYSIZE(cmd));
+    edited |=
+      ImGui::InputText(label("Args").c_str(), args, IM_ARRAYSIZE(args));
+    edited |=
+      ImGui::InputText(label("Name").c_str(), name, IM_ARRAYSIZE(name));
+    edited |= ImGui::InputInt(label("Width").c_str(), &width);
+    edited |= ImGui::InputInt(label("Height").c_str(), &height);
+    edited |= ImGui::InputInt2(label("X,Y").c_str(), xy);
     ImGui::Text("Kill on Exit:");
-    ImGui::RadioButton(label("True##KillOnExit").c_str(), &killOnExit, 1);
-    ImGui::RadioButton(label("False##KillOnExit").c_str(), &killOnExit, 0);
+    edited |=
+      ImGui::RadioButton(label("True##KillOnExit").c_str(), &killOnExit, 1);
+    edited |=
+      ImGui::RadioButton(label("False##KillOnExit").c_str(), &killOnExit, 0);
     if (bootable.pid.has_value()) {
       ImGui::Text("PID: %d", bootable.pid.value());
     } else {
       ImGui::Text("PID: N/A");
     }
     ImGui::Text("Transparent:");
-    ImGui::RadioButton(label("True##Transparent").c_str(), &transparent, 1);
-    ImGui::RadioButton(label("False##Transparent").c_str(), &transparent, 0);
+    edited |=
+      ImGui::RadioButton(label("True##Transparent").c_str(), &transparent, 1);
+    edited |= ImGui::RadioButton(
+      label("False##Transparent").c_str(), &transparent, 0);
     ImGui::Text("Boot on Startup");
-    ImGui::RadioButton(label("True##BootOnStartup").c_str(), &bootOnStartup, 1);
-    ImGui::RadioButton(
+    edited |= ImGui::RadioButton(
+      label("True##BootOnStartup").c_str(), &bootOnStartup, 1);
+    edited |= ImGui::RadioButton(
       label("False##BootOnStartup").c_str(), &bootOnStartup, 0);
     ImGui::Spacing();
 
@@ -683,6 +731,9 @@ EngineGui::renderComponentPanel(entt::entity entity)
       bootable.y = xy[1];
       systems::resizeBootable(registry, entity, width, height);
     }
+    if (edited) {
+      registry->markDirty(entity);
+    }
   }
 }
 
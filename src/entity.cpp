@@ -4,11 +4,21 @@
 #include "Config.h"
 #include <iostream>
 
-EntityRegistry::EntityRegistry() {
+EntityRegistry::EntityRegistry()
+  : EntityRegistry(Config::singleton()->get<std::string>("database_file")) {}
 
-  auto dbFile = Config::singleton()->get<std::string>("database_file");
+EntityRegistry::EntityRegistry(std::string dbFile) {
   db = std::make_shared<SQLite::Database>(dbFile,
                                           SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+  statements = std::make_unique<StatementCache>(*db);
+  db->exec("PRAGMA journal_mode=WAL");
+  db->setBusyTimeout(5000);
+
+  int interval =
+    Config::singleton()->get<int>("persistence.flush_interval_ms", 500);
+  flushInterval = std::chrono::milliseconds(interval);
+  writeBehind = std::make_unique<WriteBehind>(dbFile, interval);
+  on_destroy<Persistable>().connect<&EntityRegistry::forget>(this);
 }
 
 SQLite::Database &EntityRegistry::getDatabase()
@@ -16,11 +26,22 @@ SQLite::Database &EntityRegistry::getDatabase()
   return *db;
 }
 
+SQLite::Statement &EntityRegistry::statement(const std::string &sql)
+{
+  return statements->get(sql);
+}
+
+WriteBehind &EntityRegistry::getWriteBehind()
+{
+  return *writeBehind;
+}
+
 void
 EntityRegistry::createTablesIfNeeded()
 {
   db->exec("CREATE TABLE IF NOT EXISTS Entity "
           "(id INTEGER PRIMARY KEY)");
+  lastEntityId = db->execAndGet("SELECT IFNULL(MAX(id), 0) FROM Entity").getInt64();
 
   for (auto persister : persisters) {
     persister->createTablesIfNeeded();
@@ -43,18 +64,95 @@ EntityRegistry::save(entt::entity e)
   }
 }
 
+void
+EntityRegistry::markDirty(entt::entity e)
+{
+  dirty.insert(e);
+}
+
+// Staging more often than the writer flushes would only replace writes
+// still pending.
+void
+EntityRegistry::stageDirty()
+{
+  if (std::chrono::steady_clock::now() - lastStaged >= flushInterval) {
+    stageAllDirty();
+  }
+}
+
+void
+EntityRegistry::stageAllDirty()
+{
+  lastStaged = std::chrono::steady_clock::now();
+  for (auto e : dirty) {
+    if (valid(e) && all_of<Persistable>(e)) {
+      save(e);
+    }
+  }
+  dirty.clear();
+}
+
+void
+EntityRegistry::flush()
+{
+  stageAllDirty();
+  writeBehind->flush();
+}
+
+// Every table is read in entity_id order, so one pass over the entities
+// advances a cursor per persister instead of each persister scanning into a
+// map and then searching it for every entity.
 void
 EntityRegistry::loadAll()
 {
-  SQLite::Statement query(*db, "SELECT * FROM Entity");
-  while (query.executeStep()) {
-    int entityId = query.getColumn(0).getInt();
-    entt::entity newEntity = create();
-    emplace<Persistable>(newEntity, entityId);
-    entityLocator[entityId] = newEntity;
+  std::vector<int64_t> ids;
+  auto& entityQuery = statement("SELECT id FROM Entity ORDER BY id");
+  while (entityQuery.executeStep()) {
+    ids.push_back(entityQuery.getColumn(0).getInt64());
+  }
+
+  std::vector<entt::entity> entities(ids.size());
+  create(entities.begin(), entities.end());
+  std::vector<Persistable> persistables;
+  persistables.reserve(ids.size());
+  for (auto id : ids) {
+    persistables.push_back(Persistable{id});
+  }
+  insert<Persistable>(entities.begin(), entities.end(), persistables.begin());
+  if (!ids.empty()) {
+    entityLocator.reserve(ids.back() + 1);
   }
+  for (size_t i = 0; i < ids.size(); i++) {
+    locate(ids[i], entities[i]);
+  }
+
+  struct Cursor
+  {
+    SQLPersister* persister;
+    SQLite::Statement* rows;
+    bool hasRow;
+  };
+  std::vector<Cursor> cursors;
   for (auto persister : persisters) {
-    persister->loadAll();
+    auto& rows = statement(persister->selectAllQuery());
+    cursors.push_back(Cursor{persister.get(), &rows, rows.executeStep()});
+  }
+
+  for (size_t i = 0; i < ids.size(); i++) {
+    for (auto& cursor : cursors) {
+      auto& rows = *cursor.rows;
+      // rows for entities that no longer exist are skipped
+      while (cursor.hasRow && rows.getColumn(0).getInt64() < ids[i]) {
+        cursor.hasRow = rows.executeStep();
+      }
+      while (cursor.hasRow && rows.getColumn(0).getInt64() == ids[i]) {
+        cursor.persister->loadRow(entities[i], rows);
+        cursor.hasRow = rows.executeStep();
+      }
+    }
+  }
+  for (auto& cursor : cursors) {
+    cursor.rows->reset();
   }
 }
 
@@ -76,12 +174,19 @@ EntityRegistry::addPersister(std::shared_ptr<SQLPersister> p)
 entt::entity
 EntityRegistry::createPersistent()
 {
-  SQLite::Statement query(*db, "INSERT INTO Entity (id) VALUES (NULL)");
-  query.exec();
-  int64_t id = db->getLastInsertRowid();
+  // ids are handed out here rather than by the database so the row can be
+  // written behind
+  int64_t id = ++lastEntityId;
+  writeBehind->stage("Entity/" + std::to_string(id),
+                     [id](WriteBehind::Connection& connection) {
+                       auto& query = connection.statement(
+                         "INSERT OR REPLACE INTO Entity (id) VALUES (?)");
+                       query.bind(1, id);
+                       query.exec();
+                     });
   auto rv = this->create();
   emplace<Persistable>(rv, id);
-  entityLocator[id] = rv;
+  locate(id, rv);
   return rv;
 }
 
@@ -89,22 +194,49 @@ void
 EntityRegistry::depersist(entt::entity entity)
 {
   auto& persistable = get<Persistable>(entity);
-  entityLocator.erase(persistable.entityId);
   for (auto persister : persisters) {
     persister->depersist(entity);
   }
-  SQLite::Statement query(*db, "DELETE FROM Entity WHERE id = ?");
-  query.bind(1, persistable.entityId);
-  query.exec();
+  int64_t id = persistable.entityId;
+  writeBehind->stage("Entity/" + std::to_string(id),
+                     [id](WriteBehind::Connection& connection) {
+                       auto& query =
+                         connection.statement("DELETE FROM Entity WHERE id = ?");
+                       query.bind(1, id);
+                       query.exec();
+                     });
+  dirty.erase(entity);
   destroy(entity);
 }
 
+void
+EntityRegistry::locate(int64_t entityId, entt::entity entity)
+{
+  if (entityId >= (int64_t)entityLocator.size()) {
+    entityLocator.resize(entityId + 1, entt::null);
+  }
+  entityLocator[entityId] = entity;
+  locatorGeneration++;
+}
+
+// destroying an entity or removing its Persistable takes it off the locator
+void
+EntityRegistry::forget(entt::registry&, entt::entity entity)
+{
+  int64_t entityId = get<Persistable>(entity).entityId;
+  if (entityId >= 0 && entityId < (int64_t)entityLocator.size() &&
+      entityLocator[entityId] == entity) {
+    entityLocator[entityId] = entt::null;
+    locatorGeneration++;
+  }
+}
+
 std::optional<entt::entity>
 EntityRegistry::locateEntity(int entityIdForDB)
 {
-  if (entityLocator.contains(entityIdForDB)) {
-    return std::optional(entityLocator[entityIdForDB]);
-  } else {
+  if (entityIdForDB < 0 || entityIdForDB >= (int)entityLocator.size() ||
+      entityLocator[entityIdForDB] == entt::null) {
     return std::nullopt;
   }
+  return entityLocator[entityIdForDB];
 }
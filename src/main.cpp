@@ -58,6 +58,9 @@ cleanup(Engine* engine)
 int
 main(int argc, char** argv, char** envp)
 {
+  // the window manager's connection is shared by its event thread, the
+  // render thread and the thread sending window requests
+  XInitThreads();
   if (argc > 1) {
     if (argv[1] == "--debug") {
       waitForTTYSwitch();
@@ -151,13 +151,17 @@ Model::loadMaterialTextures(aiMaterial* mat,
 }
 
 BoundingSphere
-Model::getBoundingSphere(float scale)
+Model::getBoundingSphere()
 {
+  if (boundingSphere.has_value()) {
+    return boundingSphere.value();
+  }
   auto vertices = getAllVertices();
 
   if (vertices.empty()) {
     // Handle the case of an empty mesh
-    return BoundingSphere{ glm::vec3(0.0f), 0.0f };
+    boundingSphere = BoundingSphere{ glm::vec3(0.0f), 0.0f };
+    return boundingSphere.value();
   }
 
   // 1. Find bounding box (same as before):
@@ -165,9 +169,8 @@ Model::getBoundingSphere(float scale)
   glm::vec3 maxBounds(-std::numeric_limits<float>::max());
 
   for (const Vertex& vertex : vertices) {
-    glm::vec3 scaledPosition = vertex.Position * scale;
-    minBounds = glm::min(minBounds, scaledPosition);
-    maxBounds = glm::max(maxBounds, scaledPosition);
+    minBounds = glm::min(minBounds, vertex.Position);
+    maxBounds = glm::max(maxBounds, vertex.Position);
   }
 
   // 2. Calculate center:
@@ -176,12 +179,12 @@ Model::getBoundingSphere(float scale)
   // 3. Find the radius:
   float radius = 0.0f;
   for (const Vertex& vertex : vertices) {
-    glm::vec3 scaledPosition = vertex.Position * scale;
-    float distance = glm::distance(scaledPosition, center);
+    float distance = glm::distance(vertex.Position, center);
     radius = std::max(radius, distance);
   }
 
-  return BoundingSphere{ center, radius };
+  boundingSphere = BoundingSphere{ center, radius };
+  return boundingSphere.value();
 }
 
 unsigned int
@@ -240,229 +243,13 @@ Model::Model(string path)
   loadModel(path);
 }
 
-void
-Positionable::update()
-{
-  modelMatrix = glm::mat4(1.0f);
-  modelMatrix = glm::translate(modelMatrix, pos);
-
-  // Create individual rotation quaternions
-  glm::quat finalRotation = glm::quat(glm::radians(rotate));
-
-  modelMatrix = modelMatrix * glm::mat4_cast(finalRotation);
-  modelMatrix = glm::translate(modelMatrix, origin * glm::vec3(-1));
-  modelMatrix = glm::scale(modelMatrix, glm::vec3(scale, scale, scale));
-  glm::mat4 inverseModelMatrix = glm::inverse(modelMatrix);
-  glm::mat4 transposedInverse = glm::transpose(inverseModelMatrix);
-  normalMatrix = glm::mat3(transposedInverse);
-  damaged = false;
-}
-
-void
-Positionable::damage()
-{
-  damaged = true;
-}
-
-Positionable::Positionable(glm::vec3 pos,
-                           glm::vec3 origin,
-                           glm::vec3 rotate,
-                           float scale)
-  : pos(pos)
-  , origin(origin)
-  , scale(scale)
-  , rotate(rotate)
-{
-}
-
-Positionable::Positionable(Positionable* p) {
-  Positionable(p->pos, p->origin, p->rotate, p->scale);
-}
-
-void
-PositionablePersister::createTablesIfNeeded()
-{
-  stringstream queryStream;
-  queryStream << "CREATE TABLE IF NOT EXISTS " << entityName << " ("
-              << "entity_id INTEGER PRIMARY KEY, "
-              << "pos_x REAL, pos_y REAL, pos_z REAL, "
-              << "origin_x REAL, origin_y REAL, origin_z REAL, scale REAL, "
-              << "rot_x REAL, rot_y REAL, rot_z REAL, "
-              << "FOREIGN KEY(entity_id) REFERENCES Entity(id))";
-  registry->getDatabase().exec(queryStream.str());
-}
-
-void
-PositionablePersister::save(entt::entity entity)
-{
-  auto& pos = registry->get<Positionable>(entity);
-  auto& persistable = registry->get<Persistable>(entity);
-  auto& db = registry->getDatabase();
-  stringstream queryStream;
-  queryStream << "INSERT OR REPLACE INTO " << entityName
-              << " (entity_id, pos_x, pos_y, pos_z, "
-              << "origin_x, origin_y, origin_z, "
-              << "rot_x, rot_y, rot_z, scale)"
-              << " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
-  SQLite::Statement query(db, queryStream.str());
-  query.bind(1, persistable.entityId);
-  query.bind(2, pos.pos.x);
-  query.bind(3, pos.pos.y);
-  query.bind(4, pos.pos.z);
-  query.bind(5, pos.origin.x);
-  query.bind(6, pos.origin.y);
-  query.bind(7, pos.origin.z);
-  query.bind(8, pos.rotate.x);
-  query.bind(9, pos.rotate.y);
-  query.bind(10, pos.rotate.z);
-  query.bind(11, pos.scale);
-  query.exec();
-}
-
-void
-PositionablePersister::saveAll()
-{
-  auto view = registry->view<Persistable, Positionable>();
-
-  SQLite::Database& db = registry->getDatabase(); // Get database reference
-
-  stringstream queryStream;
-  queryStream << "INSERT OR REPLACE INTO " << entityName
-              << " (entity_id, pos_x, pos_y, pos_z, "
-              << "origin_x, origin_y, origin_z, "
-              << "rot_x, rot_y, rot_z, scale)"
-              << " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
-  SQLite::Statement query(db, queryStream.str());
-  // Use a transaction for efficiency
-  db.exec("BEGIN TRANSACTION");
-
-  for (auto [entity, persist, positionable] : view.each()) {
-    query.bind(1, persist.entityId);
-    query.bind(2, positionable.pos.x);
-    query.bind(3, positionable.pos.y);
-    query.bind(4, positionable.pos.z);
-    query.bind(5, positionable.origin.x);
-    query.bind(6, positionable.origin.y);
-    query.bind(7, positionable.origin.z);
-    query.bind(8, positionable.rotate.x);
-    query.bind(9, positionable.rotate.y);
-    query.bind(10, positionable.rotate.z);
-    query.bind(11, positionable.scale);
-    query.exec();
-    query.reset(); // Important for reusing the prepared statement
-  }
-
-  db.exec("COMMIT");
-}
-
-void
-PositionablePersister::load(entt::entity entity)
-{
-  auto peristable = registry->get<Persistable>(entity);
-  std::stringstream queryStream;
-  queryStream << "SELECT pos_x, pos_y, pos_z, "
-              << "origin_x, origin_y, origin_z, "
-              << "rot_x, rot_y, rot_z, scale FROM " << entityName
-              << " WHERE entity_id = ?";
-  SQLite::Statement query(registry->getDatabase(), queryStream.str());
-  query.bind(1, peristable.entityId);
-
-  if (query.executeStep()) {
-    float x = query.getColumn(0).getDouble();
-    float y = query.getColumn(1).getDouble();
-    float z = query.getColumn(2).getDouble();
-    float origin_x = query.getColumn(3).getDouble();
-    float origin_y = query.getColumn(4).getDouble();
-    float origin_z = query.getColumn(5).getDouble();
-    float rotx = query.getColumn(6).getDouble();
-    float roty = query.getColumn(7).getDouble();
-    float rotz = query.getColumn(8).getDouble();
-    float scale = query.getColumn(9).getDouble();
-
-    registry->emplace<Positionable>(entity,
-                                    glm::vec3(x, y, z),
-                                    glm::vec3(origin_x, origin_y, origin_z),
-                                    glm::vec3(rotx, roty, rotz),
-                                    scale);
-  }
-}
-
-void
-PositionablePersister::loadAll()
-{
-  auto view = registry->view<Persistable>();
-  SQLite::Database& db = registry->getDatabase();
-
-  // Cache query data
-  std::unordered_map<int, std::array<float, 10>> positionDataCache;
-
-  std::stringstream queryStream;
-  queryStream << "SELECT entity_id, pos_x, pos_y, pos_z, "
-              << "origin_x, origin_y, origin_z, "
-              << "rot_x, rot_y, rot_z, scale FROM " << entityName;
-  SQLite::Statement query(db, queryStream.str());
-  while (query.executeStep()) {
-    int dbId = query.getColumn(0).getInt();
-    float x = query.getColumn(1).getDouble();
-    float y = query.getColumn(2).getDouble();
-    float z = query.getColumn(3).getDouble();
-    float origin_x = query.getColumn(4).getDouble();
-    float origin_y = query.getColumn(5).getDouble();
-    float origin_z = query.getColumn(6).getDouble();
-    float rotx = query.getColumn(7).getDouble();
-    float roty = query.getColumn(8).getDouble();
-    float rotz = query.getColumn(9).getDouble();
-    float scale = query.getColumn(10).getDouble();
-
-    std::array<float, 10> data = {
-      x, y, z, origin_x, origin_y, origin_z, rotx, roty, rotz, scale
-    }; // Using temporaries
-    positionDataCache[dbId] = data;
-  }
-
-  // Iterate and emplace
-  for (auto [entity, persistable] : view.each()) {
-    auto it = positionDataCache.find(persistable.entityId);
-    if (it != positionDataCache.end()) {
-      auto& [x, y, z, originX, originY, originZ, rotx, roty, rotz, scale] =
-        it->second;
-      registry->emplace<Positionable>(entity,
-                                      glm::vec3(x, y, z),
-                                      glm::vec3(originX, originY, originZ),
-                                      glm::vec3(rotx, roty, rotz),
-                                      scale);
-    }
-  }
-}
-
-void
-PositionablePersister::depersistIfGone(entt::entity entity)
-{
-  depersistIfGoneTyped<Positionable>(entity);
-}
-
 void
 ModelPersister::saveAll()
 {
   auto view = registry->view<Persistable, Model>();
-  SQLite::Database& db = registry->getDatabase();
-
-  // Assuming you have a 'Model' table with 'entity_id' and 'path' columns
-  std::stringstream queryStream;
-  queryStream << "INSERT OR REPLACE INTO " << entityName
-              << " (entity_id, path) VALUES (?, ?)";
-  SQLite::Statement query(db, queryStream.str());
-
-  db.exec("BEGIN TRANSACTION"); // Initiate transaction
-
-  for (auto [entity, persist, model] : view.each()) {
-    query.bind(1, persist.entityId);
-    query.bind(2, model.path);
-    query.exec();
-    query.reset();
+  for (auto entity : view) {
+    save(entity);
   }
-
-  db.exec("COMMIT"); // Commit changes
 }
 
 void
@@ -477,74 +264,45 @@ ModelPersister::createTablesIfNeeded()
   db.exec(queryStream.str());
 }
 
-void
-ModelPersister::loadAll()
+std::string
+ModelPersister::selectAllQuery()
 {
-  auto view = registry->view<Persistable>();
-  SQLite::Database& db = registry->getDatabase();
-
-  // Cache query data
-  std::unordered_map<int, std::string> modelDataCache;
-  std::stringstream queryStream;
-  queryStream << "SELECT entity_id, path FROM " << entityName;
-  SQLite::Statement query(db, queryStream.str());
-
-  while (query.executeStep()) {
-    int dbId = query.getColumn(0).getInt();
-    std::string path = query.getColumn(1).getText();
-    modelDataCache[dbId] = path;
-  }
+  return "SELECT entity_id, path FROM Model ORDER BY entity_id";
+}
 
-  // Iterate and load (assuming you have a mechanism to load Models from paths)
-  view.each([&modelDataCache, this](auto entity, auto& persistable) {
-    auto it = modelDataCache.find(persistable.entityId);
-    if (it != modelDataCache.end()) {
-      std::string& path = it->second;
-      std::unique_ptr<Model> model = make_unique<Model>(path);
-      if (model) {
-        registry->emplace<Model>(entity, std::move(*model));
-      }
-    }
-  });
+void
+ModelPersister::loadRow(entt::entity entity, SQLite::Statement& query)
+{
+  std::string path = query.getColumn(1).getText();
+  registry->emplace<Model>(entity, path);
 }
 
 void
 ModelPersister::load(entt::entity entity)
 {
-  auto& persistable = registry->get<Persistable>(entity);
-  SQLite::Database& db = registry->getDatabase();
-
-  std::stringstream queryStream;
-  queryStream << "SELECT path FROM " << entityName << " WHERE entity_id = ?";
-  SQLite::Statement query(db, queryStream.str());
-  query.bind(1, persistable.entityId);
-
+  auto& query = registry->statement(
+    "SELECT entity_id, path FROM Model WHERE entity_id = ?");
+  query.bind(1, registry->get<Persistable>(entity).entityId);
   if (query.executeStep()) {
-    std::string path = query.getColumn(0).getText();
-
-    std::unique_ptr<Model> model = make_unique<Model>(path);
-    if (model) {
-      registry->emplace<Model>(entity, std::move(*model));
-    } else {
-      // Log or handle model loading error
-    }
+    loadRow(entity, query);
   }
 }
 
 void
 ModelPersister::save(entt::entity entity)
 {
-  auto& model = registry->get<Model>(entity);
-  auto& persistable = registry->get<Persistable>(entity);
-  SQLite::Database& db = registry->getDatabase();
-
-  std::stringstream queryStream;
-  queryStream << "INSERT OR REPLACE INTO " << entityName
-              << " (entity_id, path) VALUES (?, ?)";
-  SQLite::Statement query(db, queryStream.str());
-  query.bind(1, persistable.entityId);
-  query.bind(2, model.path);
-  query.exec();
+  if (!registry->all_of<Persistable, Model>(entity)) {
+    return;
+  }
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  std::string path = registry->get<Model>(entity).path;
+  stage(entityId, [entityId, path](WriteBehind::Connection& connection) {
+    auto& query = connection.statement(
+      "INSERT OR REPLACE INTO Model (entity_id, path) VALUES (?, ?)");
+    query.bind(1, entityId);
+    query.bind(2, path);
+    query.exec();
+  });
 }
 
 void
@@ -1,16 +1,21 @@
 #include "SQLPersisterImpl.h"
 #include "entity.h"
 
+void
+SQLPersisterImpl::stage(int64_t entityId, WriteBehind::Write write)
+{
+  registry->getWriteBehind().stage(entityName + "/" + std::to_string(entityId),
+                                   std::move(write));
+}
+
 void
 SQLPersisterImpl::depersist(entt::entity entity)
 {
   auto& persistable = registry->get<Persistable>(entity);
-  std::stringstream queryStream;
-  queryStream << "DELETE FROM " << entityName << " WHERE entity_id = ?";
-  SQLite::Statement query(registry->getDatabase(), queryStream.str());
-  query.bind(1, persistable.entityId);
-  try {
+  int64_t entityId = persistable.entityId;
+  stage(entityId, [this, entityId](WriteBehind::Connection& connection) {
+    auto& query = connection.statement(deleteQuery);
+    query.bind(1, entityId);
     query.exec();
-  } catch (...) { /*nothing to delete*/
-  }
+  });
 }
@@ -1,3 +1,4 @@
+#include "Config.h"
 #include "IndexPool.h"
 #include "glm/ext/matrix_transform.hpp"
 #include "model.h"
@@ -29,7 +30,6 @@
 #define DISABLE_CULLING true
 
 float HEIGHT = SCREEN_HEIGHT / SCREEN_WIDTH / 2.0;
-float MAX_LIGHTS = 5;
 
 float appVertices[] = {
   -0.5f, -HEIGHT, 0, 0.0f, 0.0f, 0.5f,  -HEIGHT, 0, 1.0f, 0.0f,
@@ -233,7 +233,7 @@ Renderer::Renderer(shared_ptr<EntityRegistry> registry,
                    shared_ptr<blocks::TexturePack> texturePack)
   : texturePack(texturePack)
   , registry(registry)
-  , appIndexPool(IndexPool(17))
+  , appIndexPool(IndexPool())
 {
   this->camera = camera;
   this->world = world;
@@ -259,14 +259,17 @@ Renderer::Renderer(shared_ptr<EntityRegistry> registry,
                            "shaders/depthFragment.glsl");
 
   shader = cameraShader;
+  lightClusters = new LightClusters(registry);
+  int encoderThreads =
+    Config::singleton()->get<int>("capture.encoder_threads", 2);
+  frameCapture = new FrameCapture(encoderThreads);
 
   shader->use(); // may need to move into loop to use changing uniforms
 
   shader->setInt("allBlocks", 0);
   shader->setInt("totalBlockTypes", images.size());
   shader->setBool("SHADOWS_ENABLED", SHADOWS_ENABLED);
-
-  initAppTextures();
+  shader->setInt("appTexture", APP_TEXTURE_UNIT);
 
   shader->setBool("lookedAtValid", false);
   shader->setBool("isLookedAt", false);
@@ -283,17 +286,23 @@ Renderer::Renderer(shared_ptr<EntityRegistry> registry,
   glLineWidth(10.0);
 }
 
-void
-Renderer::initAppTextures()
+Texture*
+Renderer::appTextureSlot(int index)
 {
-  for (int index = 0; index < 20; index++) {
-    int textureN = 31 - index;
-    int textureUnit = GL_TEXTURE0 + textureN;
-    string textureName = "app" + to_string(index);
-    textures.insert(
-      std::pair<string, Texture*>(textureName, new Texture(textureUnit)));
-    shader->setInt(textureName, textureN);
+  if (index >= (int)appTextures.size()) {
+    appTextures.resize(index + 1, NULL);
   }
+  if (appTextures[index] == NULL) {
+    appTextures[index] = new Texture(GL_TEXTURE0 + APP_TEXTURE_UNIT);
+  }
+  return appTextures[index];
+}
+
+void
+Renderer::bindAppTexture(int index)
+{
+  glActiveTexture(GL_TEXTURE0 + APP_TEXTURE_UNIT);
+  glBindTexture(GL_TEXTURE_2D, appTextures[index]->ID);
 }
 
 void
@@ -456,7 +465,7 @@ Renderer::drawAppDirect(X11App* app, Bootable* bootable)
         x = bootable->x;
         y = bootable->y;
       }
-      shader->setInt("appNumber", app->getAppIndex());
+      bindAppTexture(index);
       shader->setBool("appTransparent", bootable->transparent);
       shader->setMatrix4("model", model);
       glDrawArrays(GL_TRIANGLES, 0, 6);
@@ -468,27 +477,25 @@ Renderer::drawAppDirect(X11App* app, Bootable* bootable)
 void
 Renderer::screenshot()
 {
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-  stbi_flip_vertically_on_write(true);
-  auto t = std::time(nullptr);
-  auto tm = *std::localtime(&t);
-  stringstream filenameSS;
-  filenameSS << "screenshots/" << std::put_time(&tm, "%d-%m-%Y %H-%M-%S.png");
+  frameCapture->screenshot();
+}
 
-  string filename = filenameSS.str();
+void
+Renderer::toggleRecording()
+{
+  if (frameCapture->isRecording()) {
+    frameCapture->stopRecording();
+    return;
+  }
+  int fps = Config::singleton()->get<int>("capture.fps", 30);
+  string format = Config::singleton()->get<string>("capture.format", "png");
+  frameCapture->startRecording(fps, format == "raw");
+}
 
-  // Capture the screenshot and save it as a PNG file
-  int width = getScreenWidth();  // Width of your rendering area
-  int height = getScreenHeight(); // Height of your rendering area
-  int channels = 4;  // 4 for RGBA
-  unsigned char* data = new unsigned char[width * height * channels];
-  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
-  std::thread saver([filename, width, height, channels, data]() {
-    stbi_write_png(
-      filename.c_str(), width, height, channels, data, width * channels);
-    delete[] data;
-  });
-  saver.detach();
+void
+Renderer::captureFrame()
+{
+  frameCapture->capture(SCREEN_WIDTH, SCREEN_HEIGHT, glfwGetTime());
 }
 
 void
@@ -540,6 +547,16 @@ Renderer::renderChunkMesh()
   shader->setBool("isMesh", false);
 }
 
+void
+Renderer::refreshAppTextures()
+{
+  ZoneScoped;
+  auto apps = registry->view<X11App>();
+  for (auto [entity, app] : apps.each()) {
+    app.refreshTexture();
+  }
+}
+
 void
 Renderer::renderApps()
 {
@@ -560,7 +577,7 @@ Renderer::renderApps()
     // OPTIMIZATION
     // TODO: cache the recomputeHeightScaler into the app itself and don't recompute it every render
     shader->setMatrix4("bootableScale", app.heightScalar);
-    shader->setInt("appNumber", app.getAppIndex());
+    bindAppTexture(app.getAppIndex());
     shader->setBool("appTransparent", false);
     glDrawArrays(GL_TRIANGLES, 0, 6);
   }
@@ -569,7 +586,7 @@ Renderer::renderApps()
   for (auto [entity, app, positionable, bootable] : positionableApps.each()) {
     shader->setMatrix4("model", positionable.modelMatrix);
     shader->setMatrix4("bootableScale", bootable.getHeightScaler());
-    shader->setInt("appNumber", app.getAppIndex());
+    bindAppTexture(app.getAppIndex());
     if (app.isSelected()) {
       shader->setBool("appSelected", true);
     }
@@ -605,6 +622,7 @@ Renderer::renderApps()
     drawAppDirect(&directApp, &bootable);
   }
 
+  glActiveTexture(GL_TEXTURE0);
   shader->setBool("isApp", false);
 }
 
@@ -621,16 +639,18 @@ void
 Renderer::lightUniforms(RenderPerspective perspective,
                         std::optional<entt::entity> fromLight)
 {
+  if (perspective == CAMERA) {
+    lightClusters->bindUniforms(shader, SCREEN_WIDTH, SCREEN_HEIGHT);
+  }
   auto lightView = registry->view<Light, Positionable>();
   int lightIndex = 0;
-  int lastTextureUnit;
   for (auto [entity, light, positionable] : lightView.each()) {
-    shader->setVec3("lightPos[" + std::to_string(lightIndex) + "]",
-                    positionable.pos);
-    shader->setVec3("lightColor[" + std::to_string(lightIndex) + "]",
-                    light.color);
-    shader->setFloat("far_plane[" + std::to_string(lightIndex) + "]",
-                     light.farPlane);
+    if (perspective == LIGHT) {
+      shader->setVec3("lightPos[" + std::to_string(lightIndex) + "]",
+                      positionable.pos);
+      shader->setFloat("far_plane[" + std::to_string(lightIndex) + "]",
+                       light.farPlane);
+    }
     if (perspective == LIGHT && fromLight == entity) {
       shader->setInt("fromLightIndex", lightIndex);
       cout << "lightIndex: " << lightIndex << endl;
@@ -639,16 +659,15 @@ Renderer::lightUniforms(RenderPerspective perspective,
                            light.shadowTransforms[i]);
       }
     }
-    if (perspective == CAMERA) {
+    if (perspective == CAMERA &&
+        lightIndex < LightClusters::MAX_SHADOWED_LIGHTS) {
       shader->setInt("depthCubeMap" + std::to_string(lightIndex),
                      light.textureUnit);
-      // THIS IS A HACK
-      lastTextureUnit = light.textureUnit;
-    }
-
-    // THIS IS A HACK. If I exceed 5 lights, use texture array (proper)
-    for (int i = lightIndex; i < MAX_LIGHTS; i++) {
-      shader->setInt("depthCubeMap" + std::to_string(i), light.textureUnit);
+      // unused shadow samplers still need a cube map bound
+      for (int i = lightIndex + 1; i < LightClusters::MAX_SHADOWED_LIGHTS;
+           i++) {
+        shader->setInt("depthCubeMap" + std::to_string(i), light.textureUnit);
+      }
     }
     lightIndex++;
   }
@@ -689,6 +708,7 @@ Renderer::renderModels(RenderPerspective perspective)
     }
     if (!lightEntities.empty() && lightEntities.contains(entity)) {
       shader->setBool("isLight", true);
+      shader->setVec3("emissiveColor", registry->get<Light>(entity).color);
       if (perspective == LIGHT) {
         shouldDraw = false;
       }
@@ -727,6 +747,12 @@ Renderer::render(RenderPerspective perspective,
 
     camera->tick();
     updateTransformMatrices();
+    refreshAppTextures();
+    lightClusters->setProjection(camera->getYFov(),
+                                 SCREEN_WIDTH / SCREEN_HEIGHT,
+                                 camera->getZNear(),
+                                 camera->getZFar());
+    lightClusters->update(camera->getViewMatrix());
   } else {
     shader = depthShader;
     shader->use();
@@ -752,9 +778,8 @@ Renderer::registerApp(X11App* app)
   // indices will change.
   auto index = appIndexPool.acquireIndex();
   try {
-    int textureN = 31 - index;
-    int textureUnit = GL_TEXTURE0 + textureN;
-    int textureId = textures["app" + to_string(index)]->ID;
+    int textureUnit = GL_TEXTURE0 + APP_TEXTURE_UNIT;
+    int textureId = appTextureSlot(index)->ID;
     app->attachTexture(textureUnit, textureId, index);
     app->appTexture();
   } catch (...) {
@@ -769,7 +794,7 @@ Renderer::registerApp(X11App* app)
   glFramebufferTexture2D(GL_READ_FRAMEBUFFER,
                          GL_COLOR_ATTACHMENT0,
                          GL_TEXTURE_2D,
-                         textures["app" + to_string(index)]->ID,
+                         appTextures[index]->ID,
                          0);
 }
 
@@ -798,8 +823,13 @@ Renderer::wireWindowManager(shared_ptr<WindowManager::WindowManager> wm,
 
 Renderer::~Renderer()
 {
+  delete lightClusters;
+  delete frameCapture;
   delete shader;
   for (auto& t : textures) {
     delete t.second;
   }
+  for (auto t : appTextures) {
+    delete t;
+  }
 }
@@ -188,6 +188,12 @@ Shader::setMatrix3(const std::string& name, const glm::mat3& value) const
     glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &value[0][0]);
 }
 
+void
+Shader::setVec2(const std::string& name, const glm::vec2& value) const
+{
+  glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+}
+
 void
 Shader::setVec3(const std::string& name, const glm::vec3& value) const
 {
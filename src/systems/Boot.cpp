@@ -1,12 +1,21 @@
 #include "systems/Boot.h"
 #include "components/Bootable.h"
 #include <optional>
+#include <poll.h>
 #include <signal.h>
+#include <sys/inotify.h>
+#include <unistd.h>
 
 #include <string>
 #include <iostream>
 #include <fstream>
-#include <thread>
+#include <chrono>
+#include <climits>
+#include <future>
+#include <sstream>
+
+// how long a shell script gets to write its app's pid
+const std::chrono::milliseconds PID_FILE_TIMEOUT(5000);
 
 bool
 isShellScript(const std::string& filename)
@@ -19,43 +28,57 @@ isShellScript(const std::string& filename)
   }
 }
 
-int
-getShPID(char* pidfile)
+std::optional<int>
+readPid(const std::string& pidfile)
 {
-  const int timeoutSeconds = 5;
-  // Open the file for reading
-  cout << "opening " << pidfile << endl;
   std::ifstream file(pidfile);
   int pid;
+  if (file >> pid) {
+    return pid;
+  }
+  return std::nullopt;
+}
 
-  auto start_time = std::chrono::steady_clock::now();
-  while (std::chrono::steady_clock::now() - start_time <
-         std::chrono::seconds(timeoutSeconds)) {
-    if (file.peek() != std::ifstream::traits_type::eof()) {
-      // File has bytes, read the PID
-      file >> pid;
-      file.close();
-      // std::remove(pidfile);
-      return pid;
+// Blocks on inotify until the script closes its pid file rather than polling
+// it. The file is read once after the watch is added, so a write that lands
+// before then isn't missed.
+std::optional<int>
+waitForPidFile(std::string pidfile, std::chrono::milliseconds timeout)
+{
+  int watcher = inotify_init1(IN_CLOEXEC);
+  if (watcher == -1) {
+    return readPid(pidfile);
+  }
+  inotify_add_watch(watcher, pidfile.c_str(), IN_CLOSE_WRITE);
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  auto pid = readPid(pidfile);
+  while (!pid.has_value()) {
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now());
+    pollfd ready = { watcher, POLLIN, 0 };
+    if (remaining.count() <= 0 || poll(&ready, 1, remaining.count()) <= 0) {
+      break;
     }
-    std::this_thread::sleep_for(
-      std::chrono::milliseconds(100)); // Wait for 100 milliseconds
-    file = std::ifstream(pidfile);
+    char events[sizeof(inotify_event) + NAME_MAX + 1];
+    read(watcher, events, sizeof(events));
+    pid = readPid(pidfile);
   }
-
-  // Timeout reached, return an error value (e.g., -1)
-  return -1;
+  close(watcher);
+  return pid;
 }
 
+// the forked pid, and the pid file a shell script was handed to write its
+// app's pid to
 int
-forkApp(string cmd, char** envp, string args)
+forkApp(string cmd, char** envp, string args, optional<string>& pidfile)
 {
 
-  char pidfile[] = "/tmp/pid.XXXXXX"; // Template for temporary file name
+  char pidfileTemplate[] = "/tmp/pid.XXXXXX"; // Template for temporary file name
   if (isShellScript(cmd)) {
-    int fd = mkstemp(pidfile); // Create a temporary file
+    int fd = mkstemp(pidfileTemplate); // Create a temporary file
     close(fd);
-    args = string(pidfile) + " " + args;
+    pidfile = string(pidfileTemplate);
+    args = pidfile.value() + " " + args;
   }
 
   int pid = fork();
@@ -84,14 +107,8 @@ forkApp(string cmd, char** envp, string args)
       execle(cmd.c_str(), cmd.c_str(), NULL, envp);
     }
     exit(0);
-  } else {
-    if (isShellScript(cmd)) {
-      auto shellPid = getShPID(pidfile);
-      return shellPid;
-    } else {
-      return pid;
-    }
   }
+  return pid;
 }
 
 bool
@@ -100,34 +117,64 @@ pidIsRunning(int pid)
   return kill(pid, 0) == 0;
 }
 
-void
-systems::boot(std::shared_ptr<EntityRegistry> registry,
-              entt::entity entity,
-              char** envp)
+std::optional<systems::Launched>
+systems::launch(std::shared_ptr<EntityRegistry> registry,
+                entt::entity entity,
+                char** envp)
 {
   auto bootable = registry->try_get<Bootable>(entity);
-
-  if (bootable && bootable->bootOnStartup) {
-    if (bootable->pid != std::nullopt && !bootable->killOnExit) {
-      // Check if the process exists
-      if (pidIsRunning(bootable->pid.value())) {
-        return; // Process is already running, no need to fork
-      }
+  if (!bootable || !bootable->bootOnStartup) {
+    return std::nullopt;
+  }
+  if (bootable->pid != std::nullopt && !bootable->killOnExit) {
+    // Check if the process exists
+    if (pidIsRunning(bootable->pid.value())) {
+      return std::nullopt; // Process is already running, no need to fork
     }
+  }
 
-    bootable->pid = forkApp(bootable->cmd, envp, bootable->args);
-    if (bootable->pid == -1) {
-      bootable->pid = nullopt;
-    }
+  optional<string> pidfile;
+  int forkedPid = forkApp(bootable->cmd, envp, bootable->args, pidfile);
+  if (forkedPid == -1) {
+    return std::nullopt;
+  }
+  std::shared_future<std::optional<int>> pid;
+  if (pidfile.has_value()) {
+    pid = std::async(std::launch::async,
+                     waitForPidFile,
+                     pidfile.value(),
+                     PID_FILE_TIMEOUT)
+            .share();
+  } else {
+    std::promise<std::optional<int>> forked;
+    forked.set_value(forkedPid);
+    pid = forked.get_future().share();
   }
+  return Launched{ entity, forkedPid, pid };
 }
 
-void
-systems::bootAll(std::shared_ptr<EntityRegistry> registry, char** envp)
+std::vector<systems::Launched>
+systems::launchAll(std::shared_ptr<EntityRegistry> registry, char** envp)
 {
+  std::vector<Launched> launched;
   auto bootables = registry->view<Bootable>();
   for (auto [entity, bootable] : bootables.each()) {
-    boot(registry, entity, envp);
+    auto started = launch(registry, entity, envp);
+    if (started.has_value()) {
+      launched.push_back(started.value());
+    }
+  }
+  return launched;
+}
+
+void
+systems::boot(std::shared_ptr<EntityRegistry> registry,
+              entt::entity entity,
+              char** envp)
+{
+  auto launched = launch(registry, entity, envp);
+  if (launched.has_value()) {
+    registry->get<Bootable>(entity).pid = launched->pid.get();
   }
 }
 
@@ -12,6 +12,7 @@ systems::openDoor(std::shared_ptr<EntityRegistry> registry, entt::entity entity)
     movement.onFinish = [registry, entity]() -> void {
       auto& door = registry->get<Door>(entity);
       door.state = OPEN;
+      registry->markDirty(entity);
     };
     registry->emplace<RotateMovement>(entity, movement);
     door.state = OPENING;
@@ -28,6 +29,7 @@ systems::closeDoor(std::shared_ptr<EntityRegistry> registry,
     movement.onFinish = [registry, entity]() -> void {
       auto& door = registry->get<Door>(entity);
       door.state = CLOSED;
+      registry->markDirty(entity);
     };
     registry->emplace<RotateMovement>(entity, movement);
     door.state = CLOSING;
@@ -58,15 +60,15 @@ systems::DoorPersister::createTablesIfNeeded()
           "FOREIGN KEY (open_movement_id) REFERENCES RotateMovement(id), "
           "FOREIGN KEY (close_movement_id) REFERENCES RotateMovement(id) "
           ")");
+  db.exec("CREATE INDEX IF NOT EXISTS DoorEntity ON Door (entity_id)");
 }
 
 void
-updateDoor(SQLite::Database& db, int entityId, DoorState state)
+updateDoor(WriteBehind::Connection& connection, int64_t entityId, DoorState state)
 {
-  SQLite::Statement updateDoor(db,
-                               "UPDATE Door SET "
-                               "state = ? "
-                               "WHERE entity_id = ?");
+  auto& updateDoor = connection.statement("UPDATE Door SET "
+                                          "state = ? "
+                                          "WHERE entity_id = ?");
 
   updateDoor.bind(1, (int)state);
   updateDoor.bind(2, entityId);
@@ -75,17 +77,16 @@ updateDoor(SQLite::Database& db, int entityId, DoorState state)
 }
 
 void
-insertDoor(SQLite::Database& db,
-           int entityId,
+insertDoor(WriteBehind::Connection& connection,
+           int64_t entityId,
            int openMovementId,
            int closeMovementId,
            DoorState state)
 {
-  std::stringstream insertDoorQuery;
-  insertDoorQuery << "INSERT INTO Door (entity_id, open_movement_id, "
-                     "close_movement_id, state) "
-                  << "VALUES (?, ?, ?, ?)";
-  SQLite::Statement insertDoorStmt(db, insertDoorQuery.str());
+  auto& insertDoorStmt =
+    connection.statement("INSERT INTO Door (entity_id, open_movement_id, "
+                         "close_movement_id, state) "
+                         "VALUES (?, ?, ?, ?)");
 
   insertDoorStmt.bind(1, entityId);
   insertDoorStmt.bind(2, openMovementId);
@@ -99,75 +100,66 @@ void
 systems::DoorPersister::saveAll()
 {
   auto view = registry->view<Persistable, Door>();
-  SQLite::Database& db = registry->getDatabase();
+  for (auto entity : view) {
+    save(entity);
+  }
+}
 
-  db.exec("BEGIN TRANSACTION");
-  for (auto [entity, persist, door] : view.each()) {
+void
+systems::DoorPersister::save(entt::entity entity)
+{
+  if (!registry->all_of<Persistable, Door>(entity)) {
+    return;
+  }
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  Door door = registry->get<Door>(entity);
+  stage(entityId, [entityId, door](WriteBehind::Connection& connection) {
     // Check if Door exists
-    SQLite::Statement checkDoor(
-      db,
+    auto& checkDoor = connection.statement(
       "SELECT id, open_movement_id, close_movement_id FROM Door WHERE "
       "entity_id = ?");
-    checkDoor.bind(1, persist.entityId);
+    checkDoor.bind(1, entityId);
 
     if (checkDoor.executeStep()) {
       int openMovementId = checkDoor.getColumn(1).getInt();
       int closeMovementId = checkDoor.getColumn(2).getInt();
+      checkDoor.reset();
 
-      updateMovement(db, openMovementId, door.openMovement);
-      updateMovement(db, closeMovementId, door.closeMovement);
+      updateMovement(connection, openMovementId, door.openMovement);
+      updateMovement(connection, closeMovementId, door.closeMovement);
 
-      updateDoor(db, persist.entityId, door.state);
+      updateDoor(connection, entityId, door.state);
     } else {
-      int openMovementId = insertMovement(db, door.openMovement);
-      int closeMovementId = insertMovement(db, door.closeMovement);
+      int openMovementId = insertMovement(connection, door.openMovement);
+      int closeMovementId = insertMovement(connection, door.closeMovement);
       insertDoor(
-        db, persist.entityId, openMovementId, closeMovementId, door.state);
+        connection, entityId, openMovementId, closeMovementId, door.state);
     }
-  }
-  db.exec("COMMIT");
+  });
 }
 
-void
-systems::DoorPersister::save(entt::entity)
+// both movements are joined in so loading doesn't go back to the database
+// for every door. Left joined, so a door whose movement row is gone still
+// loads.
+std::string
+systems::DoorPersister::selectAllQuery()
 {
+  return "SELECT d.entity_id, d.state, "
+         "o.axis_x, o.axis_y, o.axis_z, o.degrees, o.degrees_per_second, "
+         "c.axis_x, c.axis_y, c.axis_z, c.degrees, c.degrees_per_second "
+         "FROM Door d "
+         "LEFT JOIN RotateMovement o ON o.id = d.open_movement_id "
+         "LEFT JOIN RotateMovement c ON c.id = d.close_movement_id "
+         "ORDER BY d.entity_id";
 }
 
 void
-systems::DoorPersister::loadAll()
+systems::DoorPersister::loadRow(entt::entity entity, SQLite::Statement& query)
 {
-  auto view = registry->view<Persistable>();
-  SQLite::Database& db = registry->getDatabase();
-
-  // Cache query data
-  std::unordered_map<int, Door> doorDataCache;
-
-  // Prepare the query
-  SQLite::Statement query(
-    db,
-    "SELECT entity_id, open_movement_id, close_movement_id, state FROM Door");
-
-  // Fetch results from the database
-  while (query.executeStep()) {
-    int entityId = query.getColumn(0).getInt();
-    int openMovementId = query.getColumn(1).getInt();
-    int closeMovementId = query.getColumn(2).getInt();
-    DoorState state = static_cast<DoorState>(query.getColumn(3).getInt());
-
-    auto openMovement = getMovementData(db, openMovementId);
-    auto closeMovement = getMovementData(db, closeMovementId);
-    auto pair = std::pair(entityId, Door{ openMovement, closeMovement, state });
-    doorDataCache.insert(pair);
-  }
-
-  // Construct Door Components
-  for (auto [entity, persist] : view.each()) {
-    auto it = doorDataCache.find(persist.entityId);
-    if (it != doorDataCache.end()) {
-      auto& [openMovement, closeMovement, state] = it->second;
-      registry->emplace<Door>(entity, openMovement, closeMovement, state);
-    }
-  }
+  DoorState state = static_cast<DoorState>(query.getColumn(1).getInt());
+  auto openMovement = movementFromColumns(query, 2);
+  auto closeMovement = movementFromColumns(query, 7);
+  registry->emplace<Door>(entity, openMovement, closeMovement, state);
 }
 
 void
@@ -178,26 +170,32 @@ systems::DoorPersister::load(entt::entity)
 void
 systems::DoorPersister::depersistIfGone(entt::entity entity)
 {
-  auto persistable = registry->get<Persistable>(entity);
-  auto& db = registry->getDatabase();
-  try {
-    SQLite::Statement query(db,
-                            "SELECT open_movement_id, close_movement_id "
-                            "FROM Door where entity_id = ?");
-    query.bind(1, persistable.entityId);
-    query.executeStep();
+  if (registry->any_of<Door>(entity)) {
+    return;
+  }
+  int64_t entityId = registry->get<Persistable>(entity).entityId;
+  stage(entityId, [this, entityId](WriteBehind::Connection& connection) {
+    auto& query = connection.statement("SELECT open_movement_id, "
+                                       "close_movement_id "
+                                       "FROM Door where entity_id = ?");
+    query.bind(1, entityId);
+    if (!query.executeStep()) {
+      return;
+    }
     int64_t open_movement_id = query.getColumn(0).getInt64();
     int64_t close_movment_id = query.getColumn(1).getInt64();
+    query.reset();
 
-    SQLite::Statement deleteQuery(db,
-                                  "DELETE FROM RotateMovement WHERE id = ?");
+    auto& deleteQuery =
+      connection.statement("DELETE FROM RotateMovement WHERE id = ?");
     deleteQuery.bind(1, open_movement_id);
     deleteQuery.exec();
     deleteQuery.reset();
     deleteQuery.bind(1, close_movment_id);
     deleteQuery.exec();
 
-    depersistIfGoneTyped<DoorPersister>(entity);
-  } catch (...) {
-  }
+    auto& deleteDoor = connection.statement(this->deleteQuery);
+    deleteDoor.bind(1, entityId);
+    deleteDoor.exec();
+  });
 }
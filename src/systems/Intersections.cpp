@@ -9,10 +9,13 @@ emplaceBoundingSphere(std::shared_ptr<EntityRegistry> registry,
 {
   auto [model, positionable] = registry->get<Model, Positionable>(entity);
 
-  auto boundingSphere = model.getBoundingSphere(positionable.scale);
-  boundingSphere.center += positionable.pos - positionable.origin;
+  // the model space sphere carried into the world by the cached model matrix
+  auto boundingSphere = model.getBoundingSphere();
+  glm::vec3 center =
+    positionable.modelMatrix * glm::vec4(boundingSphere.center, 1.0f);
+  float scale = glm::length(glm::vec3(positionable.modelMatrix[0]));
   registry->emplace_or_replace<BoundingSphere>(
-    entity, boundingSphere.center, boundingSphere.radius);
+    entity, center, boundingSphere.radius * scale);
 }
 
 bool
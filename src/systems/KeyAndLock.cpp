@@ -1,7 +1,7 @@
 #include "systems/KeyAndLock.h"
 #include "components/Key.h"
 #include "components/Lock.h"
-#include "model.h"
+#include "components/Positionable.h"
 #include "systems/Door.h"
 
 void
@@ -14,6 +14,7 @@ systems::turnKey(std::shared_ptr<EntityRegistry> registry, entt::entity entity)
       movement.onFinish = [registry, entity]() -> void {
         auto [key, keyPos] = registry->get<Key, Positionable>(entity);
         key.state = TURNED;
+        registry->markDirty(entity);
         auto lockView = registry->view<Persistable, Lock, Positionable>();
         for (auto [entity, persistable, lock, positionable] : lockView.each()) {
           if (persistable.entityId == key.lockable) {
@@ -27,6 +28,7 @@ systems::turnKey(std::shared_ptr<EntityRegistry> registry, entt::entity entity)
                 distances.y <= lock.tolerance.y &&
                 distances.z <= lock.tolerance.z) {
               lock.state = UNLOCKED;
+              registry->markDirty(entity);
               systems::openDoor(registry, entity);
             }
           }
@@ -48,6 +50,7 @@ systems::unturnKey(std::shared_ptr<EntityRegistry> registry,
       movement.onFinish = [registry, entity]() -> void {
         auto [key, keyPos] = registry->get<Key, Positionable>(entity);
         key.state = UNTURNED;
+        registry->markDirty(entity);
         auto lockView = registry->view<Persistable, Lock, Positionable>();
         for (auto [entity, persistable, lock, positionable] : lockView.each()) {
           if (persistable.entityId == key.lockable) {
@@ -58,6 +61,7 @@ systems::unturnKey(std::shared_ptr<EntityRegistry> registry,
                 distances.y <= lock.tolerance.y &&
                 distances.z <= lock.tolerance.z) {
               lock.state = LOCKED;
+              registry->markDirty(entity);
               systems::closeDoor(registry, entity);
             }
           }
@@ -0,0 +1,284 @@
+#include "systems/Transforms.h"
+#include "SystemScheduler.h"
+#include "TransformKernel.h"
+#include "components/Parent.h"
+#include "components/Positionable.h"
+#include <unordered_set>
+
+namespace {
+
+// enough entities per chunk that handing the chunk to a worker is worth it,
+// a multiple of the kernel's width so only the last chunk has a scalar tail
+const size_t UPDATE_GRAIN = 32 * TransformBatch::WIDTH;
+
+// Set whenever a Parent or Positionable comes, goes or is patched, so the
+// children lists are only walked again when an attachment could change.
+struct HierarchyState
+{
+  bool changed = true;
+  uint64_t locatorGeneration = 0;
+  uint64_t frame = 0;
+};
+
+void
+hierarchyChanged(entt::registry& registry, entt::entity)
+{
+  registry.ctx().get<HierarchyState>().changed = true;
+}
+
+HierarchyState&
+hierarchyState(EntityRegistry& registry)
+{
+  if (!registry.ctx().contains<HierarchyState>()) {
+    registry.ctx().emplace<HierarchyState>();
+    registry.on_construct<Parent>().connect<&hierarchyChanged>();
+    registry.on_update<Parent>().connect<&hierarchyChanged>();
+    registry.on_destroy<Parent>().connect<&hierarchyChanged>();
+    registry.on_construct<Positionable>().connect<&hierarchyChanged>();
+    registry.on_destroy<Positionable>().connect<&hierarchyChanged>();
+  }
+  return registry.ctx().get<HierarchyState>();
+}
+
+// The parent may already have been moved this frame, so the offset is taken
+// against the matrix it was last placed with rather than its fields. That's
+// the matrix its children are carried from, so the parent's move this frame
+// carries the child too.
+void
+attach(std::shared_ptr<EntityRegistry> registry,
+       entt::entity child,
+       entt::entity parent)
+{
+  auto& parentPositionable = registry->get<Positionable>(parent);
+  auto& childPositionable = registry->get<Positionable>(child);
+  glm::mat4 parentMatrix = parentPositionable.modelMatrix;
+  glm::mat4 offset =
+    glm::inverse(parentMatrix) * childPositionable.transform();
+  glm::mat3 normalOffset = glm::transpose(glm::inverse(glm::mat3(offset)));
+  registry->emplace_or_replace<Attached>(
+    child, parent, offset, normalOffset, parentMatrix, (uint64_t)0);
+}
+
+// true when child is entity itself or one of the parents it's attached under
+bool
+isAncestor(EntityRegistry& registry, entt::entity child, entt::entity entity)
+{
+  for (auto current = entity;;) {
+    if (current == child) {
+      return true;
+    }
+    auto attached = registry.try_get<Attached>(current);
+    if (attached == NULL) {
+      return false;
+    }
+    current = attached->parent;
+  }
+}
+
+// attaches every child its Parent lists, detaches children that aren't
+// listed any more. A child listed by two parents stays with the first, and
+// a child that would close a cycle isn't attached. Nothing to do unless a
+// Parent or Positionable changed or an id resolves differently.
+void
+attachChildren(std::shared_ptr<EntityRegistry> registry)
+{
+  auto& state = hierarchyState(*registry);
+  if (!state.changed &&
+      state.locatorGeneration == registry->getLocatorGeneration()) {
+    return;
+  }
+  state.changed = false;
+  state.locatorGeneration = registry->getLocatorGeneration();
+  uint64_t frame = ++state.frame;
+
+  auto parents = registry->view<Parent, Positionable>();
+  for (auto [entity, parent, positionable] : parents.each()) {
+    for (auto child : parent.children(*registry)) {
+      if (!registry->all_of<Positionable>(child)) {
+        continue;
+      }
+      auto attached = registry->try_get<Attached>(child);
+      if (attached != NULL && attached->parent != entity &&
+          attached->seen == frame) {
+        continue;
+      }
+      if (attached == NULL || attached->parent != entity) {
+        if (isAncestor(*registry, child, entity)) {
+          continue;
+        }
+        attach(registry, child, entity);
+        attached = &registry->get<Attached>(child);
+      }
+      attached->seen = frame;
+    }
+  }
+
+  std::vector<entt::entity> detached;
+  for (auto [entity, attached] : registry->view<Attached>().each()) {
+    if (attached.seen != frame) {
+      detached.push_back(entity);
+    }
+  }
+  registry->remove<Attached>(detached.begin(), detached.end());
+}
+
+// every ancestor of a damaged child, the subtrees worth walking when their
+// root hasn't moved
+std::unordered_set<entt::entity>
+damagedPaths(EntityRegistry& registry)
+{
+  std::unordered_set<entt::entity> onPath;
+  auto children = registry.view<Attached, Positionable>();
+  for (auto [entity, attached, positionable] : children.each()) {
+    if (!positionable.damaged) {
+      continue;
+    }
+    // stops at the root, or where an earlier child already marked the rest
+    for (auto current = attached.parent; onPath.insert(current).second;) {
+      auto above = registry.try_get<Attached>(current);
+      if (above == NULL) {
+        break;
+      }
+      current = above->parent;
+    }
+  }
+  return onPath;
+}
+
+void
+updateSubtree(std::shared_ptr<EntityRegistry> registry,
+              entt::entity entity,
+              Positionable* parent,
+              bool parentMoved,
+              const std::unordered_set<entt::entity>& onDamagedPath,
+              bool& updatedSomething,
+              std::vector<entt::entity>* movedEntities)
+{
+  auto& positionable = registry->get<Positionable>(entity);
+  bool moved = parentMoved || positionable.damaged;
+  if (positionable.damaged) {
+    // moved directly, so its place relative to the parent changes. Its
+    // fields were set while the parent was still where it was placed
+    // against, so when the parent has moved since, the child is carried by
+    // that move too.
+    positionable.update();
+    registry->markDirty(entity);
+    if (parent != NULL) {
+      auto& attached = registry->get<Attached>(entity);
+      attached.offset =
+        glm::inverse(attached.parentMatrix) * positionable.modelMatrix;
+      attached.normalOffset =
+        glm::transpose(glm::inverse(glm::mat3(attached.offset)));
+      if (attached.parentMatrix != parent->modelMatrix) {
+        positionable.follow(parent->modelMatrix * attached.offset,
+                            parent->normalMatrix * attached.normalOffset);
+        attached.parentMatrix = parent->modelMatrix;
+      }
+    }
+  } else if (parentMoved) {
+    auto& attached = registry->get<Attached>(entity);
+    positionable.follow(parent->modelMatrix * attached.offset,
+                        parent->normalMatrix * attached.normalOffset);
+    attached.parentMatrix = parent->modelMatrix;
+    registry->markDirty(entity);
+  }
+  if (moved && movedEntities != NULL) {
+    movedEntities->push_back(entity);
+  }
+  updatedSomething |= moved;
+
+  auto asParent = registry->try_get<Parent>(entity);
+  if (asParent == NULL) {
+    return;
+  }
+  for (auto child : asParent->children(*registry)) {
+    auto attached = registry->try_get<Attached>(child);
+    if (attached == NULL || attached->parent != entity) {
+      continue;
+    }
+    if (moved || registry->get<Positionable>(child).damaged ||
+        onDamagedPath.contains(child)) {
+      updateSubtree(registry,
+                    child,
+                    &positionable,
+                    moved,
+                    onDamagedPath,
+                    updatedSomething,
+                    movedEntities);
+    }
+  }
+}
+
+}
+
+// Parents are always updated before their children. A subtree is only
+// walked when its root moved or something under it was damaged, and a child's
+// matrices are computed once, either from its own fields when it was moved
+// directly or from its parent's when it's carried along. Damaged entities
+// outside any hierarchy depend on nothing else, so their matrices are
+// computed by the batched kernel in parallel chunks and only the registry
+// bookkeeping after is serial.
+bool
+systems::updateTransforms(std::shared_ptr<EntityRegistry> registry,
+                          SystemScheduler* scheduler,
+                          std::vector<entt::entity>* moved)
+{
+  attachChildren(registry);
+  auto onDamagedPath = damagedPaths(*registry);
+
+  bool updatedSomething = false;
+  std::vector<entt::entity> loose;
+  std::vector<Positionable*> looseMoved;
+  auto roots = registry->view<Positionable>(entt::exclude<Attached>);
+  for (auto [entity, positionable] : roots.each()) {
+    if (registry->all_of<Parent>(entity)) {
+      if (positionable.damaged || onDamagedPath.contains(entity)) {
+        updateSubtree(registry,
+                      entity,
+                      NULL,
+                      false,
+                      onDamagedPath,
+                      updatedSomething,
+                      moved);
+      }
+    } else if (positionable.damaged) {
+      loose.push_back(entity);
+      looseMoved.push_back(&positionable);
+    }
+  }
+  if (loose.empty()) {
+    return updatedSomething;
+  }
+
+  // per call, World and every Simulation can be stepping at once
+  TransformBatch batch;
+  batch.resize(looseMoved.size());
+  auto updateRange = [&looseMoved, &batch](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      auto positionable = looseMoved[i];
+      batch.set(i,
+                positionable->pos,
+                positionable->origin,
+                positionable->rotate,
+                positionable->scale);
+    }
+    batch.compute(begin, end);
+    for (size_t i = begin; i < end; i++) {
+      looseMoved[i]->modelMatrix = batch.modelMatrices[i];
+      looseMoved[i]->normalMatrix = batch.normalMatrices[i];
+      looseMoved[i]->damaged = false;
+    }
+  };
+  if (scheduler != NULL) {
+    scheduler->parallelFor(loose.size(), UPDATE_GRAIN, updateRange);
+  } else {
+    updateRange(0, loose.size());
+  }
+  for (auto entity : loose) {
+    registry->markDirty(entity);
+  }
+  if (moved != NULL) {
+    moved->insert(moved->end(), loose.begin(), loose.end());
+  }
+  return true;
+}
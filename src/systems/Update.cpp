@@ -2,22 +2,23 @@
 #include "components/BoundingSphere.h"
 #include "model.h"
 #include "systems/Intersections.h"
-#include "systems/Light.h"
 
-void
-systems::updateAll(std::shared_ptr<EntityRegistry> registry, Renderer* renderer)
+// bounding spheres follow whatever updateTransforms moved
+bool
+systems::updateAll(std::shared_ptr<EntityRegistry> registry,
+                   Renderer* renderer,
+                   SystemScheduler* scheduler)
 {
-  bool updatedSomething = false;
-  auto view = registry->view<Positionable>();
-  for (auto [entity, positionable] : view.each()) {
-    if (positionable.damaged) {
-      systems::update(registry, entity);
-      updatedSomething = true;
-    }
+  std::vector<entt::entity> moved;
+  if (!updateTransforms(registry, scheduler, &moved)) {
+    return false;
   }
-  if (updatedSomething) {
-    systems::updateLighting(registry, renderer);
+  for (auto entity : moved) {
+    if (registry->all_of<BoundingSphere>(entity)) {
+      emplaceBoundingSphere(registry, entity);
+    }
   }
+  return true;
 }
 
 void
@@ -25,6 +26,7 @@ systems::update(std::shared_ptr<EntityRegistry> registry, entt::entity entity)
 {
   auto& positionable = registry->get<Positionable>(entity);
   positionable.update();
+  registry->markDirty(entity);
 
   auto hasBoundingSphere = registry->all_of<BoundingSphere>(entity);
   if (hasBoundingSphere) {
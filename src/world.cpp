@@ -2,8 +2,16 @@
 #include "app.h"
 #include "chunk.h"
 #include "components/BoundingSphere.h"
+#include "components/Door.h"
+#include "components/Key.h"
+#include "components/Light.h"
+#include "components/Lock.h"
+#include "components/Parent.h"
+#include "components/RotateMovement.h"
+#include "components/TranslateMovement.h"
 #include "coreStructs.h"
 #include "enkimi.h"
+#include "FrameScheduler.h"
 #include "glm/geometric.hpp"
 #include "loader.h"
 #include "renderer.h"
@@ -23,6 +31,7 @@
 #include <vector>
 #include "systems/ApplyTranslation.h"
 #include "systems/Intersections.h"
+#include "systems/Light.h"
 #include "systems/Scripts.h"
 #include "systems/Update.h"
 #include "utility.h"
@@ -50,6 +59,7 @@ World::World(shared_ptr<EntityRegistry> registry,
   dynamicCube = make_shared<DynamicCube>(glm::vec3(0.0f, 8.0f, 0.0f),
                                          glm::vec3(0.1f, 0.1f, 0.1f));
   dynamicObjects->addObject(dynamicCube);
+  addSystems();
 
   /* Shows how to init entity and components. Will need to do this with imgui
   auto npc = registry->createPersistent();
@@ -67,6 +77,46 @@ World::World(shared_ptr<EntityRegistry> registry,
   */
 }
 
+// the per frame systems and what they touch. The movement systems also
+// write the components their onFinish callbacks change.
+void
+World::addSystems()
+{
+  using S = SystemScheduler;
+  scheduler.add("applyRotation",
+                S::components<>(),
+                S::components<Positionable, RotateMovement, Key, Lock, Door>(),
+                [this]() { systems::applyRotation(registry, tickSeconds); });
+  scheduler.add(
+    "applyTranslations",
+    S::components<>(),
+    S::components<Positionable, TranslateMovement>(),
+    [this]() { systems::applyTranslations(registry, tickSeconds); });
+  // updating lighting renders the shadow maps
+  scheduler.add(
+    "updateAll",
+    S::components<Parent, Model, Light>(),
+    S::components<Positionable, Attached, BoundingSphere>(),
+    [this]() {
+      if (systems::updateAll(registry, renderer, &scheduler)) {
+        relight();
+      }
+    },
+    true);
+}
+
+void
+World::relight()
+{
+  if (frames == NULL) {
+    systems::updateLighting(registry, renderer);
+    return;
+  }
+  frames->defer(FrameScheduler::SHADOWS, [this]() {
+    systems::updateLighting(registry, renderer);
+  });
+}
+
 void
 World::initLogger(spdlog::sink_ptr loggerSink)
 {
@@ -126,9 +176,15 @@ World::initChunks()
 
 World::~World() {}
 
+// During play the mesh waits for what's left of the frame, so every edit
+// made in one frame meshes once.
 void
 World::mesh(bool realTime)
 {
+  if (realTime && frames != NULL) {
+    frames->defer(FrameScheduler::MESHING, [this]() { mesh(false); });
+    return;
+  }
   double currentTime = glfwGetTime();
   vector<shared_ptr<ChunkMesh>> m;
   int sizeX = chunks[0][0]->getSize()[0];
@@ -696,6 +752,12 @@ World::attachRenderer(Renderer* renderer)
   this->renderer = renderer;
 }
 
+void
+World::attachFrameScheduler(FrameScheduler* frameScheduler)
+{
+  frames = frameScheduler;
+}
+
 shared_ptr<Cube>
 World::getCube(float x, float y, float z)
 {
@@ -834,12 +896,18 @@ World::cubeAction(Action toTake)
       int z = lookingAt.z + (int)lookingAt.normal.z;
       addCube(x, y, z, lookedAt->blockType());
       mesh();
+      if (cubeEditListener) {
+        cubeEditListener(x, y, z, lookedAt->blockType());
+      }
     }
     if (toTake == REMOVE_CUBE) {
       WorldPosition pos =
         translateToWorldPosition(lookingAt.x, lookingAt.y, lookingAt.z);
       removeCube(pos);
       mesh();
+      if (cubeEditListener) {
+        cubeEditListener(lookingAt.x, lookingAt.y, lookingAt.z, -1);
+      }
     }
     if (toTake == SELECT_CUBE) {
       lookedAt->toggleSelect();
@@ -860,6 +928,13 @@ World::cubeAction(Action toTake)
   }
 }
 
+void
+World::onCubeEdit(
+  function<void(int x, int y, int z, int blockType)> listener)
+{
+  cubeEditListener = listener;
+}
+
 void
 World::dynamicObjectAction(Action toTake)
 {
@@ -1001,9 +1076,10 @@ void
 World::tick()
 {
   ZoneScoped;
-  systems::applyRotation(registry);
-  systems::applyTranslations(registry);
-  systems::updateAll(registry, renderer);
+  double now = glfwGetTime();
+  tickSeconds = lastTick < 0 ? 0 : now - lastTick;
+  lastTick = now;
+  scheduler.run();
   if (dynamicObjects->damaged()) {
     renderer->updateDynamicObjects(dynamicObjects);
   }
@@ -0,0 +1,85 @@
+// gtest before Xlib, whose None and Bool macros it can't parse around
+#include <gtest/gtest.h>
+
+#include "WindowManager/AppLauncher.h"
+#include <chrono>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace WindowManager;
+
+namespace {
+
+const Window WINDOW = 0x1200007;
+
+}
+
+TEST(APP_LAUNCHER, followsProcessesToTheirParents) {
+  auto lineage = AppLauncher::lineage(getpid());
+  ASSERT_GE(lineage.size(), 1);
+  ASSERT_EQ(lineage[0], getpid());
+  if (getppid() > 1) {
+    ASSERT_EQ(lineage[1], getppid());
+  }
+  ASSERT_TRUE(AppLauncher::lineage(-1).empty());
+}
+
+// the window of a process forked by whatever was launched
+TEST(APP_LAUNCHER, claimsWindowsOfDescendants) {
+  AppLauncher launcher;
+  auto entity = (entt::entity)3;
+  // this process stands in for the launched one, its child for the app
+  auto launch = launcher.expect(entity, getpid());
+  int child = fork();
+  if (child == 0) {
+    pause();
+    _exit(0);
+  }
+  auto claimed = launcher.claim(WINDOW, child, "Some-app");
+  kill(child, SIGKILL);
+  waitpid(child, NULL, 0);
+  ASSERT_EQ(claimed, entity);
+  ASSERT_EQ(launch->window.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  ASSERT_EQ(launch->window.get(), WINDOW);
+  ASSERT_EQ(launcher.pendingCount(), 0);
+}
+
+TEST(APP_LAUNCHER, claimsByIdentifiedPidOrClass) {
+  AppLauncher launcher;
+  auto script = launcher.expect((entt::entity)1, 999999);
+  auto browser =
+    launcher.expect((entt::entity)2, 999998, std::string("Microsoft-edge"));
+  ASSERT_FALSE(launcher.claim(WINDOW, 1, "Xterm").has_value());
+  ASSERT_FALSE(
+    launcher.claim(WINDOW, std::nullopt, "Microsoft-edge-beta").has_value());
+
+  ASSERT_EQ(launcher.claim(WINDOW + 1, std::nullopt, "microsoft-edge"),
+            (entt::entity)2);
+  // a shell script's app isn't its child once it has forked away
+  launcher.identify(script, getpid());
+  ASSERT_EQ(launcher.claim(WINDOW + 2, getpid(), ""), (entt::entity)1);
+  ASSERT_EQ(script->window.get(), WINDOW + 2);
+}
+
+// a window resolves the launch whenever it comes, whoever is waiting
+TEST(APP_LAUNCHER, resolvesWaitersOnOtherThreads) {
+  AppLauncher launcher;
+  auto launch =
+    launcher.expect((entt::entity)4, 999997, std::string("Obs"));
+  std::thread substructure([&launcher]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    launcher.claim(WINDOW, std::nullopt, "Obs");
+  });
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ(launch->window.wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  substructure.join();
+  ASSERT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::seconds(1));
+
+  auto never = launcher.expect((entt::entity)5, 999996);
+  launcher.cancel(never);
+  ASSERT_EQ(launcher.pendingCount(), 0);
+}
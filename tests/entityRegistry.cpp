@@ -0,0 +1,247 @@
+#include "components/Door.h"
+#include "components/Lock.h"
+#include "components/Parent.h"
+#include "components/Scriptable.h"
+#include "entity.h"
+#include "model.h"
+#include "scratchRegistry.h"
+#include "systems/Door.h"
+#include <chrono>
+#include <gtest/gtest.h>
+
+namespace {
+
+std::shared_ptr<EntityRegistry>
+makeRegistry(std::string dbFile)
+{
+  return openRegistry<PositionablePersister,
+                      LockPersister,
+                      ParentPersister,
+                      ScriptablePersister>(dbFile);
+}
+
+// shaped like db/matrix.db: every entity is positioned, some are parents of
+// the next few entities and a few carry locks or scripts
+void
+writeSyntheticEntities(SQLite::Database& db, int count)
+{
+  SQLite::Transaction transaction(db);
+  SQLite::Statement entity(db, "INSERT INTO Entity (id) VALUES (?)");
+  SQLite::Statement positionable(
+    db,
+    "INSERT INTO Positionable (entity_id, pos_x, pos_y, pos_z, origin_x, "
+    "origin_y, origin_z, rot_x, rot_y, rot_z, scale) "
+    "VALUES (?, ?, ?, ?, 0, 0, 0, 0, ?, 0, 1)");
+  SQLite::Statement lock(
+    db,
+    "INSERT INTO Lock (entity_id, position_x, position_y, position_z, "
+    "tolerance_x, tolerance_y, tolerance_z, state) "
+    "VALUES (?, 0, 1, 0, 0.1, 0.1, 0.1, 0)");
+  SQLite::Statement parent(
+    db, "INSERT INTO Parent (entity_id, child_id) VALUES (?, ?)");
+  SQLite::Statement scriptable(
+    db,
+    "INSERT INTO Scriptable (entity_id, script, language) VALUES (?, ?, 2)");
+  for (int id = 1; id <= count; id++) {
+    entity.bind(1, id);
+    entity.exec();
+    entity.reset();
+
+    positionable.bind(1, id);
+    positionable.bind(2, id * 1.0);
+    positionable.bind(3, id * 2.0);
+    positionable.bind(4, id * 3.0);
+    positionable.bind(5, id % 360);
+    positionable.exec();
+    positionable.reset();
+
+    if (id % 10 == 0) {
+      for (int child = id + 1; child <= id + 3 && child <= count; child++) {
+        parent.bind(1, id);
+        parent.bind(2, child);
+        parent.exec();
+        parent.reset();
+      }
+    }
+    if (id % 100 == 0) {
+      lock.bind(1, id);
+      lock.exec();
+      lock.reset();
+    }
+    if (id % 1000 == 0) {
+      scriptable.bind(1, id);
+      scriptable.bind(2, "print(" + std::to_string(id) + ")");
+      scriptable.exec();
+      scriptable.reset();
+    }
+  }
+  transaction.commit();
+}
+
+}
+
+TEST(ENTITY_REGISTRY, loadAllJoinsComponentsToTheirEntities) {
+  auto dbFile = scratchDatabase("loadAllJoins");
+  auto writer = makeRegistry(dbFile);
+  writeSyntheticEntities(writer->getDatabase(), 50);
+
+  auto registry = makeRegistry(dbFile);
+  registry->loadAll();
+
+  ASSERT_EQ(registry->view<Persistable>().size(), 50);
+  ASSERT_EQ(registry->view<Positionable>().size(), 50);
+  // 50 has no children left to own
+  ASSERT_EQ(registry->view<Parent>().size(), 4);
+  for (int id : { 1, 17, 50 }) {
+    auto entity = registry->locateEntity(id);
+    ASSERT_TRUE(entity.has_value());
+    auto& positionable = registry->get<Positionable>(entity.value());
+    ASSERT_FLOAT_EQ(positionable.pos.x, id * 1.0);
+    ASSERT_FLOAT_EQ(positionable.pos.z, id * 3.0);
+  }
+  auto parent = registry->get<Parent>(registry->locateEntity(20).value());
+  ASSERT_EQ(parent.childrenIds, std::vector<int>({ 21, 22, 23 }));
+}
+
+TEST(ENTITY_REGISTRY, loadAllSkipsRowsWithoutAnEntity) {
+  auto dbFile = scratchDatabase("loadAllOrphans");
+  auto writer = makeRegistry(dbFile);
+  writeSyntheticEntities(writer->getDatabase(), 20);
+  writer->getDatabase().exec("DELETE FROM Entity WHERE id IN (1, 10, 20)");
+
+  auto registry = makeRegistry(dbFile);
+  registry->loadAll();
+
+  ASSERT_EQ(registry->view<Positionable>().size(), 17);
+  ASSERT_EQ(registry->view<Parent>().size(), 0);
+  ASSERT_FALSE(registry->locateEntity(10).has_value());
+  ASSERT_TRUE(
+    registry->all_of<Positionable>(registry->locateEntity(11).value()));
+}
+
+TEST(ENTITY_REGISTRY, writesBehindAndReloads) {
+  auto dbFile = scratchDatabase("writeBehind");
+  {
+    auto registry = makeRegistry(dbFile);
+    registry->loadAll();
+    auto entity = registry->createPersistent();
+    registry->emplace<Positionable>(entity,
+                                    glm::vec3(1, 2, 3),
+                                    glm::vec3(0),
+                                    glm::vec3(0, 90, 0),
+                                    2.0f);
+    registry->markDirty(entity);
+    auto gone = registry->createPersistent();
+    registry->emplace<Positionable>(
+      gone, glm::vec3(0), glm::vec3(0), glm::vec3(0), 1.0f);
+    registry->markDirty(gone);
+    registry->depersist(gone);
+    registry->flush();
+  }
+
+  auto registry = makeRegistry(dbFile);
+  registry->loadAll();
+  ASSERT_EQ(registry->view<Persistable>().size(), 1);
+  auto entity = registry->locateEntity(1);
+  ASSERT_TRUE(entity.has_value());
+  auto& positionable = registry->get<Positionable>(entity.value());
+  ASSERT_FLOAT_EQ(positionable.pos.y, 2);
+  ASSERT_FLOAT_EQ(positionable.rotate.y, 90);
+  ASSERT_FLOAT_EQ(positionable.scale, 2);
+}
+
+// an entity moving every frame is written once a flush interval, with
+// wherever it is by then
+TEST(ENTITY_REGISTRY, stagesDirtyEntitiesOnceAFlushInterval) {
+  auto registry = makeRegistry(scratchDatabase("stageDirty"));
+  auto entity = registry->createPersistent();
+  auto& positionable = registry->emplace<Positionable>(
+    entity, glm::vec3(1, 0, 0), glm::vec3(0), glm::vec3(0), 1.0f);
+  registry->markDirty(entity);
+  registry->stageDirty();
+  for (int frame = 2; frame <= 10; frame++) {
+    positionable.pos.x = frame;
+    registry->markDirty(entity);
+    registry->stageDirty();
+  }
+  registry->getWriteBehind().flush();
+  auto& stored = registry->statement(
+    "SELECT pos_x FROM Positionable WHERE entity_id = 1");
+  ASSERT_TRUE(stored.executeStep());
+  ASSERT_FLOAT_EQ(stored.getColumn(0).getDouble(), 1);
+  stored.reset();
+
+  registry->flush();
+  ASSERT_TRUE(stored.executeStep());
+  ASSERT_FLOAT_EQ(stored.getColumn(0).getDouble(), 10);
+  stored.reset();
+}
+
+TEST(ENTITY_REGISTRY, loadAllKeepsDoorsWithoutTheirMovement) {
+  auto dbFile = scratchDatabase("loadAllMissingMovement");
+  {
+    auto registry = openRegistry<systems::DoorPersister>(dbFile);
+    registry->loadAll();
+    auto entity = registry->createPersistent();
+    registry->emplace<Door>(entity,
+                            RotateMovement(90, 45, glm::vec3(0, 1, 0)),
+                            RotateMovement(-90, 45, glm::vec3(0, 1, 0)),
+                            CLOSED);
+    registry->markDirty(entity);
+    registry->flush();
+    registry->getDatabase().exec(
+      "DELETE FROM RotateMovement WHERE id = "
+      "(SELECT close_movement_id FROM Door)");
+  }
+
+  auto registry = openRegistry<systems::DoorPersister>(dbFile);
+  registry->loadAll();
+  ASSERT_EQ(registry->view<Door>().size(), 1);
+  auto& door = registry->get<Door>(registry->locateEntity(1).value());
+  ASSERT_EQ(door.state, CLOSED);
+  ASSERT_DOUBLE_EQ(door.openMovement.degrees, 90);
+  ASSERT_DOUBLE_EQ(door.closeMovement.degrees, 0);
+  ASSERT_FALSE(glm::any(glm::isnan(door.closeMovement.axis)));
+}
+
+TEST(ENTITY_REGISTRY, benchmarkLoadAll100k) {
+  auto dbFile = scratchDatabase("loadAll100k");
+  auto writer = makeRegistry(dbFile);
+  writeSyntheticEntities(writer->getDatabase(), 100000);
+
+  auto registry = makeRegistry(dbFile);
+  auto start = std::chrono::steady_clock::now();
+  registry->loadAll();
+  auto end = std::chrono::steady_clock::now();
+  double ms = std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << "EntityRegistry::loadAll 100k entities: " << ms << "ms"
+            << std::endl;
+  RecordProperty("ms", (int)ms);
+  ASSERT_EQ(registry->view<Positionable>().size(), 100000);
+  ASSERT_EQ(registry->view<Lock>().size(), 1000);
+  ASSERT_EQ(registry->storage<Scriptable>().size(), 100);
+}
+
+TEST(ENTITY_REGISTRY, parentChildrenFollowDestroyedEntities) {
+  auto registry = makeRegistry(scratchDatabase("parentChildren"));
+  auto parent = registry->createPersistent();
+  auto first = registry->createPersistent();
+  auto second = registry->createPersistent();
+  int firstId = registry->get<Persistable>(first).entityId;
+  int secondId = registry->get<Persistable>(second).entityId;
+  registry->emplace<Parent>(parent, std::vector<int>{ firstId, secondId });
+
+  auto& component = registry->get<Parent>(parent);
+  ASSERT_EQ(component.children(*registry),
+            std::vector<entt::entity>({ first, second }));
+
+  registry->destroy(first);
+  ASSERT_FALSE(registry->locateEntity(firstId).has_value());
+  ASSERT_EQ(component.children(*registry),
+            std::vector<entt::entity>({ second }));
+
+  registry->depersist(second);
+  ASSERT_TRUE(component.children(*registry).empty());
+  ASSERT_FALSE(registry->locateEntity(-1).has_value());
+  ASSERT_FALSE(registry->locateEntity(1000).has_value());
+}
@@ -0,0 +1,132 @@
+#include "FrameScheduler.h"
+#include <gtest/gtest.h>
+
+namespace {
+
+const double TARGET = 1.0 / 60;
+
+// a clock the test moves by hand
+struct FakeClock
+{
+  double now = 0;
+  FrameScheduler::Clock clock()
+  {
+    return [this]() { return now; };
+  }
+};
+
+// frames of the given lengths, one after another
+void
+runFrames(FrameScheduler& frames, FakeClock& time, double seconds, int count)
+{
+  for (int i = 0; i < count; i++) {
+    frames.beginFrame();
+    time.now += seconds;
+  }
+  frames.beginFrame();
+}
+
+}
+
+TEST(FRAME_SCHEDULER, reportsPercentilesOfTheKeptFrames) {
+  FakeClock time;
+  FrameScheduler frames(time.clock(), TARGET, 0, 100);
+  frames.beginFrame();
+  // 1ms to 100ms, in an order that isn't sorted
+  for (int i = 0; i < 100; i++) {
+    time.now += ((i * 37) % 100 + 1) / 1000.0;
+    frames.beginFrame();
+  }
+  auto percentiles = frames.percentiles();
+  ASSERT_NEAR(percentiles.p50, 0.050, 1e-9);
+  ASSERT_NEAR(percentiles.p95, 0.095, 1e-9);
+  ASSERT_NEAR(percentiles.p99, 0.099, 1e-9);
+  // only the last 100 are kept
+  runFrames(frames, time, 0.002, 100);
+  ASSERT_NEAR(frames.percentile(0.99), 0.002, 1e-9);
+}
+
+TEST(FRAME_SCHEDULER, timesPhasesAgainstTheirBudget) {
+  FakeClock time;
+  FrameScheduler frames(time.clock(), TARGET);
+  int render = frames.addPhase("render", 0.5);
+  int world = frames.addPhase("world", 0.1);
+  frames.beginFrame();
+  time.now += 0.004;
+  frames.endPhase(render);
+  time.now += 0.003;
+  frames.endPhase(world);
+  ASSERT_NEAR(frames.getPhases()[render].seconds, 0.004, 1e-9);
+  ASSERT_EQ(frames.getPhases()[render].overruns, 0);
+  ASSERT_NEAR(frames.getPhases()[world].seconds, 0.003, 1e-9);
+  ASSERT_EQ(frames.getPhases()[world].overruns, 1);
+}
+
+TEST(FRAME_SCHEDULER, defersWorkUntilTheFrameHasTimeForIt) {
+  FakeClock time;
+  FrameScheduler frames(time.clock(), TARGET);
+  frames.setMaxDelay(FrameScheduler::MESHING, 3);
+  int meshed = 0;
+  auto mesh = [&]() {
+    time.now += 0.006;
+    meshed++;
+  };
+
+  // the first run teaches it the cost
+  frames.beginFrame();
+  frames.defer(FrameScheduler::MESHING, mesh);
+  frames.runDeferred();
+  ASSERT_EQ(meshed, 1);
+
+  // edits in a busy frame mesh once, in the next frame with room
+  frames.beginFrame();
+  time.now += 0.012;
+  frames.defer(FrameScheduler::MESHING, mesh);
+  frames.defer(FrameScheduler::MESHING, mesh);
+  frames.runDeferred();
+  ASSERT_EQ(meshed, 1);
+  ASSERT_TRUE(frames.isWaiting(FrameScheduler::MESHING));
+  frames.beginFrame();
+  time.now += 0.002;
+  frames.runDeferred();
+  ASSERT_EQ(meshed, 2);
+  ASSERT_FALSE(frames.isWaiting(FrameScheduler::MESHING));
+  ASSERT_EQ(frames.getDeferredCount(FrameScheduler::MESHING), 1);
+}
+
+TEST(FRAME_SCHEDULER, runsWorkThatWaitedItsMaximum) {
+  FakeClock time;
+  FrameScheduler frames(time.clock(), TARGET);
+  frames.setMaxDelay(FrameScheduler::PERSISTENCE, 2);
+  int saved = 0;
+  for (int frame = 0; frame < 6; frame++) {
+    frames.beginFrame();
+    // every frame over budget
+    time.now += 0.020;
+    frames.defer(FrameScheduler::PERSISTENCE, [&]() { saved++; });
+    frames.runDeferred();
+  }
+  // waits two frames each time, then runs however late it is
+  ASSERT_EQ(saved, 2);
+}
+
+TEST(FRAME_SCHEDULER, dropsVsyncWhileFramesRunLate) {
+  FakeClock time;
+  FrameScheduler frames(time.clock(), TARGET, -1, 60);
+  // every frame missing a refresh
+  runFrames(frames, time, 2 * TARGET, 60);
+  ASSERT_EQ(frames.getSwapInterval(), -1);
+  ASSERT_TRUE(frames.takeSwapIntervalChange());
+  ASSERT_FALSE(frames.takeSwapIntervalChange());
+
+  // slightly early isn't enough room to go back
+  runFrames(frames, time, 0.95 * TARGET, 60);
+  ASSERT_EQ(frames.getSwapInterval(), -1);
+  runFrames(frames, time, 0.5 * TARGET, 60);
+  ASSERT_EQ(frames.getSwapInterval(), 1);
+  ASSERT_TRUE(frames.takeSwapIntervalChange());
+
+  frames.setAdaptiveVsync(false);
+  runFrames(frames, time, 2 * TARGET, 120);
+  ASSERT_EQ(frames.getSwapInterval(), 1);
+}
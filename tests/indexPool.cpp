@@ -0,0 +1,97 @@
+#include "IndexPool.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+
+TEST(INDEX_POOL, acquiresInOrder) {
+  auto pool = IndexPool();
+  for (int i = 0; i < 200; i++) {
+    ASSERT_EQ(pool.acquireIndex(), i);
+  }
+}
+
+TEST(INDEX_POOL, reusesSmallestReleasedIndex) {
+  auto pool = IndexPool();
+  for (int i = 0; i < 200; i++) {
+    pool.acquireIndex();
+  }
+  pool.relinquishIndex(150);
+  pool.relinquishIndex(3);
+  pool.relinquishIndex(70);
+  ASSERT_EQ(pool.acquireIndex(), 3);
+  ASSERT_EQ(pool.acquireIndex(), 70);
+  ASSERT_EQ(pool.acquireIndex(), 150);
+  ASSERT_EQ(pool.acquireIndex(), 200);
+}
+
+TEST(INDEX_POOL, respectsMaxIndex) {
+  auto pool = IndexPool(2);
+  ASSERT_EQ(pool.acquireIndex(), 0);
+  ASSERT_EQ(pool.acquireIndex(), 1);
+  ASSERT_EQ(pool.acquireIndex(), 2);
+  ASSERT_EQ(pool.acquireIndex(), -1);
+  pool.relinquishIndex(1);
+  ASSERT_EQ(pool.acquireIndex(), 1);
+  ASSERT_EQ(pool.acquireIndex(), -1);
+}
+
+TEST(INDEX_POOL, ignoresUnusedIndices) {
+  auto pool = IndexPool();
+  pool.acquireIndex();
+  pool.relinquishIndex(-1);
+  pool.relinquishIndex(5);
+  pool.relinquishIndex(0);
+  pool.relinquishIndex(0);
+  ASSERT_FALSE(pool.isUsed(0));
+  ASSERT_EQ(pool.acquireIndex(), 0);
+  ASSERT_EQ(pool.acquireIndex(), 1);
+}
+
+TEST(INDEX_POOL, isUsed) {
+  auto pool = IndexPool();
+  ASSERT_FALSE(pool.isUsed(0));
+  pool.acquireIndex();
+  pool.acquireIndex();
+  ASSERT_TRUE(pool.isUsed(0));
+  ASSERT_TRUE(pool.isUsed(1));
+  pool.relinquishIndex(1);
+  ASSERT_FALSE(pool.isUsed(1));
+}
+
+TEST(INDEX_POOL, spansSummaryWords) {
+  auto pool = IndexPool();
+  for (int i = 0; i < 10000; i++) {
+    pool.acquireIndex();
+  }
+  pool.relinquishIndex(9000);
+  pool.relinquishIndex(4100);
+  pool.relinquishIndex(64);
+  ASSERT_EQ(pool.acquireIndex(), 64);
+  ASSERT_EQ(pool.acquireIndex(), 4100);
+  ASSERT_EQ(pool.acquireIndex(), 9000);
+  ASSERT_EQ(pool.acquireIndex(), 10000);
+}
+
+// micro benchmark, churns a desktop's worth of app slots the way window
+// creation and destruction does
+TEST(INDEX_POOL, benchmarkChurn) {
+  auto pool = IndexPool();
+  std::vector<int> held;
+  for (int i = 0; i < 100; i++) {
+    held.push_back(pool.acquireIndex());
+  }
+  int iterations = 1000000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    int slot = (i * 37) % held.size();
+    pool.relinquishIndex(held[slot]);
+    held[slot] = pool.acquireIndex();
+  }
+  auto end = std::chrono::steady_clock::now();
+  double ns =
+    std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+  std::cout << "IndexPool release + acquire: " << ns << "ns" << std::endl;
+  RecordProperty("nsPerCycle", (int)ns);
+  ASSERT_EQ(pool.acquireIndex(), 100);
+}
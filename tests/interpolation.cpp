@@ -0,0 +1,235 @@
+#include "MultiPlayer/Interpolation.h"
+#include "MultiPlayer/Server.h"
+#include "testClient.h"
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <thread>
+
+using namespace MultiPlayer;
+
+namespace {
+
+const double TICK = 1.0 / SNAPSHOT_RATE;
+
+Snapshot
+walkerAt(uint32_t tick, float x)
+{
+  Snapshot snapshot;
+  snapshot.tick = tick;
+  snapshot.players.push_back(
+    QuantizedPlayer::from({ 5, glm::vec3(x, 0, 0), glm::vec3(0, 0, -1) }));
+  return snapshot;
+}
+
+float
+drawnX(InterpolationBuffer& buffer, double now)
+{
+  auto players = buffer.sample(now);
+  EXPECT_EQ(players.size(), 1);
+  return players.empty() ? NAN : players[0].position.x;
+}
+
+// how far the drawn position strays from moving speed * frame time each
+// frame, root mean square
+struct Smoothness
+{
+  double onArrival = 0;
+  double interpolated = 0;
+};
+
+double
+seconds()
+{
+  return std::chrono::duration<double>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+// One client walks along x at a steady pace, sending where it is far more
+// often than the server ticks. Another watches it over a bad link and draws
+// it at 60 frames a second, both by moving it whenever a newer snapshot
+// arrives as the client used to and through an InterpolationBuffer.
+Smoothness
+watchWalker(int port, double latency, double jitter, double loss)
+{
+  const float SPEED = 2;
+  Server server;
+  EXPECT_TRUE(server.Start(port));
+  TestClient walker;
+  TestClient watcher;
+  EXPECT_TRUE(walker.connect(port));
+  EXPECT_TRUE(watcher.connect(port));
+  watcher.latency = latency;
+  watcher.jitter = jitter;
+  watcher.loss = loss;
+
+  InterpolationBuffer buffer(TICK);
+  float arrivedX = 0;
+  watcher.onReceived = [&](const Snapshot& snapshot) {
+    buffer.add(snapshot, seconds());
+  };
+  watcher.onSnapshot = [&](const Snapshot& snapshot) {
+    if (!snapshot.players.empty()) {
+      arrivedX = snapshot.players[0].state().position.x;
+    }
+  };
+
+  double start = seconds();
+  double nextFrame = start + 0.5;
+  double lastFrame = 0;
+  float lastArrived = 0;
+  float lastInterpolated = 0;
+  double arrivedError = 0;
+  double interpolatedError = 0;
+  int frames = 0;
+  while (seconds() - start < 3) {
+    walker.send(glm::vec3(SPEED * (seconds() - start), 0, 0));
+    walker.pump();
+    watcher.pump();
+    double now = seconds();
+    if (now >= nextFrame) {
+      auto players = buffer.sample(now);
+      float interpolatedX = players.empty() ? 0 : players[0].position.x;
+      if (lastFrame != 0) {
+        double expected = SPEED * (now - lastFrame);
+        arrivedError += std::pow(arrivedX - lastArrived - expected, 2);
+        interpolatedError +=
+          std::pow(interpolatedX - lastInterpolated - expected, 2);
+        frames++;
+      }
+      lastFrame = now;
+      lastArrived = arrivedX;
+      lastInterpolated = interpolatedX;
+      nextFrame += 1.0 / 60;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(4));
+  }
+  server.Stop();
+  EXPECT_GT(frames, 100);
+  return { std::sqrt(arrivedError / frames),
+           std::sqrt(interpolatedError / frames) };
+}
+
+}
+
+TEST(INTERPOLATION, drawsBetweenTheTicksEitherSide) {
+  InterpolationBuffer buffer(TICK, 2 * TICK);
+  buffer.add(walkerAt(10, 0), 10 * TICK);
+  buffer.add(walkerAt(11, 1), 11 * TICK);
+  buffer.add(walkerAt(12, 2), 12 * TICK);
+  // two ticks behind tick 12.5 is halfway from 10 to 11
+  ASSERT_NEAR(drawnX(buffer, 12.5 * TICK), 0.5, 1e-3);
+  ASSERT_NEAR(drawnX(buffer, 13.75 * TICK), 1.75, 1e-3);
+}
+
+TEST(INTERPOLATION, placesLateSnapshotsByTick) {
+  InterpolationBuffer buffer(TICK, 2 * TICK);
+  buffer.add(walkerAt(10, 0), 10 * TICK);
+  buffer.add(walkerAt(12, 4), 12 * TICK);
+  // 11 overtaken by 12, it was a detour
+  buffer.add(walkerAt(11, 3), 12.2 * TICK);
+  ASSERT_NEAR(drawnX(buffer, 13 * TICK), 3, 1e-3);
+  // arriving again changes nothing
+  buffer.add(walkerAt(11, 9), 12.3 * TICK);
+  ASSERT_NEAR(drawnX(buffer, 13 * TICK), 3, 1e-3);
+}
+
+TEST(INTERPOLATION, extrapolatesThenWaits) {
+  InterpolationBuffer buffer(TICK, 2 * TICK, 3 * TICK);
+  buffer.add(walkerAt(10, 0), 10 * TICK);
+  buffer.add(walkerAt(11, 1), 11 * TICK);
+  // nothing after 11: carry on at one a tick for up to three ticks
+  ASSERT_NEAR(drawnX(buffer, 13 * TICK), 1, 1e-3);
+  ASSERT_NEAR(drawnX(buffer, 14 * TICK), 2, 1e-3);
+  ASSERT_NEAR(drawnX(buffer, 16 * TICK), 4, 1e-3);
+  ASSERT_NEAR(drawnX(buffer, 30 * TICK), 4, 1e-3);
+  // and pick up again once snapshots do
+  buffer.add(walkerAt(28, 18), 28 * TICK);
+  buffer.add(walkerAt(29, 19), 29 * TICK);
+  ASSERT_NEAR(drawnX(buffer, 30 * TICK), 18, 1e-2);
+}
+
+TEST(INTERPOLATION, forgetsPlayersThatLeft) {
+  InterpolationBuffer buffer(TICK);
+  buffer.add(walkerAt(10, 0), 10 * TICK);
+  Snapshot empty;
+  empty.tick = 11;
+  buffer.add(empty, 11 * TICK);
+  // a late snapshot doesn't bring them back
+  buffer.add(walkerAt(9, 0), 11.5 * TICK);
+  ASSERT_TRUE(buffer.sample(12 * TICK).empty());
+}
+
+// held far enough away that the server samples it every fourth tick, on
+// ticks 3, 7, 11 and 15, and repeats the last sample in between
+TEST(INTERPOLATION, skipsRepeatedSamples) {
+  InterpolationBuffer buffer(TICK, 2 * TICK, TICK);
+  QuantizedPlayer held;
+  for (uint32_t tick = 3; tick <= 15; tick++) {
+    auto snapshot = walkerAt(tick, tick);
+    snapshot.players[0].interval = 4;
+    if (snapshot.players[0].sampledAt(tick)) {
+      held = snapshot.players[0];
+    }
+    snapshot.players[0] = held;
+    buffer.add(snapshot, tick * TICK);
+  }
+  // halfway between the samples at 7 and 11, not stuck at 7
+  ASSERT_NEAR(drawnX(buffer, 11 * TICK), 9, 1e-3);
+  // and carried on past the last for one interval
+  ASSERT_NEAR(drawnX(buffer, 20 * TICK), 18, 1e-3);
+  ASSERT_NEAR(drawnX(buffer, 30 * TICK), 19, 1e-3);
+}
+
+// a walker far from the watcher comes in every few ticks, and the ticks in
+// between only repeat what the watcher already has
+TEST(INTERPOLATION, serverMarksRepeatedPlayers) {
+  int port = 17791;
+  Server server;
+  ASSERT_TRUE(server.Start(port));
+  TestClient walker;
+  TestClient watcher;
+  ASSERT_TRUE(walker.connect(port));
+  ASSERT_TRUE(watcher.connect(port));
+  std::vector<Snapshot> received;
+  watcher.onSnapshot = [&](const Snapshot& snapshot) {
+    if (!snapshot.players.empty()) {
+      received.push_back(snapshot);
+    }
+  };
+  // the watcher's own position, so the server knows how far off the walker is
+  watcher.send(glm::vec3(0));
+  watcher.pump(100);
+  for (int step = 1; step <= 30; step++) {
+    walker.send(glm::vec3(100 + step, 0, 0));
+    walker.pump();
+    watcher.pump(1000 / SNAPSHOT_RATE);
+  }
+  server.Stop();
+
+  int sampled = 0;
+  int repeated = 0;
+  for (size_t i = 1; i < received.size(); i++) {
+    auto& player = received[i].players[0];
+    ASSERT_GT(player.interval, 1);
+    if (player.sampledAt(received[i].tick)) {
+      sampled++;
+    } else if (received[i].tick == received[i - 1].tick + 1) {
+      repeated++;
+      ASSERT_EQ(player.x, received[i - 1].players[0].x);
+    }
+  }
+  ASSERT_GT(sampled, 0);
+  ASSERT_GT(repeated, sampled);
+}
+
+// snapshots 50 to 80ms late, so they overtake each other, and one in ten
+// lost
+TEST(INTERPOLATION, smoothsABadLinkOnLocalhost) {
+  auto smoothness = watchWalker(17792, 0.05, 0.03, 0.1);
+  std::cout << "frame step error: on arrival " << smoothness.onArrival
+            << ", interpolated " << smoothness.interpolated << std::endl;
+  ASSERT_LT(smoothness.interpolated, smoothness.onArrival / 2);
+}
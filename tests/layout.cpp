@@ -0,0 +1,129 @@
+#include "WindowManager/Layout.h"
+#include <chrono>
+#include <gtest/gtest.h>
+
+using namespace WindowManager;
+
+namespace {
+
+const float WIDE = 0.6;
+const float TALL = 1.4;
+
+entt::entity
+app(int id)
+{
+  return (entt::entity)id;
+}
+
+Layout::Wall
+wall()
+{
+  Layout::Wall wall;
+  wall.origin = glm::vec3(0, 0, -2);
+  wall.cell = glm::vec2(1, 1);
+  wall.columns = 3;
+  return wall;
+}
+
+}
+
+TEST(LAYOUT, tilesAlongRowsFromTheBottom) {
+  Layout layout(wall());
+  for (int i = 0; i < 4; i++) {
+    layout.place(app(i), WIDE);
+  }
+  ASSERT_EQ(layout.positionOf(app(0)), glm::vec3(0, 0, -2));
+  ASSERT_EQ(layout.positionOf(app(2)), glm::vec3(2, 0, -2));
+  ASSERT_EQ(layout.positionOf(app(3)), glm::vec3(0, 1, -2));
+}
+
+TEST(LAYOUT, reusesTheCellsOfClosedApps) {
+  Layout layout(wall());
+  for (int i = 0; i < 5; i++) {
+    layout.place(app(i), WIDE);
+  }
+  layout.remove(app(1));
+  ASSERT_EQ(layout.place(app(5), WIDE), glm::vec3(1, 0, -2));
+  ASSERT_EQ(layout.place(app(6), WIDE), glm::vec3(2, 1, -2));
+}
+
+TEST(LAYOUT, tallAppsCoverAColumnWithoutOverlapping) {
+  Layout layout(wall());
+  layout.place(app(0), WIDE);
+  // two cells tall, centred between them
+  ASSERT_EQ(layout.place(app(1), TALL), glm::vec3(1, 0.5, -2));
+  layout.place(app(2), WIDE);
+  // cell 4 is under app 1
+  ASSERT_EQ(layout.place(app(3), WIDE), glm::vec3(0, 1, -2));
+  ASSERT_EQ(layout.place(app(4), WIDE), glm::vec3(2, 1, -2));
+  layout.remove(app(0));
+  // cell 0 is free but cell 3 above it isn't
+  ASSERT_EQ(layout.place(app(5), TALL), glm::vec3(0, 2.5, -2));
+}
+
+TEST(LAYOUT, keepsClearOfAppsPlacedElsewhere) {
+  Layout layout(wall());
+  layout.occupy(app(0), glm::vec3(0.1, -0.1, -2), WIDE);
+  // off the wall, takes nothing
+  layout.occupy(app(1), glm::vec3(0, 0, 3), WIDE);
+  ASSERT_EQ(layout.place(app(2), WIDE), glm::vec3(1, 0, -2));
+  layout.remove(app(0));
+  ASSERT_EQ(layout.place(app(3), WIDE), glm::vec3(0, 0, -2));
+  ASSERT_FALSE(layout.contains(app(1)));
+}
+
+TEST(LAYOUT, stacksInOneCell) {
+  Layout layout(wall());
+  layout.place(app(0), WIDE);
+  auto bottom = layout.place(app(1), WIDE, Layout::Mode::STACK);
+  auto top = layout.place(app(2), WIDE, Layout::Mode::STACK);
+  ASSERT_EQ(bottom, glm::vec3(1, 0, -2));
+  ASSERT_GT(top.z, bottom.z);
+  ASSERT_EQ(layout.place(app(3), WIDE), glm::vec3(2, 0, -2));
+  layout.remove(app(1));
+  layout.remove(app(2));
+  // an empty stack gives its cell back
+  ASSERT_EQ(layout.place(app(4), WIDE), glm::vec3(1, 0, -2));
+}
+
+TEST(LAYOUT, relayoutClosesGapsInOrder) {
+  Layout layout(wall());
+  for (int i = 0; i < 6; i++) {
+    layout.place(app(i), WIDE);
+  }
+  layout.place(app(6), WIDE, Layout::Mode::STACK);
+  layout.place(app(7), WIDE, Layout::Mode::STACK);
+  layout.place(app(8), WIDE, Layout::Mode::STACK);
+  layout.remove(app(0));
+  layout.remove(app(2));
+  layout.remove(app(7));
+  auto moves = layout.relayout();
+  // 1 to 0, 3 to 1, 4 to 2, 5 to 3, the stack to 4 and 8 down a place
+  ASSERT_EQ(moves.size(), 6);
+  ASSERT_EQ(layout.positionOf(app(1)), glm::vec3(0, 0, -2));
+  ASSERT_EQ(layout.positionOf(app(5)), glm::vec3(0, 1, -2));
+  ASSERT_EQ(layout.positionOf(app(6)), glm::vec3(1, 1, -2));
+  auto step = wall().stackStep;
+  ASSERT_EQ(layout.positionOf(app(8)), glm::vec3(1, 1, -2) + step);
+  ASSERT_TRUE(layout.relayout().empty());
+  ASSERT_EQ(layout.place(app(9), WIDE), glm::vec3(2, 1, -2));
+}
+
+TEST(LAYOUT, placesManyAppsQuickly) {
+  const int APPS = 100000;
+  Layout layout(wall());
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < APPS; i++) {
+    layout.place(app(i), WIDE);
+  }
+  for (int i = 0; i < APPS; i += 2) {
+    layout.remove(app(i));
+  }
+  for (int i = 0; i < APPS; i += 2) {
+    layout.place(app(i), WIDE);
+  }
+  layout.relayout();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(layout.size(), APPS);
+  ASSERT_LT(elapsed, std::chrono::seconds(2));
+}
@@ -0,0 +1,64 @@
+#include "MpscRing.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(MPSC_RING, popsInPushOrder) {
+  auto ring = MpscRing<int>(8);
+  for (int i = 0; i < 8; i++) {
+    ASSERT_TRUE(ring.push(i));
+  }
+  int value;
+  for (int i = 0; i < 8; i++) {
+    ASSERT_TRUE(ring.pop(value));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_FALSE(ring.pop(value));
+}
+
+TEST(MPSC_RING, rejectsPushWhenFull) {
+  auto ring = MpscRing<int>(5);
+  ASSERT_EQ(ring.capacity(), 8);
+  for (int i = 0; i < 8; i++) {
+    ASSERT_TRUE(ring.push(i));
+  }
+  ASSERT_FALSE(ring.push(8));
+  int value;
+  ring.pop(value);
+  ASSERT_TRUE(ring.push(8));
+  ASSERT_EQ(ring.size(), 8);
+}
+
+TEST(MPSC_RING, deliversEveryValueFromManyProducers) {
+  auto ring = MpscRing<int>(64);
+  int producers = 4;
+  int perProducer = 10000;
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.push_back(std::thread([&, p]() {
+      for (int i = 0; i < perProducer; i++) {
+        while (!ring.push(p * perProducer + i)) {
+          std::this_thread::yield();
+        }
+      }
+    }));
+  }
+
+  std::vector<int> lastSeen(producers, -1);
+  int received = 0;
+  int value;
+  while (received < producers * perProducer) {
+    if (!ring.pop(value)) {
+      continue;
+    }
+    // values from one producer arrive in the order they were pushed
+    int producer = value / perProducer;
+    ASSERT_GT(value, lastSeen[producer]);
+    lastSeen[producer] = value;
+    received++;
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_FALSE(ring.pop(value));
+}
@@ -0,0 +1,117 @@
+#include "WindowManager/Placement.h"
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+using namespace WindowManager;
+
+namespace {
+
+const float SCREEN_WIDTH = 1920;
+const float SCREEN_HEIGHT = 1080;
+
+glm::mat4
+projection(float yFov = 45)
+{
+  return glm::perspective(
+    glm::radians(yFov), SCREEN_WIDTH / SCREEN_HEIGHT, 0.02f, 1000.0f);
+}
+
+// the search getViewDistanceForWindowSize used to run
+float
+searchedDistance(const glm::mat4& projection, float target)
+{
+  glm::vec4 best = glm::vec4(10000, 0, 0, 0);
+  float zBest = 0;
+  for (float z = 0.0; z <= 10.5; z = z + 0.001) {
+    glm::vec4 candidate = projection * glm::vec4(0.5, 0, -z, 1);
+    candidate = candidate / candidate.w;
+    if (std::abs(candidate.x - target) < std::abs(best.x - target)) {
+      best = candidate;
+      zBest = z;
+    }
+  }
+  return zBest;
+}
+
+// screen pixels between two points in camera space
+float
+projectedPixels(const glm::mat4& projection, glm::vec3 from, glm::vec3 to)
+{
+  glm::vec4 a = projection * glm::vec4(from, 1);
+  glm::vec4 b = projection * glm::vec4(to, 1);
+  return (b.x / b.w - a.x / a.w) * SCREEN_WIDTH / 2;
+}
+
+}
+
+TEST(PLACEMENT, solvesWhatTheSearchFound) {
+  for (float yFov : { 30.0f, 45.0f, 70.0f }) {
+    for (float width : { 400.0f, 1280.0f, 1920.0f }) {
+      for (float scale : { 1.0f, 1.5f }) {
+        float target = width / SCREEN_WIDTH / scale;
+        ASSERT_NEAR(placement::viewDistance(
+                      projection(yFov), width, SCREEN_WIDTH, scale),
+                    searchedDistance(projection(yFov), target),
+                    1e-3);
+      }
+    }
+  }
+}
+
+TEST(PLACEMENT, mapsOneUnitToItsPixels) {
+  auto p = projection();
+  float distance = placement::viewDistance(p, 800, SCREEN_WIDTH);
+  ASSERT_NEAR(placement::pixelsPerUnit(p, distance, SCREEN_WIDTH), 800, 1e-2);
+}
+
+TEST(PLACEMENT, tilesWindowsPixelPerfect) {
+  auto p = projection();
+  float distance = placement::viewDistance(p, SCREEN_WIDTH, SCREEN_WIDTH);
+  std::vector<glm::vec2> sizes = {
+    { 800, 600 }, { 400, 300 }, { 640, 480 }, { 1024, 768 }
+  };
+  placement::Grid grid;
+  grid.columns = 3;
+  grid.gap = 10;
+  auto placed = placement::tile(p,
+                                SCREEN_WIDTH,
+                                glm::vec3(0),
+                                glm::quat(1, 0, 0, 0),
+                                distance,
+                                sizes,
+                                grid);
+  ASSERT_EQ(placed.size(), sizes.size());
+  for (size_t i = 0; i < sizes.size(); i++) {
+    auto& window = placed[i];
+    ASSERT_NEAR(window.pos.z, -distance, 1e-4);
+    // a quad is scale units wide
+    glm::vec3 left = window.pos - glm::vec3(window.scale / 2, 0, 0);
+    glm::vec3 right = window.pos + glm::vec3(window.scale / 2, 0, 0);
+    ASSERT_NEAR(projectedPixels(p, left, right), sizes[i].x, 0.5);
+  }
+  // the gap between neighbours is the gap asked for, in pixels
+  glm::vec3 firstRight = placed[0].pos + glm::vec3(placed[0].scale / 2, 0, 0);
+  glm::vec3 secondLeft = placed[1].pos - glm::vec3(placed[1].scale / 2, 0, 0);
+  ASSERT_NEAR(projectedPixels(p, firstRight, secondLeft), 10, 0.5);
+  // tops of the first row line up, and the second row starts below it
+  float unit = placement::pixelsPerUnit(p, distance, SCREEN_WIDTH);
+  auto top = [&](size_t i) {
+    return placed[i].pos.y * unit + sizes[i].y / 2;
+  };
+  ASSERT_NEAR(top(0), top(1), 0.5);
+  ASSERT_NEAR(top(0), top(2), 0.5);
+  ASSERT_NEAR(top(0) - top(3), 600 + 10, 0.5);
+}
+
+TEST(PLACEMENT, facesWhereTheCameraLooks) {
+  auto p = projection();
+  glm::quat facing = glm::angleAxis(glm::radians(90.0f), glm::vec3(0, 1, 0));
+  auto placed = placement::tile(
+    p, SCREEN_WIDTH, glm::vec3(1, 2, 3), facing, 2, { { 800, 600 } });
+  // turned left a quarter, straight ahead is -x
+  ASSERT_NEAR(placed[0].pos.x, -1, 1e-4);
+  ASSERT_NEAR(placed[0].pos.y, 2, 1e-4);
+  ASSERT_NEAR(placed[0].pos.z, 3, 1e-4);
+  ASSERT_NEAR(placed[0].rotate.y, 90, 0.1);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "entity.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+
+// a database path in the temp directory with any leftovers from an earlier
+// run, including the WAL and shared memory files, removed
+inline std::string
+scratchDatabase(std::string name)
+{
+  auto path = std::filesystem::temp_directory_path() / (name + ".db");
+  for (auto suffix : { "", "-wal", "-shm" }) {
+    std::filesystem::remove(path.string() + suffix);
+  }
+  return path.string();
+}
+
+template<typename... Persisters>
+std::shared_ptr<EntityRegistry>
+openRegistry(std::string dbFile)
+{
+  auto registry = std::make_shared<EntityRegistry>(dbFile);
+  (registry->addPersister(std::make_shared<Persisters>(registry)), ...);
+  registry->createTablesIfNeeded();
+  return registry;
+}
+
+template<typename... Persisters>
+std::shared_ptr<EntityRegistry>
+scratchRegistry(std::string name)
+{
+  return openRegistry<Persisters...>(scratchDatabase(name));
+}
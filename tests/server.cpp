@@ -0,0 +1,84 @@
+#include "MultiPlayer/Server.h"
+#include "testClient.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <thread>
+
+using namespace MultiPlayer;
+
+// bounds come from the time the test measured, not the time it asked for,
+// so a loaded machine makes the test slower rather than flaky
+TEST(SERVER, ticksAtItsRate) {
+  int tickRate = 50;
+  auto tickLength = std::chrono::milliseconds(1000 / tickRate);
+  Server server(tickRate);
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(server.Start(17781));
+  auto metrics = server.getMetrics();
+  while (metrics.ticks < 25 &&
+         std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+    std::this_thread::sleep_for(tickLength / 4);
+    metrics = server.getMetrics();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  server.Stop();
+  ASSERT_GE(metrics.ticks, 25);
+  // a late tick is skipped rather than made up in a burst, so ticks never
+  // come faster than the rate. One more for a timeout that wakes a
+  // millisecond early.
+  ASSERT_LE(metrics.ticks, (uint32_t)(elapsed / tickLength) + 1);
+  double tickMs = std::chrono::duration<double, std::milli>(tickLength).count();
+  ASSERT_EQ(metrics.overruns == 0, metrics.maxTickWork <= tickMs);
+}
+
+// a packet that lands mid tick goes out with that tick's snapshots, not a
+// poll interval later. Counted in ticks, so a descheduled test thread can't
+// fail it.
+TEST(SERVER, relaysWithinATick) {
+  int tickRate = 20;
+  auto tickLength = std::chrono::milliseconds(1000 / tickRate);
+  Server server(tickRate);
+  ASSERT_TRUE(server.Start(17782));
+  TestClient mover;
+  TestClient watcher;
+  ASSERT_TRUE(mover.connect(17782));
+  ASSERT_TRUE(watcher.connect(17782));
+
+  auto worst = std::chrono::steady_clock::duration::zero();
+  for (int step = 1; step <= 10; step++) {
+    glm::vec3 position(step, 0, 0);
+    uint32_t seenTick = 0;
+    watcher.onSnapshot = [&](const Snapshot& snapshot) {
+      if (snapshot.players.size() == 1 &&
+          snapshot.players[0].state().position.x == position.x) {
+        seenTick = snapshot.tick;
+      }
+    };
+    // land at different points in the tick
+    std::this_thread::sleep_for(tickLength * step / 10);
+    auto sent = std::chrono::steady_clock::now();
+    mover.send(position);
+    // the packet was sent during the tick after the last one finished by now
+    // at the latest
+    auto ticksAfterSend = server.getMetrics().ticks;
+    while (seenTick == 0 &&
+           std::chrono::steady_clock::now() - sent < std::chrono::seconds(5)) {
+      mover.pump();
+      watcher.pump(1);
+    }
+    ASSERT_NE(seenTick, 0);
+    worst = std::max(worst, std::chrono::steady_clock::now() - sent);
+    // the tick it landed in, or the next if it landed while that tick was
+    // already sending
+    ASSERT_LE(seenTick, ticksAfterSend + 2);
+  }
+  auto metrics = server.getMetrics();
+  server.Stop();
+
+  double worstMs =
+    std::chrono::duration<double, std::milli>(worst).count();
+  std::cout << "worst relay latency " << worstMs << "ms, tick work "
+            << metrics.averageTickWork << "ms" << std::endl;
+  ASSERT_GT(metrics.maxEventsPerTick, 0);
+}
@@ -0,0 +1,131 @@
+#include "MultiPlayer/Server.h"
+#include "Simulation.h"
+#include "components/Door.h"
+#include "components/Parent.h"
+#include "components/Positionable.h"
+#include "components/TranslateMovement.h"
+#include "scratchRegistry.h"
+#include "systems/Door.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace {
+
+const int TICK_RATE = 20;
+
+entt::entity
+place(std::shared_ptr<EntityRegistry> registry, glm::vec3 pos)
+{
+  auto entity = registry->createPersistent();
+  registry->emplace<Positionable>(
+    entity, pos, glm::vec3(0), glm::vec3(0), 1.0f);
+  return entity;
+}
+
+// a door swinging open with a box attached to it, and a block sliding away
+void
+build(std::shared_ptr<EntityRegistry> registry)
+{
+  auto door = place(registry, glm::vec3(0));
+  registry->emplace<Door>(door,
+                          RotateMovement(90, 45, glm::vec3(0, 1, 0)),
+                          RotateMovement(-90, 45, glm::vec3(0, 1, 0)),
+                          CLOSED);
+  auto box = place(registry, glm::vec3(1, 0, 0));
+  int boxId = registry->get<Persistable>(box).entityId;
+  registry->emplace<Parent>(door, std::vector<int>{ boxId });
+  auto block = place(registry, glm::vec3(0, 0, 5));
+  registry->emplace<TranslateMovement>(block, glm::vec3(3, 0, 0), 2.0);
+  systems::openDoor(registry, door);
+}
+
+}
+
+TEST(SIMULATION, movesByTheTickLength) {
+  auto registry = scratchRegistry<>("simulationTicks");
+  auto block = place(registry, glm::vec3(0));
+  bool finished = false;
+  TranslateMovement movement(glm::vec3(1, 0, 0), 2.0);
+  movement.onFinish = [&finished]() { finished = true; };
+  registry->emplace<TranslateMovement>(block, movement);
+
+  // a unit at two a second is ten ticks
+  Simulation simulation(registry, TICK_RATE);
+  for (int tick = 0; tick < 9; tick++) {
+    simulation.step();
+  }
+  ASSERT_FALSE(finished);
+  ASSERT_NEAR(registry->get<Positionable>(block).pos.x, 0.9, 1e-5);
+  simulation.step();
+  ASSERT_TRUE(finished);
+  ASSERT_FALSE(registry->all_of<TranslateMovement>(block));
+  ASSERT_EQ(simulation.getTick(), 10);
+}
+
+TEST(SIMULATION, opensDoorsAndCarriesTheirChildren) {
+  auto registry = scratchRegistry<>("simulationDoor");
+  build(registry);
+  auto door = registry->view<Door>().front();
+  Simulation simulation(registry, TICK_RATE);
+
+  // 90 degrees at 45 a second, and the box turns with the door from the
+  // first tick rather than one behind it
+  int ticks = 0;
+  while (registry->get<Door>(door).state != OPEN && ticks < 100) {
+    simulation.step();
+    ticks++;
+    auto box = registry->view<Attached>().front();
+    auto& doorMatrix = registry->get<Positionable>(door).modelMatrix;
+    glm::vec3 carried(doorMatrix * glm::vec4(1, 0, 0, 1));
+    glm::vec3 boxPosition(registry->get<Positionable>(box).modelMatrix[3]);
+    ASSERT_NEAR(glm::distance(boxPosition, carried), 0, 1e-4) << ticks;
+  }
+  ASSERT_EQ(ticks, 2 * TICK_RATE);
+  // the box was one along x from the hinge, now it's a quarter turn round
+  auto box = registry->view<Attached>().front();
+  glm::vec3 boxPosition(registry->get<Positionable>(box).modelMatrix[3]);
+  ASSERT_NEAR(boxPosition.x, 0, 1e-4);
+  ASSERT_NEAR(std::abs(boxPosition.z), 1, 1e-4);
+}
+
+// the same world stepped the same number of times ends up bit for bit the
+// same, however many workers share the transform pass
+TEST(SIMULATION, isDeterministic) {
+  auto first = scratchRegistry<>("simulationFirst");
+  auto second = scratchRegistry<>("simulationSecond");
+  build(first);
+  build(second);
+  Simulation one(first, TICK_RATE);
+  Simulation other(second, TICK_RATE, 3);
+  for (int tick = 0; tick < 37; tick++) {
+    one.step();
+    other.step();
+  }
+
+  auto a = first->view<Persistable, Positionable>();
+  auto b = second->view<Persistable, Positionable>();
+  for (auto [entity, persistable, positionable] : a.each()) {
+    auto match = second->locateEntity(persistable.entityId);
+    ASSERT_TRUE(match.has_value());
+    auto& other = second->get<Positionable>(match.value());
+    ASSERT_EQ(positionable.pos, other.pos);
+    ASSERT_EQ(positionable.rotate, other.rotate);
+    ASSERT_EQ(positionable.modelMatrix, other.modelMatrix);
+  }
+  ASSERT_EQ(a.size_hint(), b.size_hint());
+}
+
+TEST(SIMULATION, stepsOnceAServerTick) {
+  auto registry = scratchRegistry<>("simulationServer");
+  build(registry);
+  Simulation simulation(registry, TICK_RATE);
+  MultiPlayer::Server server(TICK_RATE);
+  server.onTick([&simulation]() { simulation.step(); });
+  ASSERT_TRUE(server.Start(17801));
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  server.Stop();
+  auto metrics = server.getMetrics();
+  ASSERT_EQ(simulation.getTick(), metrics.ticks);
+  ASSERT_GE(metrics.ticks, 8);
+}
@@ -0,0 +1,232 @@
+#include "MultiPlayer/Server.h"
+#include "MultiPlayer/Snapshot.h"
+#include "testClient.h"
+#include <chrono>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace MultiPlayer;
+
+namespace {
+
+PlayerState
+player(uint32_t id, glm::vec3 position)
+{
+  return { id, position, glm::normalize(glm::vec3(1, 0.5, -1)) };
+}
+
+Snapshot
+snapshotOf(uint32_t tick, std::vector<PlayerState> states)
+{
+  Snapshot snapshot;
+  snapshot.tick = tick;
+  for (auto& state : states) {
+    snapshot.players.push_back(QuantizedPlayer::from(state));
+  }
+  return snapshot;
+}
+
+Snapshot
+roundTrip(const Snapshot& snapshot,
+          const Snapshot* base,
+          SnapshotHistory& history,
+          size_t* bytes = NULL)
+{
+  auto data = encodeSnapshot(snapshot, base);
+  if (bytes != NULL) {
+    *bytes = data.size();
+  }
+  Snapshot decoded;
+  EXPECT_TRUE(decodeSnapshot(data.data(), data.size(), history, decoded));
+  history.add(decoded);
+  return decoded;
+}
+
+// steps every client for a while, each sending its position once a tick
+void
+run(std::vector<std::unique_ptr<TestClient>>& clients,
+    std::vector<glm::vec3>& positions,
+    double seconds,
+    glm::vec3 velocity = glm::vec3(0))
+{
+  auto end = std::chrono::steady_clock::now() +
+             std::chrono::milliseconds((int)(seconds * 1000));
+  while (std::chrono::steady_clock::now() < end) {
+    for (size_t i = 0; i < clients.size(); i++) {
+      positions[i] += velocity / (float)SNAPSHOT_RATE;
+      clients[i]->send(positions[i]);
+      clients[i]->pump();
+    }
+    std::this_thread::sleep_for(
+      std::chrono::milliseconds(1000 / SNAPSHOT_RATE));
+  }
+}
+
+// bytes each client received per snapshot in the last stretch of a run
+double
+bytesPerSnapshot(int playerCount, int port, glm::vec3 velocity)
+{
+  Server server;
+  server.Start(port);
+  std::vector<std::unique_ptr<TestClient>> clients;
+  std::vector<glm::vec3> positions;
+  for (int i = 0; i < playerCount; i++) {
+    clients.push_back(std::make_unique<TestClient>());
+    EXPECT_TRUE(clients.back()->connect(port));
+    // spread out, so most are far from each other
+    positions.push_back(glm::vec3(i * 20, 0, 0));
+  }
+  run(clients, positions, 0.5, velocity);
+  for (auto& client : clients) {
+    client->snapshotBytes = 0;
+    client->snapshotCount = 0;
+  }
+  run(clients, positions, 1.0, velocity);
+  double total = 0;
+  for (auto& client : clients) {
+    EXPECT_GT(client->snapshotCount, 0);
+    total +=
+      (double)client->snapshotBytes / std::max(1, client->snapshotCount);
+  }
+  server.Stop();
+  return total / clients.size();
+}
+
+}
+
+TEST(SNAPSHOT, quantizesWithinAMillimeter) {
+  auto state = player(7, glm::vec3(123.4567, -0.001, 9876.54321));
+  auto restored = QuantizedPlayer::from(state).state();
+  ASSERT_EQ(restored.playerID, 7);
+  for (int axis = 0; axis < 3; axis++) {
+    ASSERT_NEAR(restored.position[axis], state.position[axis], 1e-3);
+    ASSERT_NEAR(restored.front[axis], state.front[axis], 1e-3);
+  }
+}
+
+TEST(SNAPSHOT, fullSnapshotRoundTrips) {
+  SnapshotHistory history;
+  auto snapshot = snapshotOf(
+    1, { player(3, glm::vec3(1, 2, 3)), player(40, glm::vec3(-5, 0, 7)) });
+  auto decoded = roundTrip(snapshot, NULL, history);
+  ASSERT_EQ(decoded.tick, 1);
+  ASSERT_EQ(decoded.players, snapshot.players);
+}
+
+TEST(SNAPSHOT, deltaCarriesOnlyChanges) {
+  SnapshotHistory history;
+  std::vector<PlayerState> states;
+  for (uint32_t id = 1; id <= 50; id++) {
+    states.push_back(player(id * 3, glm::vec3(id, 0, -(float)id)));
+  }
+  size_t fullBytes, idleBytes, movedBytes;
+  auto base = roundTrip(snapshotOf(1, states), NULL, history, &fullBytes);
+
+  auto idle = roundTrip(snapshotOf(2, states), &base, history, &idleBytes);
+  ASSERT_EQ(idle.players, base.players);
+  ASSERT_LE(idleBytes, 4);
+
+  states[10].position.x += 0.25;
+  auto movedSnapshot = snapshotOf(3, states);
+  auto moved = roundTrip(movedSnapshot, &base, history, &movedBytes);
+  ASSERT_EQ(moved.players, movedSnapshot.players);
+  ASSERT_LE(movedBytes, 10);
+  std::cout << "50 players: full " << fullBytes << " bytes, idle " << idleBytes
+            << ", one moved " << movedBytes << std::endl;
+}
+
+TEST(SNAPSHOT, deltaAddsAndRemovesPlayers) {
+  SnapshotHistory history;
+  auto base = roundTrip(snapshotOf(1,
+                                   { player(1, glm::vec3(0)),
+                                     player(2, glm::vec3(1)),
+                                     player(5, glm::vec3(2)) }),
+                        NULL,
+                        history);
+  auto next = snapshotOf(2,
+                         { player(1, glm::vec3(0)),
+                           player(4, glm::vec3(3)),
+                           player(9, glm::vec3(4)) });
+  auto decoded = roundTrip(next, &base, history);
+  ASSERT_EQ(decoded.players, next.players);
+}
+
+TEST(SNAPSHOT, carriesTheIntervalOnlyWhenItChanges) {
+  SnapshotHistory history;
+  auto first = snapshotOf(1, { player(2, glm::vec3(40, 0, 0)) });
+  first.players[0].interval = 4;
+  auto base = roundTrip(first, NULL, history);
+  ASSERT_EQ(base.players, first.players);
+
+  // a repeat of the same sample
+  size_t repeatBytes, fartherBytes;
+  auto repeat = base;
+  repeat.tick = 2;
+  roundTrip(repeat, &base, history, &repeatBytes);
+  ASSERT_LE(repeatBytes, 4);
+
+  auto farther = repeat;
+  farther.tick = 3;
+  farther.players[0].interval = 8;
+  auto decoded = roundTrip(farther, &base, history, &fartherBytes);
+  ASSERT_EQ(decoded.players[0].interval, 8);
+  ASSERT_FALSE(decoded.players[0].sampledAt(3));
+  ASSERT_TRUE(decoded.players[0].sampledAt(6));
+  ASSERT_LE(fartherBytes, 8);
+}
+
+TEST(SNAPSHOT, refusesAMissingBase) {
+  SnapshotHistory sent;
+  SnapshotHistory received;
+  auto base = snapshotOf(4, { player(1, glm::vec3(0)) });
+  sent.add(base);
+  auto data =
+    encodeSnapshot(snapshotOf(5, { player(1, glm::vec3(1)) }), sent.find(4));
+  Snapshot decoded;
+  ASSERT_FALSE(decodeSnapshot(data.data(), data.size(), received, decoded));
+  ASSERT_FALSE(decodeSnapshot(data.data(), 1, sent, decoded));
+}
+
+TEST(SNAPSHOT, distantPlayersAreSentLessOften) {
+  ASSERT_EQ(updateInterval(5), 1);
+  ASSERT_LT(updateInterval(20), updateInterval(100));
+  ASSERT_EQ(updateInterval(100000), updateInterval(1000));
+}
+
+TEST(SNAPSHOT, clientsOnLocalhostSeeEachOther) {
+  int port = 17771;
+  Server server;
+  ASSERT_TRUE(server.Start(port));
+  std::vector<std::unique_ptr<TestClient>> clients;
+  std::vector<glm::vec3> positions;
+  for (int i = 0; i < 3; i++) {
+    clients.push_back(std::make_unique<TestClient>());
+    ASSERT_TRUE(clients.back()->connect(port));
+    positions.push_back(glm::vec3(i, 0, 0));
+  }
+  run(clients, positions, 0.5);
+  for (auto& client : clients) {
+    // everyone but itself, close enough to be sent every tick
+    ASSERT_EQ(client->latest.players.size(), 2);
+    for (auto& other : client->latest.players) {
+      auto state = other.state();
+      ASSERT_NEAR(state.position.y, 0, 1e-3);
+      ASSERT_LT(state.position.x, 3);
+    }
+  }
+  server.Stop();
+}
+
+// walking players spread out in a line. Each client hears about 5 times as
+// many others with 16 players as with 4, its bandwidth grows much less.
+TEST(SNAPSHOT, bandwidthGrowsSublinearly) {
+  glm::vec3 walking(1.5, 0, 0);
+  double few = bytesPerSnapshot(4, 17772, walking);
+  double many = bytesPerSnapshot(16, 17773, walking);
+  std::cout << "bytes per snapshot per client: 4 players " << few
+            << ", 16 players " << many << std::endl;
+  ASSERT_LT(many, few * 5 / 2);
+}
@@ -0,0 +1,101 @@
+#include "SystemScheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Position
+{};
+struct Velocity
+{};
+struct Health
+{};
+}
+
+TEST(SYSTEM_SCHEDULER, conflictingSystemsRunInTheOrderAdded) {
+  using S = SystemScheduler;
+  SystemScheduler scheduler(3);
+  std::mutex orderMutex;
+  std::vector<std::string> order;
+  auto record = [&](std::string name) {
+    return [&, name]() {
+      std::lock_guard<std::mutex> lock(orderMutex);
+      order.push_back(name);
+    };
+  };
+  scheduler.add("move",
+                S::components<Velocity>(),
+                S::components<Position>(),
+                record("move"));
+  scheduler.add("heal", S::components<>(), S::components<Health>(),
+                record("heal"));
+  scheduler.add("collide",
+                S::components<Position>(),
+                S::components<Velocity>(),
+                record("collide"));
+
+  for (int frame = 0; frame < 100; frame++) {
+    order.clear();
+    scheduler.run();
+    ASSERT_EQ(order.size(), 3);
+    auto move = std::find(order.begin(), order.end(), "move");
+    auto collide = std::find(order.begin(), order.end(), "collide");
+    ASSERT_LT(move, collide);
+  }
+
+  auto& timings = scheduler.getTimings();
+  ASSERT_EQ(timings[0].wave, 0);
+  ASSERT_EQ(timings[1].wave, 0);
+  ASSERT_EQ(timings[2].wave, 1);
+}
+
+TEST(SYSTEM_SCHEDULER, mainThreadSystemsRunOnTheCaller) {
+  using S = SystemScheduler;
+  SystemScheduler scheduler(2);
+  std::thread::id ranOn;
+  scheduler.add(
+    "render",
+    S::components<Position>(),
+    S::components<>(),
+    [&]() { ranOn = std::this_thread::get_id(); },
+    true);
+  scheduler.run();
+  ASSERT_EQ(ranOn, std::this_thread::get_id());
+}
+
+TEST(SYSTEM_SCHEDULER, parallelForCoversEveryIndexOnce) {
+  SystemScheduler scheduler(3);
+  std::vector<std::atomic_int> hits(10001);
+  scheduler.parallelFor(hits.size(), 64, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      hits[i]++;
+    }
+  });
+  for (auto& hit : hits) {
+    ASSERT_EQ(hit.load(), 1);
+  }
+}
+
+TEST(SYSTEM_SCHEDULER, parallelForInsideASystemRunsInline) {
+  using S = SystemScheduler;
+  SystemScheduler scheduler(2);
+  std::atomic_int sum = 0;
+  for (int i = 0; i < 2; i++) {
+    scheduler.add(
+      "sum" + std::to_string(i),
+      S::components<>(),
+      S::components<>(),
+      [&]() {
+        scheduler.parallelFor(1000, 10, [&](size_t begin, size_t end) {
+          sum += end - begin;
+        });
+      },
+      i == 0);
+  }
+  scheduler.run();
+  ASSERT_EQ(sum.load(), 2000);
+}
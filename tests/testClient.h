@@ -0,0 +1,180 @@
+#pragma once
+#include "MultiPlayer/Server.h"
+#include "MultiPlayer/Snapshot.h"
+#include "MultiPlayer/WorldEdits.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <enet/enet.h>
+#include <functional>
+#include <glm/glm.hpp>
+#include <random>
+#include <vector>
+
+// a raw ENet peer that speaks the snapshot protocol like Client does
+struct TestClient
+{
+  ENetHost* host = NULL;
+  ENetPeer* peer = NULL;
+  MultiPlayer::SnapshotHistory history;
+  MultiPlayer::Snapshot latest;
+  uint32_t sequence = 0;
+  size_t snapshotBytes = 0;
+  int snapshotCount = 0;
+  // called with the newest snapshot whenever it changes
+  std::function<void(const MultiPlayer::Snapshot&)> onSnapshot;
+  // called with every snapshot decoded, late ones included
+  std::function<void(const MultiPlayer::Snapshot&)> onReceived;
+  // every edit received, batches and chunk states alike, in order
+  std::vector<MultiPlayer::BlockEdit> edits;
+  int chunkStates = 0;
+
+  // a simulated link for snapshots: each is held for latency plus up to
+  // jitter seconds, so they can overtake each other, and loss of them never
+  // arrive
+  double latency = 0;
+  double jitter = 0;
+  double loss = 0;
+  std::mt19937 random{ 7 };
+  struct InFlight
+  {
+    std::chrono::steady_clock::time_point arrives;
+    std::vector<uint8_t> data;
+  };
+  std::vector<InFlight> inFlight;
+
+  bool connect(int port)
+  {
+    host = enet_host_create(NULL, 1, 10, 0, 0);
+    ENetAddress address;
+    enet_address_set_host(&address, "127.0.0.1");
+    address.port = port;
+    peer = enet_host_connect(host, &address, 10, 0);
+    ENetEvent event;
+    return enet_host_service(host, &event, 2000) > 0 &&
+           event.type == ENET_EVENT_TYPE_CONNECT;
+  }
+
+  void send(glm::vec3 position)
+  {
+    glm::vec3 front(0, 0, -1);
+    uint32_t acked = latest.tick;
+    sequence++;
+    ENetPacket* packet = enet_packet_create(
+      NULL, sizeof(glm::vec3) * 2 + sizeof(uint32_t) * 2, 0);
+    memcpy(packet->data, &position, sizeof(glm::vec3));
+    memcpy(packet->data + sizeof(glm::vec3), &front, sizeof(glm::vec3));
+    uint8_t* tail = packet->data + sizeof(glm::vec3) * 2;
+    memcpy(tail, &acked, sizeof(uint32_t));
+    memcpy(tail + sizeof(uint32_t), &sequence, sizeof(uint32_t));
+    enet_peer_send(peer, MultiPlayer::PLAYER_UPDATE, packet);
+    enet_host_flush(host);
+  }
+
+  void sendEdits(const std::vector<MultiPlayer::BlockEdit>& edits)
+  {
+    auto data = MultiPlayer::encodeEdits(edits);
+    ENetPacket* packet = enet_packet_create(
+      data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(peer, MultiPlayer::WORLD_EDIT, packet);
+    enet_host_flush(host);
+  }
+
+  // handles everything that has arrived, waiting up to timeout
+  // milliseconds for the first of it
+  void pump(int timeout = 0)
+  {
+    ENetEvent event;
+    while (enet_host_service(host, &event, timeout) > 0) {
+      timeout = 0;
+      if (event.type != ENET_EVENT_TYPE_RECEIVE) {
+        continue;
+      }
+      if (event.channelID == MultiPlayer::SNAPSHOT) {
+        snapshotBytes += event.packet->dataLength;
+        snapshotCount++;
+        transmit(event.packet);
+      }
+      if (event.channelID == MultiPlayer::WORLD_EDIT) {
+        receiveEdits(event.packet);
+      }
+      enet_packet_destroy(event.packet);
+    }
+    deliver();
+  }
+
+  void transmit(ENetPacket* packet)
+  {
+    std::vector<uint8_t> data(packet->data, packet->data + packet->dataLength);
+    if (latency == 0 && jitter == 0 && loss == 0) {
+      receiveSnapshot(data);
+      return;
+    }
+    std::uniform_real_distribution<double> unit(0, 1);
+    if (unit(random) < loss) {
+      return;
+    }
+    auto delay = std::chrono::duration<double>(latency + jitter * unit(random));
+    inFlight.push_back(
+      { std::chrono::steady_clock::now() +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            delay),
+        std::move(data) });
+  }
+
+  // hands on every snapshot whose time has come, soonest first
+  void deliver()
+  {
+    auto now = std::chrono::steady_clock::now();
+    std::sort(inFlight.begin(),
+              inFlight.end(),
+              [](const InFlight& a, const InFlight& b) {
+                return a.arrives < b.arrives;
+              });
+    size_t due = 0;
+    while (due < inFlight.size() && inFlight[due].arrives <= now) {
+      receiveSnapshot(inFlight[due].data);
+      due++;
+    }
+    inFlight.erase(inFlight.begin(), inFlight.begin() + due);
+  }
+
+  void receiveSnapshot(const std::vector<uint8_t>& data)
+  {
+    MultiPlayer::Snapshot snapshot;
+    if (!MultiPlayer::decodeSnapshot(
+          data.data(), data.size(), history, snapshot)) {
+      return;
+    }
+    history.add(snapshot);
+    if (onReceived) {
+      onReceived(snapshot);
+    }
+    if (snapshot.tick > latest.tick) {
+      latest = snapshot;
+      if (onSnapshot) {
+        onSnapshot(latest);
+      }
+    }
+  }
+
+  void receiveEdits(ENetPacket* packet)
+  {
+    std::vector<MultiPlayer::BlockEdit> received;
+    if (packet->data[0] == MultiPlayer::CHUNK_STATE) {
+      chunkStates++;
+      MultiPlayer::WorldEdits::decodeChunk(
+        packet->data + 1, packet->dataLength - 1, received);
+    } else {
+      MultiPlayer::decodeEdits(packet->data, packet->dataLength, received);
+    }
+    edits.insert(edits.end(), received.begin(), received.end());
+  }
+
+  ~TestClient()
+  {
+    if (host != NULL) {
+      enet_host_destroy(host);
+    }
+  }
+};
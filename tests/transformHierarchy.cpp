@@ -0,0 +1,239 @@
+#include "components/Parent.h"
+#include "components/Positionable.h"
+#include "scratchRegistry.h"
+#include "systems/Transforms.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+entt::entity
+place(std::shared_ptr<EntityRegistry> registry,
+      glm::vec3 pos,
+      glm::vec3 rotate = glm::vec3(0))
+{
+  auto entity = registry->createPersistent();
+  registry->emplace<Positionable>(entity, pos, glm::vec3(0), rotate, 1.0f);
+  return entity;
+}
+
+void
+carry(std::shared_ptr<EntityRegistry> registry,
+      entt::entity parent,
+      entt::entity child)
+{
+  int childId = registry->get<Persistable>(child).entityId;
+  registry->emplace<Parent>(parent, std::vector<int>{ childId });
+}
+
+glm::vec3
+worldPosition(std::shared_ptr<EntityRegistry> registry, entt::entity entity)
+{
+  return glm::vec3(registry->get<Positionable>(entity).modelMatrix[3]);
+}
+
+// where the entity's x axis points
+glm::vec3
+worldAxis(std::shared_ptr<EntityRegistry> registry, entt::entity entity)
+{
+  return glm::vec3(registry->get<Positionable>(entity).modelMatrix[0]);
+}
+
+void
+expectNear(glm::vec3 actual, glm::vec3 expected)
+{
+  EXPECT_NEAR(actual.x, expected.x, 1e-4);
+  EXPECT_NEAR(actual.y, expected.y, 1e-4);
+  EXPECT_NEAR(actual.z, expected.z, 1e-4);
+}
+
+}
+
+TEST(TRANSFORM_HIERARCHY, childrenFollowATranslatingParent) {
+  auto registry = scratchRegistry<>("translatingParent");
+  auto parent = place(registry, glm::vec3(0));
+  auto child = place(registry, glm::vec3(1, 0, 0));
+  carry(registry, parent, child);
+  systems::updateTransforms(registry);
+
+  for (int frame = 1; frame <= 3; frame++) {
+    registry->get<Positionable>(parent).pos.x += 2;
+    registry->get<Positionable>(parent).damage();
+    ASSERT_TRUE(systems::updateTransforms(registry));
+    expectNear(worldPosition(registry, child), glm::vec3(1 + 2 * frame, 0, 0));
+  }
+  // the fields stay in world space
+  expectNear(registry->get<Positionable>(child).pos, glm::vec3(7, 0, 0));
+  ASSERT_FALSE(systems::updateTransforms(registry));
+}
+
+TEST(TRANSFORM_HIERARCHY, childrenOrbitARotatingParent) {
+  auto registry = scratchRegistry<>("rotatingParent");
+  auto parent = place(registry, glm::vec3(0));
+  auto child = place(registry, glm::vec3(1, 0, 0));
+  carry(registry, parent, child);
+  systems::updateTransforms(registry);
+
+  registry->get<Positionable>(parent).rotate.y = 90;
+  registry->get<Positionable>(parent).damage();
+  systems::updateTransforms(registry);
+
+  expectNear(worldPosition(registry, child), glm::vec3(0, 0, -1));
+  expectNear(worldAxis(registry, child), glm::vec3(0, 0, -1));
+}
+
+TEST(TRANSFORM_HIERARCHY, nestedChildrenFollowEveryAncestor) {
+  auto registry = scratchRegistry<>("nestedHierarchy");
+  auto root = place(registry, glm::vec3(0));
+  auto middle = place(registry, glm::vec3(0, 1, 0));
+  auto leaf = place(registry, glm::vec3(0, 2, 0));
+  carry(registry, root, middle);
+  carry(registry, middle, leaf);
+  systems::updateTransforms(registry);
+
+  registry->get<Positionable>(root).pos.x = 5;
+  registry->get<Positionable>(root).damage();
+  systems::updateTransforms(registry);
+  expectNear(worldPosition(registry, middle), glm::vec3(5, 1, 0));
+  expectNear(worldPosition(registry, leaf), glm::vec3(5, 2, 0));
+
+  // moving the middle leaves the root where it is
+  registry->get<Positionable>(middle).pos.z = 3;
+  registry->get<Positionable>(middle).damage();
+  systems::updateTransforms(registry);
+  expectNear(worldPosition(registry, root), glm::vec3(5, 0, 0));
+  expectNear(worldPosition(registry, leaf), glm::vec3(5, 2, 3));
+
+  registry->get<Positionable>(root).rotate.z = 90;
+  registry->get<Positionable>(root).damage();
+  systems::updateTransforms(registry);
+  expectNear(worldPosition(registry, leaf), glm::vec3(3, 0, 3));
+}
+
+// a key turning in a door that is swinging, or an app laid out again while
+// its parent moves
+TEST(TRANSFORM_HIERARCHY, childMovedWithItsParentIsStillCarried) {
+  auto registry = scratchRegistry<>("childMovedWithParent");
+  auto parent = place(registry, glm::vec3(0));
+  auto child = place(registry, glm::vec3(1, 0, 0));
+  carry(registry, parent, child);
+  systems::updateTransforms(registry);
+
+  registry->get<Positionable>(parent).pos.x += 5;
+  registry->get<Positionable>(parent).damage();
+  registry->get<Positionable>(child).pos.y += 1;
+  registry->get<Positionable>(child).damage();
+  systems::updateTransforms(registry);
+  expectNear(worldPosition(registry, child), glm::vec3(6, 1, 0));
+  expectNear(registry->get<Positionable>(child).pos, glm::vec3(6, 1, 0));
+
+  // and keeps its new place relative to the parent
+  registry->get<Positionable>(parent).pos.x += 5;
+  registry->get<Positionable>(parent).damage();
+  systems::updateTransforms(registry);
+  expectNear(worldPosition(registry, child), glm::vec3(11, 1, 0));
+
+  registry->get<Positionable>(parent).rotate.y = 90;
+  registry->get<Positionable>(parent).damage();
+  registry->get<Positionable>(child).rotate.y += 30;
+  registry->get<Positionable>(child).damage();
+  systems::updateTransforms(registry);
+  expectNear(worldPosition(registry, child), glm::vec3(10, 1, -1));
+  // turned 90 by the parent and 30 on its own
+  float turned = glm::radians(120.0f);
+  expectNear(worldAxis(registry, child),
+             glm::vec3(cos(turned), 0, -sin(turned)));
+}
+
+TEST(TRANSFORM_HIERARCHY, parentCycleKeepsOneRoot) {
+  auto registry = scratchRegistry<>("parentCycle");
+  auto first = place(registry, glm::vec3(0));
+  auto second = place(registry, glm::vec3(1, 0, 0));
+  carry(registry, first, second);
+  carry(registry, second, first);
+  systems::updateTransforms(registry);
+
+  bool firstAttached = registry->all_of<Attached>(first);
+  ASSERT_NE(firstAttached, registry->all_of<Attached>(second));
+  auto root = firstAttached ? second : first;
+  auto child = firstAttached ? first : second;
+
+  auto start = worldPosition(registry, child);
+  registry->get<Positionable>(root).pos.y += 2;
+  registry->get<Positionable>(root).damage();
+  ASSERT_TRUE(systems::updateTransforms(registry));
+  expectNear(worldPosition(registry, child), start + glm::vec3(0, 2, 0));
+}
+
+// a door given its children and opened before the transform pass first runs
+TEST(TRANSFORM_HIERARCHY, parentMovedBeforeTheFirstPassCarriesItsChildren) {
+  auto registry = scratchRegistry<>("parentMovedBeforeAttach");
+  auto parent = place(registry, glm::vec3(0));
+  auto child = place(registry, glm::vec3(1, 0, 0));
+  carry(registry, parent, child);
+
+  registry->get<Positionable>(parent).rotate.y = 90;
+  registry->get<Positionable>(parent).damage();
+  systems::updateTransforms(registry);
+  expectNear(worldPosition(registry, child), glm::vec3(0, 0, -1));
+}
+
+TEST(TRANSFORM_HIERARCHY, editedChildrenAreAttachedAgainstTheLastPlacement) {
+  auto registry = scratchRegistry<>("editedChildren");
+  auto parent = place(registry, glm::vec3(0));
+  auto child = place(registry, glm::vec3(1, 0, 0));
+  carry(registry, parent, child);
+  systems::updateTransforms(registry);
+  ASSERT_FALSE(systems::updateTransforms(registry));
+
+  auto other = place(registry, glm::vec3(0, 0, 1));
+  registry->get<Positionable>(parent).pos.x = 3;
+  registry->get<Positionable>(parent).damage();
+  registry->patch<Parent>(parent, [registry, other](Parent& edited) {
+    edited.childrenIds.push_back(registry->get<Persistable>(other).entityId);
+    edited.invalidate();
+  });
+  systems::updateTransforms(registry);
+  expectNear(worldPosition(registry, child), glm::vec3(4, 0, 0));
+  expectNear(worldPosition(registry, other), glm::vec3(3, 0, 1));
+}
+
+// a server's Simulation steps on its poll thread while World steps on the
+// render thread, neither may see the other's matrices
+TEST(TRANSFORM_HIERARCHY, registriesUpdateOnSeparateThreads) {
+  const int ENTITIES = 512;
+  std::vector<std::shared_ptr<EntityRegistry>> registries = {
+    scratchRegistry<>("separateThreadsA"), scratchRegistry<>("separateThreadsB")
+  };
+  std::vector<std::thread> threads;
+  for (size_t r = 0; r < registries.size(); r++) {
+    threads.push_back(std::thread([&registries, r]() {
+      auto registry = registries[r];
+      std::vector<entt::entity> entities;
+      for (int i = 0; i < ENTITIES; i++) {
+        auto entity = registry->create();
+        registry->emplace<Positionable>(
+          entity, glm::vec3(i, r, 0), glm::vec3(0), glm::vec3(0), 1.0f);
+        entities.push_back(entity);
+      }
+      for (int frame = 0; frame < 50; frame++) {
+        for (auto entity : entities) {
+          registry->get<Positionable>(entity).pos.z = frame;
+          registry->get<Positionable>(entity).damage();
+        }
+        systems::updateTransforms(registry);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (size_t r = 0; r < registries.size(); r++) {
+    auto view = registries[r]->view<Positionable>();
+    for (auto [entity, positionable] : view.each()) {
+      expectNear(glm::vec3(positionable.modelMatrix[3]), positionable.pos);
+      ASSERT_EQ(positionable.pos.y, r);
+    }
+  }
+}
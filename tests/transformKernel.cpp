@@ -0,0 +1,152 @@
+#include "TransformKernel.h"
+#include <chrono>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Fields
+{
+  glm::vec3 pos;
+  glm::vec3 origin;
+  glm::vec3 rotate;
+  float scale;
+};
+
+// what Positionable::update did before, chained glm calls and an inverse
+void
+reference(const Fields& f, glm::mat4& modelMatrix, glm::mat3& normalMatrix)
+{
+  glm::mat4 matrix = glm::translate(glm::mat4(1.0f), f.pos);
+  matrix = matrix * glm::mat4_cast(glm::quat(glm::radians(f.rotate)));
+  matrix = glm::translate(matrix, f.origin * glm::vec3(-1));
+  matrix = glm::scale(matrix, glm::vec3(f.scale));
+  modelMatrix = matrix;
+  normalMatrix = glm::mat3(glm::transpose(glm::inverse(matrix)));
+}
+
+std::vector<Fields>
+randomFields(size_t count)
+{
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> position(-100, 100);
+  std::uniform_real_distribution<float> degrees(-720, 720);
+  std::uniform_real_distribution<float> scale(0.05, 4);
+  std::vector<Fields> fields;
+  for (size_t i = 0; i < count; i++) {
+    fields.push_back({
+      glm::vec3(position(random), position(random), position(random)),
+      glm::vec3(position(random), position(random), position(random)) / 50.0f,
+      glm::vec3(degrees(random), degrees(random), degrees(random)),
+      scale(random),
+    });
+  }
+  return fields;
+}
+
+TransformBatch
+batchOf(const std::vector<Fields>& fields)
+{
+  TransformBatch batch;
+  batch.resize(fields.size());
+  for (size_t i = 0; i < fields.size(); i++) {
+    auto& f = fields[i];
+    batch.set(i, f.pos, f.origin, f.rotate, f.scale);
+  }
+  return batch;
+}
+
+// relative to the matrix's size, positions reach a few hundred units
+template<typename Matrix>
+void
+expectNear(const Matrix& actual, const Matrix& expected, float tolerance)
+{
+  for (int c = 0; c < Matrix::length(); c++) {
+    for (int row = 0; row < Matrix::col_type::length(); row++) {
+      float magnitude = std::max(1.0f, std::abs(expected[c][row]));
+      ASSERT_NEAR(actual[c][row], expected[c][row], tolerance * magnitude)
+        << "column " << c << " row " << row;
+    }
+  }
+}
+
+}
+
+TEST(TRANSFORM_KERNEL, composeMatchesChainedMatrices) {
+  for (auto& f : randomFields(1000)) {
+    glm::mat4 model, expectedModel;
+    glm::mat3 normal, expectedNormal;
+    transformKernel::compose(f.pos, f.origin, f.rotate, f.scale, model, normal);
+    reference(f, expectedModel, expectedNormal);
+    expectNear(model, expectedModel, 1e-5);
+    expectNear(normal, expectedNormal, 1e-4);
+  }
+}
+
+// 1003 leaves a tail for the scalar path after the vector lanes
+TEST(TRANSFORM_KERNEL, batchMatchesChainedMatrices) {
+  auto fields = randomFields(1003);
+  auto batch = batchOf(fields);
+  batch.compute(0, 500);
+  batch.compute(500, fields.size());
+  for (size_t i = 0; i < fields.size(); i++) {
+    glm::mat4 expectedModel;
+    glm::mat3 expectedNormal;
+    reference(fields[i], expectedModel, expectedNormal);
+    expectNear(batch.modelMatrices[i], expectedModel, 1e-5);
+    expectNear(batch.normalMatrices[i], expectedNormal, 1e-4);
+  }
+}
+
+TEST(TRANSFORM_KERNEL, quarterTurnsAreExact) {
+  TransformBatch batch;
+  batch.resize(TransformBatch::WIDTH);
+  for (size_t i = 0; i < TransformBatch::WIDTH; i++) {
+    batch.set(i, glm::vec3(0), glm::vec3(0), glm::vec3(0, 90.0f * i, 0), 2);
+  }
+  batch.compute(0, TransformBatch::WIDTH);
+  // a quarter turn about y takes x to -z
+  glm::vec4 x = batch.modelMatrices[1] * glm::vec4(1, 0, 0, 1);
+  EXPECT_NEAR(x.x, 0, 1e-6);
+  EXPECT_NEAR(x.z, -2, 1e-6);
+  glm::vec3 normal = batch.normalMatrices[2] * glm::vec3(1, 0, 0);
+  EXPECT_NEAR(normal.x, -0.5, 1e-6);
+}
+
+// micro benchmark, a frame where every entity of a large scene moved
+TEST(TRANSFORM_KERNEL, benchmark100kEntities) {
+  auto fields = randomFields(100000);
+  auto batch = batchOf(fields);
+  std::vector<glm::mat4> models(fields.size());
+  std::vector<glm::mat3> normals(fields.size());
+  int frames = 10;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    for (size_t i = 0; i < fields.size(); i++) {
+      reference(fields[i], models[i], normals[i]);
+    }
+  }
+  auto chained = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    batch.compute(0, batch.size());
+  }
+  auto batched = std::chrono::steady_clock::now() - start;
+
+  double chainedMs =
+    std::chrono::duration<double, std::milli>(chained).count() / frames;
+  double batchedMs =
+    std::chrono::duration<double, std::milli>(batched).count() / frames;
+  std::cout << "100k transforms: chained " << chainedMs << "ms, batched "
+            << batchedMs << "ms" << (TransformBatch::hasAvx2() ? " (avx2)" : "")
+            << std::endl;
+  RecordProperty("chainedUs", (int)(chainedMs * 1000));
+  RecordProperty("batchedUs", (int)(batchedMs * 1000));
+  expectNear(batch.modelMatrices.back(), models.back(), 1e-5);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "Handoff.h"
+#include "WindowManager/WindowChanges.h"
+#include <thread>
+
+using namespace WindowManager;
+
+TEST(WINDOW_CHANGES, collapsesConfiguresPerWindow) {
+  WindowChanges changes;
+  Window window = 7;
+  for (int width = 100; width <= 600; width++) {
+    changes.configure(window, width, width / 2);
+  }
+  changes.configure(8, 10, 20);
+  ASSERT_EQ(changes.configured.size(), 2);
+  ASSERT_EQ(changes.configured[window].width, 600);
+  ASSERT_EQ(changes.configured[window].height, 300);
+  ASSERT_EQ(changes.coalesced, 500);
+  changes.clear();
+  ASSERT_TRUE(changes.empty());
+}
+
+TEST(WINDOW_CHANGES, collapsesDamagePerWindow) {
+  WindowChanges changes;
+  for (int i = 0; i < 100; i++) {
+    changes.damage(7);
+  }
+  changes.damage(8);
+  ASSERT_EQ(changes.damaged, (std::set<Window>{ 7, 8 }));
+  ASSERT_EQ(changes.coalesced, 99);
+  ASSERT_FALSE(changes.empty());
+  changes.clear();
+  ASSERT_TRUE(changes.empty());
+}
+
+TEST(HANDOFF, holdsABatchUntilTheLastIsBack) {
+  Handoff<WindowChanges> handoff;
+  handoff.pending().configure(1, 10, 10);
+  ASSERT_TRUE(handoff.publish());
+  auto first = handoff.take();
+  ASSERT_NE(first, nullptr);
+  ASSERT_EQ(handoff.take(), nullptr);
+
+  // the consumer still has the first, so the second keeps growing
+  handoff.pending().configure(2, 10, 10);
+  ASSERT_FALSE(handoff.publish());
+  handoff.pending().configure(2, 20, 20);
+  ASSERT_FALSE(handoff.publish());
+  handoff.release(first);
+  ASSERT_TRUE(handoff.publish());
+  auto second = handoff.take();
+  ASSERT_EQ(second->configured.size(), 1);
+  ASSERT_EQ(second->configured[2].width, 20);
+  ASSERT_TRUE(handoff.pending().empty());
+  handoff.release(second);
+}
+
+// an event thread resizing one window as fast as it can, and a render
+// thread taking what there is once a frame
+TEST(HANDOFF, loosesNothingBetweenThreads) {
+  const int EVENTS = 200000;
+  Handoff<WindowChanges> handoff;
+  std::atomic_bool done = false;
+  std::thread events([&]() {
+    for (int i = 1; i <= EVENTS; i++) {
+      handoff.pending().configure(1, i, i);
+      handoff.pending().events.push_back({ LARGER, (entt::entity)i });
+      handoff.publish();
+    }
+    while (!handoff.publish()) {
+      std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  int ticks = 0;
+  int lastWidth = 0;
+  size_t hotkeys = 0;
+  for (;;) {
+    bool finished = done;
+    auto changes = handoff.take();
+    if (changes != NULL) {
+      ticks++;
+      ASSERT_GT(changes->configured[1].width, lastWidth);
+      lastWidth = changes->configured[1].width;
+      hotkeys += changes->events.size();
+      handoff.release(changes);
+    } else if (finished) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  events.join();
+  ASSERT_EQ(lastWidth, EVENTS);
+  ASSERT_EQ(hotkeys, EVENTS);
+  ASSERT_LT(ticks, EVENTS);
+}
@@ -0,0 +1,166 @@
+#include "MultiPlayer/Server.h"
+#include "MultiPlayer/WorldEdits.h"
+#include "testClient.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <map>
+#include <tuple>
+#include <vector>
+
+using namespace MultiPlayer;
+
+namespace {
+
+// pumps every client until each has seen count edits, or a second passes
+bool
+waitForEdits(std::vector<TestClient*> clients, size_t count)
+{
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (std::chrono::steady_clock::now() < end) {
+    bool done = true;
+    for (auto client : clients) {
+      client->pump(1);
+      done = done && client->edits.size() >= count;
+    }
+    if (done) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// what a client's world ends up as, the last edit to each cube
+std::map<std::tuple<int, int, int>, int>
+resolve(const std::vector<BlockEdit>& edits)
+{
+  std::map<std::tuple<int, int, int>, int> cubes;
+  for (auto& edit : edits) {
+    cubes[{ edit.x, edit.y, edit.z }] = edit.blockType;
+  }
+  return cubes;
+}
+
+}
+
+TEST(WORLD_EDITS, batchRoundTrips) {
+  std::vector<BlockEdit> edits = {
+    { 10, 64, -3, 5 }, { 11, 64, -3, 5 }, { 11, 65, -3, -1 }, { -900, 0, 7, 0 }
+  };
+  auto data = encodeEdits(edits);
+  std::vector<BlockEdit> decoded;
+  ASSERT_TRUE(decodeEdits(data.data(), data.size(), decoded));
+  ASSERT_EQ(decoded, edits);
+  ASSERT_FALSE(decodeEdits(data.data(), data.size() - 1, decoded));
+  // neighbours cost a handful of bytes each
+  ASSERT_LE(data.size(), 2 + 4 * 4 + 4 + 4 + 8);
+}
+
+TEST(WORLD_EDITS, refusesEditsOutsideTheWorld) {
+  WorldEdits world;
+  ASSERT_FALSE(world.apply({ 0, -1, 0, 1 }));
+  ASSERT_FALSE(world.apply({ 0, WorldEdits::CHUNK_HEIGHT, 0, 1 }));
+  ASSERT_FALSE(world.apply({ 0, 10, 0, WorldEdits::MAX_BLOCK_TYPE + 1 }));
+  ASSERT_EQ(world.chunkCount(), 0);
+  ASSERT_TRUE(world.apply({ 0, 10, 0, -1 }));
+  ASSERT_EQ(world.chunkCount(), 1);
+}
+
+TEST(WORLD_EDITS, refusesEditsPastTheRadius) {
+  WorldEdits world(2);
+  int width = WorldEdits::CHUNK_WIDTH;
+  ASSERT_TRUE(world.apply({ -2 * width, 10, 3 * width - 1, 1 }));
+  ASSERT_FALSE(world.apply({ -2 * width - 1, 10, 0, 1 }));
+  ASSERT_FALSE(world.apply({ 0, 10, 3 * width, 1 }));
+  ASSERT_FALSE(world.apply({ INT32_MIN, 10, 0, 1 }));
+  ASSERT_FALSE(world.apply({ 0, 10, INT32_MIN, 1 }));
+  ASSERT_FALSE(world.apply({ INT32_MAX, 10, INT32_MAX, 1 }));
+  ASSERT_EQ(world.chunkCount(), 1);
+}
+
+TEST(WORLD_EDITS, capsTheChunksItHolds) {
+  WorldEdits world(WorldEdits::DEFAULT_RADIUS, 2);
+  int width = WorldEdits::CHUNK_WIDTH;
+  ASSERT_TRUE(world.apply({ 0, 10, 0, 1 }));
+  ASSERT_TRUE(world.apply({ width, 10, 0, 1 }));
+  ASSERT_FALSE(world.apply({ 2 * width, 10, 0, 1 }));
+  // chunks it already holds still take edits
+  ASSERT_TRUE(world.apply({ 1, 10, 0, 2 }));
+  ASSERT_EQ(world.chunkCount(), 2);
+}
+
+TEST(WORLD_EDITS, chunkStateHoldsTheLastEditPerCube) {
+  WorldEdits world;
+  world.apply({ -1, 20, 31, 3 });
+  world.apply({ -1, 20, 31, 4 });
+  world.apply({ 40, 0, 0, -1 });
+  auto packets = world.encodeChunks();
+  ASSERT_EQ(packets.size(), 2);
+
+  std::vector<BlockEdit> state;
+  for (auto& packet : packets) {
+    ASSERT_EQ(packet[0], CHUNK_STATE);
+    std::vector<BlockEdit> edits;
+    ASSERT_TRUE(
+      WorldEdits::decodeChunk(packet.data() + 1, packet.size() - 1, edits));
+    state.insert(state.end(), edits.begin(), edits.end());
+    // a mostly untouched chunk deflates to almost nothing
+    ASSERT_LT(packet.size(), 2048);
+  }
+  std::vector<BlockEdit> expected = { { -1, 20, 31, 4 }, { 40, 0, 0, -1 } };
+  ASSERT_EQ(state, expected);
+}
+
+TEST(WORLD_EDITS, serverOrdersAndRelaysEdits) {
+  int port = 17791;
+  Server server;
+  ASSERT_TRUE(server.Start(port));
+  TestClient builder;
+  TestClient watcher;
+  ASSERT_TRUE(builder.connect(port));
+  ASSERT_TRUE(watcher.connect(port));
+
+  builder.sendEdits({ { 1, 2, 3, 7 }, { 1, 3, 3, 7 } });
+  watcher.sendEdits({ { 1, 2, 3, -1 } });
+  builder.sendEdits({ { 0, 500, 0, 7 } });
+  ASSERT_TRUE(waitForEdits({ &builder, &watcher }, 3));
+
+  // both see the same order, the sender included, and the edit above the
+  // world never makes it out. The watcher may also have been sent the
+  // first edits as a chunk state if it joined just after them.
+  ASSERT_EQ(builder.edits.size(), 3);
+  ASSERT_EQ(builder.edits.back(), (BlockEdit{ 1, 2, 3, -1 }));
+  ASSERT_TRUE(std::equal(builder.edits.rbegin(),
+                         builder.edits.rend(),
+                         watcher.edits.rbegin()));
+  ASSERT_EQ(resolve(builder.edits), resolve(watcher.edits));
+  server.Stop();
+}
+
+TEST(WORLD_EDITS, lateJoinersGetChunkStates) {
+  int port = 17792;
+  Server server;
+  ASSERT_TRUE(server.Start(port));
+  TestClient builder;
+  ASSERT_TRUE(builder.connect(port));
+  std::vector<BlockEdit> wall;
+  for (int i = 0; i < 200; i++) {
+    wall.push_back({ i, 64, 0, 2 });
+  }
+  builder.sendEdits(wall);
+  builder.sendEdits({ { 5, 64, 0, -1 } });
+  ASSERT_TRUE(waitForEdits({ &builder }, 201));
+
+  TestClient late;
+  ASSERT_TRUE(late.connect(port));
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  while (late.edits.size() < 200 && std::chrono::steady_clock::now() < end) {
+    late.pump(1);
+  }
+  // one packet per chunk the wall crosses instead of every edit again
+  ASSERT_EQ(late.chunkStates, 7);
+  ASSERT_EQ(late.edits.size(), 200);
+  for (auto& edit : late.edits) {
+    ASSERT_EQ(edit.blockType, edit.x == 5 ? -1 : 2);
+  }
+  server.Stop();
+}
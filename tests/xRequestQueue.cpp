@@ -0,0 +1,195 @@
+// gtest before Xlib, whose None and Bool macros it can't parse around
+#include <gtest/gtest.h>
+
+#include "XRequestQueue.h"
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const char* XVFB_DISPLAY = ":97";
+const int WINDOWS = 20;
+const int FRAMES = 120;
+
+// an Xvfb of its own for the suite, or none when it isn't installed
+class XRequestQueueTest : public ::testing::Test
+{
+protected:
+  static pid_t server;
+  Display* display = NULL;
+
+  static void SetUpTestSuite()
+  {
+    server = fork();
+    if (server == 0) {
+      execlp("Xvfb", "Xvfb", XVFB_DISPLAY, "-screen", "0", "1920x1080x24",
+             "-nolisten", "tcp", (char*)NULL);
+      _exit(1);
+    }
+  }
+
+  static void TearDownTestSuite()
+  {
+    if (server > 0) {
+      kill(server, SIGTERM);
+      waitpid(server, NULL, 0);
+    }
+  }
+
+  void SetUp() override
+  {
+    for (int attempt = 0; attempt < 50 && display == NULL; attempt++) {
+      if (waitpid(server, NULL, WNOHANG) != 0) {
+        break;
+      }
+      display = XOpenDisplay(XVFB_DISPLAY);
+      if (display == NULL) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+    }
+    if (display == NULL) {
+      GTEST_SKIP() << "no Xvfb to test against";
+    }
+  }
+
+  void TearDown() override
+  {
+    if (display != NULL) {
+      XCloseDisplay(display);
+    }
+  }
+
+  Window createWindow(int width, int height)
+  {
+    Window window = XCreateSimpleWindow(display,
+                                        DefaultRootWindow(display),
+                                        0,
+                                        0,
+                                        width,
+                                        height,
+                                        0,
+                                        0,
+                                        0);
+    XMapWindow(display, window);
+    XSync(display, False);
+    return window;
+  }
+
+  XWindowAttributes attributes(Window window)
+  {
+    XWindowAttributes attributes;
+    XGetWindowAttributes(display, window, &attributes);
+    return attributes;
+  }
+};
+
+pid_t XRequestQueueTest::server = -1;
+
+double
+milliseconds(std::chrono::steady_clock::duration duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+struct FrameTimes
+{
+  double mean = 0;
+  double worst = 0;
+};
+
+// a frame's worth of resizing every window, as long as it holds the frame up
+template<typename ResizeAll>
+FrameTimes
+timeFrames(ResizeAll resizeAll)
+{
+  FrameTimes times;
+  for (int frame = 0; frame < FRAMES; frame++) {
+    auto start = std::chrono::steady_clock::now();
+    resizeAll(frame);
+    double elapsed = milliseconds(std::chrono::steady_clock::now() - start);
+    times.mean += elapsed / FRAMES;
+    times.worst = std::max(times.worst, elapsed);
+  }
+  return times;
+}
+
+}
+
+TEST_F(XRequestQueueTest, sendsTheLastGeometryQueued) {
+  Window window = createWindow(100, 100);
+  auto state = std::make_shared<XRequestQueue::WindowState>();
+  {
+    XRequestQueue queue(XVFB_DISPLAY);
+    ASSERT_TRUE(queue.isConnected());
+    for (int size = 101; size <= 200; size++) {
+      queue.moveResize(window, 10, 20, size, size / 2, state);
+    }
+    queue.move(window, 30, 40);
+    queue.flush();
+  }
+  ASSERT_TRUE(state->resized);
+  auto attrs = attributes(window);
+  ASSERT_EQ(attrs.width, 200);
+  ASSERT_EQ(attrs.height, 100);
+  ASSERT_EQ(attrs.x, 30);
+  ASSERT_EQ(attrs.y, 40);
+}
+
+TEST_F(XRequestQueueTest, runsRequestsInOrder) {
+  Window window = createWindow(100, 100);
+  auto state = std::make_shared<XRequestQueue::WindowState>();
+  XRequestQueue queue(XVFB_DISPLAY);
+  std::vector<int> order;
+  for (int i = 0; i < 10; i++) {
+    queue.request([&order, i](Display*) { order.push_back(i); });
+  }
+  queue.move(window, 50, 60);
+  queue.locate(window, state);
+  queue.flush();
+  ASSERT_EQ(order, std::vector<int>({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+  ASSERT_TRUE(state->located);
+  ASSERT_EQ(state->x, 50);
+  ASSERT_EQ(state->y, 60);
+}
+
+// Resizing twenty windows a frame the way X11App::resize used to, asking for
+// each window's attributes and syncing after, against queueing the resizes.
+TEST_F(XRequestQueueTest, benchmarkResizing20Windows) {
+  std::vector<Window> windows;
+  for (int i = 0; i < WINDOWS; i++) {
+    windows.push_back(createWindow(640, 480));
+  }
+  auto size = [](int frame) { return 640 + (frame % 2) * 10; };
+
+  auto synchronous = timeFrames([&](int frame) {
+    for (auto window : windows) {
+      XWindowAttributes attrs;
+      XGetWindowAttributes(display, window, &attrs);
+      XMoveResizeWindow(display, window, 0, 0, size(frame), 480);
+      XFlush(display);
+      XSync(display, False);
+    }
+  });
+
+  auto state = std::make_shared<XRequestQueue::WindowState>();
+  XRequestQueue queue(XVFB_DISPLAY);
+  auto queued = timeFrames([&](int frame) {
+    for (auto window : windows) {
+      queue.moveResize(window, 0, 0, size(frame + 1), 480, state);
+    }
+  });
+  queue.flush();
+
+  std::cout << "frame time resizing " << WINDOWS << " windows: synchronous "
+            << synchronous.mean << "ms (worst " << synchronous.worst
+            << "ms), queued " << queued.mean << "ms (worst " << queued.worst
+            << "ms) in " << queue.getBatchCount() << " batches" << std::endl;
+  ASSERT_LT(queued.mean, synchronous.mean);
+  ASSERT_EQ(attributes(windows.back()).width, size(FRAMES));
+}